@@ -0,0 +1,435 @@
+#ifndef KOMORI_BIGFIXED_HPP_
+#define KOMORI_BIGFIXED_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bigint.hpp"
+#include "biguint.hpp"
+#include "decimal.hpp"
+#include "digit_sink.hpp"
+#include "io.hpp"
+#include "ssa.hpp"
+
+namespace komori {
+/**
+ * @brief An arbitrary precision fixed-point number
+ * @detail
+ * This class represents a real number by the following form:
+ *    value * 2^(-frac_bits)
+ * `frac_bits` is chosen once when the number is created and never changes, so no operation needs to realign or
+ * normalize its operands. Every operation truncates the result to `frac_bits` fractional bits. Operands of a binary
+ * operation must have the same `frac_bits`.
+ */
+class BigFixed {
+ public:
+  // <Constructors>
+  /**
+   * @brief Construct from an integer
+   * @param frac_bits The number of fractional bits
+   * @param integer The value of the number
+   */
+  constexpr BigFixed(uint64_t frac_bits, const BigInt& integer) : value_{integer << frac_bits}, frac_bits_{frac_bits} {}
+
+  /// Construct the number `raw * 2^(-frac_bits)`
+  static constexpr BigFixed FromRaw(uint64_t frac_bits, BigInt raw) {
+    BigFixed ans{frac_bits, BigInt{}};
+    ans.value_ = std::move(raw);
+    return ans;
+  }
+
+  constexpr BigFixed() = delete;
+  constexpr BigFixed(const BigFixed&) = default;
+  constexpr BigFixed(BigFixed&&) noexcept = default;
+  constexpr BigFixed& operator=(const BigFixed&) = default;
+  constexpr BigFixed& operator=(BigFixed&&) noexcept = default;
+  constexpr ~BigFixed() = default;
+  // </Constructors>
+
+  // <Basic Methods>
+  constexpr uint64_t GetFracBits() const noexcept { return frac_bits_; }
+  /// The number multiplied by 2^frac_bits
+  constexpr const BigInt& Raw() const noexcept { return value_; }
+  constexpr bool IsZero() const noexcept { return value_.IsZero(); }
+
+  /// Get the integer part of the number (rounded toward zero)
+  constexpr BigInt IntegerPart() const { return value_ >> frac_bits_; }
+
+  /// Get the fractional part of the abs of the number multiplied by 2^frac_bits
+  constexpr BigUint FractionalPartRaw() const { return value_.Abs().ShiftMod2Pow(0, frac_bits_); }
+  // </Basic Methods>
+
+  // <Operators>
+  constexpr BigFixed& operator+=(const BigFixed& rhs) {
+    CheckFracBits(rhs);
+    value_ += rhs.value_;
+    return *this;
+  }
+
+  constexpr BigFixed& operator-=(const BigFixed& rhs) {
+    CheckFracBits(rhs);
+    value_ -= rhs.value_;
+    return *this;
+  }
+
+  constexpr BigFixed& operator*=(const BigFixed& rhs) {
+    CheckFracBits(rhs);
+    value_ = Multiply(value_, rhs.value_) >> frac_bits_;
+    return *this;
+  }
+
+  constexpr BigFixed& operator<<=(std::size_t rhs) {
+    value_ <<= rhs;
+    return *this;
+  }
+
+  constexpr BigFixed& operator>>=(std::size_t rhs) {
+    value_ >>= rhs;
+    return *this;
+  }
+
+  friend constexpr BigFixed operator+(BigFixed lhs, const BigFixed& rhs) {
+    lhs += rhs;
+    return lhs;
+  }
+
+  friend constexpr BigFixed operator-(BigFixed lhs, const BigFixed& rhs) {
+    lhs -= rhs;
+    return lhs;
+  }
+
+  friend constexpr BigFixed operator-(BigFixed rhs) {
+    rhs.value_ = -rhs.value_;
+    return rhs;
+  }
+
+  friend constexpr BigFixed operator*(BigFixed lhs, const BigFixed& rhs) {
+    lhs *= rhs;
+    return lhs;
+  }
+
+  friend constexpr BigFixed operator<<(BigFixed lhs, std::size_t rhs) {
+    lhs <<= rhs;
+    return lhs;
+  }
+
+  friend constexpr BigFixed operator>>(BigFixed lhs, std::size_t rhs) {
+    lhs >>= rhs;
+    return lhs;
+  }
+
+  friend constexpr std::strong_ordering operator<=>(const BigFixed& lhs, const BigFixed& rhs) {
+    lhs.CheckFracBits(rhs);
+    return lhs.value_ <=> rhs.value_;
+  }
+
+  friend constexpr bool operator==(const BigFixed& lhs, const BigFixed& rhs) = default;
+  // </Operators>
+
+ private:
+  constexpr void CheckFracBits(const BigFixed& rhs) const {
+    if (frac_bits_ != rhs.frac_bits_) {
+      throw std::invalid_argument("The numbers of fractional bits must be the same");
+    }
+  }
+
+  /// The number multiplied by 2^frac_bits_
+  BigInt value_;
+  /// The number of fractional bits
+  uint64_t frac_bits_;
+};
+
+namespace detail {
+/// Shift `num` to the left by `shift` bits. If `shift` is negative, shift to the right instead.
+template <typename T>
+constexpr T ShiftBits(const T& num, int64_t shift) {
+  if (shift >= 0) {
+    return num << static_cast<std::size_t>(shift);
+  } else {
+    return num >> static_cast<std::size_t>(-shift);
+  }
+}
+
+/**
+ * @brief Compute 1/m where m = num * 2^(-s) is in [1/2, 1)
+ * @return y * 2^precision where y is approximately 1/m
+ *
+ * Each iteration y' = y + y(1 - my) reads only the leading bits of `num` that the iteration can use.
+ */
+constexpr inline BigInt ReciprocalSignificand(const BigUint& num, int64_t precision) {
+  const auto s = static_cast<int64_t>(num.NumberOfBits());
+  const auto top = static_cast<uint64_t>(ShiftBits(num, 64 - s));
+
+  int64_t p = kNewtonInitialPrecision;
+  auto y = BigInt{static_cast<uint64_t>((uint128_t{1} << (64 + p)) / top)};
+  for (const auto next_p : MakeNewtonLadder(precision)) {
+    // m ~ m_trunc * 2^(-q), y = y * 2^(-p)
+    const auto q = next_p + kNewtonGuardBits;
+    const auto m_trunc = BigInt{ShiftBits(num, q - s)};
+    // e = (1 - my) * 2^(q + p)
+    const auto e = (BigInt{1} << static_cast<std::size_t>(q + p)) - Multiply(m_trunc, y);
+    auto correction = Multiply(y, e) >> static_cast<std::size_t>(2 * p + kNewtonGuardBits);
+    y <<= static_cast<std::size_t>(next_p - p);
+    y += correction;
+    p = next_p;
+  }
+
+  return ShiftBits(y, precision - p);
+}
+
+/**
+ * @brief Compute 1/sqrt(m) where m = num * 2^(-s) is in [1/4, 1)
+ * @return y * 2^precision where y is approximately 1/sqrt(m)
+ *
+ * Each iteration y' = y + y(1 - my^2)/2 reads only the leading bits of `num` that the iteration can use.
+ */
+constexpr inline BigInt InverseSqrtSignificand(const BigUint& num, int64_t s, int64_t precision) {
+  const auto top = static_cast<uint64_t>(ShiftBits(num, 64 - s));
+
+  int64_t p = kNewtonInitialPrecision;
+  auto y = BigInt{(uint64_t{1} << (32 + p)) / ISqrt(top)};
+  for (const auto next_p : MakeNewtonLadder(precision)) {
+    // m ~ m_trunc * 2^(-q), y = y * 2^(-p)
+    const auto q = next_p + kNewtonGuardBits;
+    const auto m_trunc = BigInt{ShiftBits(num, q - s)};
+    // e = (1 - my^2) * 2^(q + 2p)
+    const auto e = (BigInt{1} << static_cast<std::size_t>(q + 2 * p)) - Multiply(m_trunc, Multiply(y, y));
+    auto correction = Multiply(y, e) >> static_cast<std::size_t>(3 * p + kNewtonGuardBits + 1);
+    y <<= static_cast<std::size_t>(next_p - p);
+    y += correction;
+    p = next_p;
+  }
+
+  return ShiftBits(y, precision - p);
+}
+}  // namespace detail
+
+/**
+ * @brief Compute 1/num
+ * @throw `std::range_error` if `num` is zero
+ */
+constexpr inline BigFixed Reciprocal(const BigFixed& num) {
+  if (num.IsZero()) {
+    throw std::range_error("The divisor is zero");
+  }
+
+  // num = m * 2^(s - F), 1/num = (1/m) * 2^(F - s)
+  const auto f = static_cast<int64_t>(num.GetFracBits());
+  const auto& abs = num.Raw().Abs();
+  const auto s = static_cast<int64_t>(abs.NumberOfBits());
+  const auto precision = std::max(2 * f - s + detail::kNewtonGuardBits, detail::kNewtonInitialPrecision);
+
+  auto y = detail::ReciprocalSignificand(abs, precision);
+  auto raw = detail::ShiftBits(BigInt{y.Abs(), num.Raw().GetSign()}, 2 * f - s - precision);
+  return BigFixed::FromRaw(num.GetFracBits(), std::move(raw));
+}
+
+namespace detail {
+/**
+ * @brief Find k such that abs * 2^(-frac_bits) = t * 4^k with t in [1, 4)
+ * @pre `abs` is not zero
+ */
+constexpr inline int64_t SqrtExponent(const BigUint& abs, uint64_t frac_bits) {
+  // abs * 2^(-F) is in [2^(bits - F - 1), 2^(bits - F)), so bits - F - 2k must be 1 or 2
+  const auto e = static_cast<int64_t>(abs.NumberOfBits()) - static_cast<int64_t>(frac_bits) - 1;
+  return (e >= 0 ? e : e - 1) / 2;
+}
+}  // namespace detail
+
+/**
+ * @brief Compute 1/sqrt(num)
+ * @throw `std::range_error` if `num` is zero
+ * @throw `std::out_of_range` if `num` is negative
+ */
+constexpr inline BigFixed InverseSqrt(const BigFixed& num) {
+  if (num.IsZero()) {
+    throw std::range_error("The number is zero");
+  } else if (num.Raw().GetSign() == Sign::kNegative) {
+    throw std::out_of_range("The number must not be negative");
+  }
+
+  // num = t * 4^k with t in [1, 4), and m = t / 4 = abs * 2^(-s) is in [1/4, 1).
+  // 1/sqrt(num) = (1/sqrt(m)) * 2^(-k-1), which is (1/sqrt(m)) * 2^(F-k-1) in raw.
+  const auto f = static_cast<int64_t>(num.GetFracBits());
+  const auto& abs = num.Raw().Abs();
+  const auto k = detail::SqrtExponent(abs, num.GetFracBits());
+  const auto s = f + 2 * k + 2;
+  const auto scale = f - k - 1;
+  if (scale + 1 < 0) {
+    // 1/sqrt(num) <= 2^(-k) is below one ulp
+    return BigFixed{num.GetFracBits(), BigInt{}};
+  }
+
+  const auto precision = std::max(scale + detail::kNewtonGuardBits, detail::kNewtonInitialPrecision);
+  auto y = detail::InverseSqrtSignificand(abs, s, precision);
+  return BigFixed::FromRaw(num.GetFracBits(), detail::ShiftBits(y, scale - precision));
+}
+
+/**
+ * @brief Compute sqrt(num) by Karp--Markstein's method
+ *
+ * num = t * 4^k with t in [1, 4) and sqrt(num) = sqrt(t) * 2^k, so the iterations run on t with F + k + guard bits.
+ * With a ~ 1/sqrt(t) and y = t * a computed with half of the fractional bits, sqrt(t) ~ y + a(t - y^2)/2.
+ */
+constexpr inline BigFixed Sqrt(const BigFixed& num) {
+  if (num.IsZero()) {
+    return num;
+  }
+
+  const auto f = static_cast<int64_t>(num.GetFracBits());
+  const auto k = detail::SqrtExponent(num.Raw().Abs(), num.GetFracBits());
+  const auto frac_bits = static_cast<uint64_t>(f + k + detail::kNewtonGuardBits);
+  // t = num * 4^(-k) with `frac_bits` fractional bits. The bits dropped by a right shift are beyond its precision.
+  const auto t = BigFixed::FromRaw(frac_bits, detail::ShiftBits(num.Raw(), detail::kNewtonGuardBits - k));
+
+  const auto half_frac_bits = frac_bits / 2 + detail::kNewtonGuardBits;
+  const auto shift = frac_bits > half_frac_bits ? frac_bits - half_frac_bits : 0;
+  const auto half = BigFixed::FromRaw(frac_bits - shift, t.Raw() >> shift);
+  auto root = [&] {
+    if (shift == 0 || half.GetFracBits() <= 2 * detail::kNewtonInitialPrecision) {
+      return t * InverseSqrt(t);
+    }
+
+    const auto half_a = InverseSqrt(half);
+    const auto a = BigFixed::FromRaw(frac_bits, half_a.Raw() << shift);
+    const auto y = BigFixed::FromRaw(frac_bits, (half * half_a).Raw() << shift);
+    return y + ((a * (t - y * y)) >> 1);
+  }();
+
+  // sqrt(num) = sqrt(t) * 2^k, which has F + k + guard fractional bits in `root`
+  return BigFixed::FromRaw(num.GetFracBits(), root.Raw() >> static_cast<std::size_t>(detail::kNewtonGuardBits));
+}
+
+/**
+ * @brief Compute lhs / rhs with `frac_bits` fractional bits by Karp--Markstein's method
+ *
+ * The quotient has q = bit_width(lhs) - bit_width(rhs) + frac_bits + 1 bits at most, and only the leading
+ * q + 2 * kNewtonGuardBits bits of each operand affect it, so both operands are truncated to that width first. The
+ * reciprocal of rhs is computed only to half of the precision of the quotient. The final multiplication is folded
+ * into the last Newton's iteration: with a ~ 1/rhs and y = lhs * a (both half precision), lhs / rhs ~ y + a(lhs -
+ * rhs * y). The residual is computed exactly in integers. The result is off by a few ulps.
+ *
+ * @throw `std::range_error` if `rhs` is zero
+ */
+constexpr inline BigFixed Divide(const BigInt& lhs, const BigInt& rhs, uint64_t frac_bits) {
+  if (rhs.IsZero()) {
+    throw std::range_error("The divisor is zero");
+  }
+
+  const auto f = static_cast<int64_t>(frac_bits);
+  const auto l_bits = static_cast<int64_t>(lhs.NumberOfBits());
+  const auto r_bits = static_cast<int64_t>(rhs.NumberOfBits());
+  const auto quotient_bits = l_bits - r_bits + f + 1;
+  if (lhs.IsZero() || quotient_bits <= 0) {
+    return BigFixed{frac_bits, BigInt{}};
+  }
+
+  // lhs * 2^F / rhs ~ l * 2^e / x, where l and x are the leading bits of lhs and rhs
+  const auto keep_bits = quotient_bits + 2 * detail::kNewtonGuardBits;
+  const auto l_drop = std::max<int64_t>(0, l_bits - keep_bits);
+  const auto x_drop = std::max<int64_t>(0, r_bits - keep_bits);
+  const auto l = lhs.Abs() >> static_cast<std::size_t>(l_drop);
+  const auto x = rhs.Abs() >> static_cast<std::size_t>(x_drop);
+  const auto e = f + l_drop - x_drop;
+
+  // Let x = m * 2^s where m is in [1/2, 1). a = a_raw * 2^(-half_precision) ~ 1/m
+  const auto s = static_cast<int64_t>(x.NumberOfBits());
+  const auto half_precision = quotient_bits / 2 + detail::kNewtonGuardBits;
+  const auto a_raw = detail::ReciprocalSignificand(x, half_precision);
+  // y ~ l * 2^(e - s) / m, computed from the leading bits of l
+  const auto l_shift = std::max<int64_t>(0, static_cast<int64_t>(l.NumberOfBits()) - half_precision -
+                                                detail::kNewtonGuardBits);
+  auto y = detail::ShiftBits(Multiply(BigInt{l >> static_cast<std::size_t>(l_shift)}, a_raw),
+                             l_shift + e - s - half_precision);
+  // residual = l * 2^e - x * y, and the correction is residual / x ~ residual * a * 2^(-s)
+  const auto residual = BigInt{detail::ShiftBits(l, e)} - Multiply(BigInt{x}, y);
+  const auto r_shift =
+      std::max<int64_t>(0, static_cast<int64_t>(residual.NumberOfBits()) - half_precision - detail::kNewtonGuardBits);
+  y += detail::ShiftBits(Multiply(residual >> static_cast<std::size_t>(r_shift), a_raw), r_shift - s - half_precision);
+
+  const auto sign = lhs.GetSign() ^ rhs.GetSign();
+  return BigFixed::FromRaw(frac_bits, BigInt{y.Abs(), sign});
+}
+
+/**
+ * @brief Compute lhs / rhs. See `Divide()`.
+ * @throw `std::invalid_argument` if the numbers of fractional bits differ
+ * @throw `std::range_error` if `rhs` is zero
+ */
+constexpr inline BigFixed operator/(const BigFixed& lhs, const BigFixed& rhs) {
+  if (lhs.GetFracBits() != rhs.GetFracBits()) {
+    throw std::invalid_argument("The numbers of fractional bits must be the same");
+  }
+
+  // (l * 2^(-F)) / (r * 2^(-F)) = l / r
+  return Divide(lhs.Raw(), rhs.Raw(), lhs.GetFracBits());
+}
+
+/**
+ * @brief Whether every number within 2^(-error_bits) of `num` has the same first `digits` decimal digits after the
+ *        decimal point as `num`
+ *
+ * The digits of `num` are truncated, so they may differ from those of a number within the error only if the tail
+ * num * 10^digits mod 1 is within the error of 0 or 1, i.e. the following digits are all 0s or all 9s.
+ *
+ * @pre `num` is not negative and `digits * log2(10) < error_bits <= num.GetFracBits()`
+ */
+constexpr inline bool IsTruncationExact(const BigFixed& num, uint64_t digits, uint64_t error_bits) {
+  // num * 10^D = raw * 5^D * 2^(D - F), so the tail is the low F - D bits of raw * 5^D and the error is 5^D * 2^(F - E)
+  PowerTable local;
+  const auto& pow5 = detail::SelectPowerTable(local).Pow5(digits);
+  const auto tail_bits = num.GetFracBits() - digits;
+  const auto tail = Multiply(num.Raw().Abs(), pow5).ShiftMod2Pow(0, tail_bits);
+  const auto error = pow5 << (num.GetFracBits() - error_bits);
+  return error <= tail && (tail + error).NumberOfBits() <= tail_bits;
+}
+
+/**
+ * @brief Convert a number to a decimal string
+ * @return The same format as `ToString(const BigFloat&)`. All of the fractional bits are considered reliable.
+ */
+constexpr inline std::string ToDecimalString(const BigFixed& num) {
+  constexpr double log2_10 = 3.321928094887362;
+
+  auto integer_part_str = ToString(num.IntegerPart());
+  if (num.Raw().GetSign() == Sign::kNegative && integer_part_str.front() != '-') {
+    integer_part_str = "-" + std::move(integer_part_str);
+  }
+
+  const auto digit_len = static_cast<uint64_t>(static_cast<double>(num.GetFracBits()) / log2_10);
+  if (digit_len == 0) {
+    return std::move(integer_part_str) + ".";
+  }
+
+  return std::move(integer_part_str) + "." +
+         detail::FractionToDecimalString(num.FractionalPartRaw(), num.GetFracBits(), digit_len);
+}
+
+/**
+ * @brief Write `ToDecimalString(num)` truncated to `digit_len` digits after the decimal point to `sink`
+ *
+ * The digits are written in chunks of `chunk_size` characters as they are converted, so the whole string is never
+ * held. See `WriteFractionDigits()`.
+ *
+ * @pre `digit_len` is at most the number of digits of `ToDecimalString(num)` after the decimal point
+ */
+template <DigitSink Sink>
+void WriteDecimalString(Sink& sink, const BigFixed& num, uint64_t digit_len, std::size_t chunk_size = kDigitChunkSize) {
+  auto integer_part_str = ToString(num.IntegerPart());
+  if (num.Raw().GetSign() == Sign::kNegative && integer_part_str.front() != '-') {
+    integer_part_str = "-" + std::move(integer_part_str);
+  }
+
+  ChunkedDigitSink chunked{sink, chunk_size};
+  chunked.Write(integer_part_str);
+  chunked.Write(".");
+  detail::StreamFractionDigits(chunked, num.FractionalPartRaw(), num.GetFracBits(), digit_len);
+  chunked.Flush();
+}
+}  // namespace komori
+
+#endif  // KOMORI_BIGFIXED_HPP_
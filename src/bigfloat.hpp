@@ -1,6 +1,9 @@
 #ifndef KOMORI_BIGFLOAT_HPP_
 #define KOMORI_BIGFLOAT_HPP_
 
+#include <algorithm>
+#include <vector>
+
 #include "bigint.hpp"
 #include "biguint.hpp"
 #include "ssa.hpp"
@@ -32,6 +35,8 @@ class BigFloat {
   constexpr int64_t GetPrecision() const noexcept { return precision_; }
   constexpr void SetPrecision(int64_t precision) noexcept { precision_ = precision; }
   constexpr bool IsZero() const noexcept { return significand_.IsZero(); }
+  constexpr const BigInt& GetSignificand() const noexcept { return significand_; }
+  constexpr int64_t GetExponent() const noexcept { return exponent_; }
 
   constexpr int64_t GetFractionalPartPrecision() const noexcept {
     const auto reliable_bit_len = -(LowestReliableBit() + exponent_);
@@ -57,26 +62,14 @@ class BigFloat {
    * @param lhs The first number to be added
    * @param rhs The second number to be added
    * @return The result of the addition
-   * @detail We take the values instead of the (lvalue) references in order to keep the implementation simple.
    */
-  friend constexpr BigFloat operator+(BigFloat lhs, BigFloat rhs) {
-    // Make `exponent_` the same value. The one that has greater `exponent_` should be shifted.
-    if (lhs.exponent_ < rhs.exponent_) {
-      rhs.ExtendSignificand(lhs.exponent_);
-    } else if (lhs.exponent_ > rhs.exponent_) {
-      lhs.ExtendSignificand(rhs.exponent_);
-    }
-
-    const auto lowest_reliable_bit = std::max(lhs.LowestReliableBit(), rhs.LowestReliableBit());
-
-    lhs.significand_ += rhs.significand_;
-    lhs.precision_ = static_cast<int64_t>(lhs.significand_.NumberOfBits()) - lowest_reliable_bit;
-    lhs.Simplify();
-
-    return lhs;
+  friend constexpr BigFloat operator+(const BigFloat& lhs, const BigFloat& rhs) {
+    return Add(lhs, rhs, Sign::kPositive);
   }
 
-  friend constexpr BigFloat operator-(BigFloat lhs, BigFloat rhs) { return operator+(std::move(lhs), -std::move(rhs)); }
+  friend constexpr BigFloat operator-(const BigFloat& lhs, const BigFloat& rhs) {
+    return Add(lhs, rhs, Sign::kNegative);
+  }
   friend constexpr BigFloat operator-(BigFloat rhs) noexcept {
     rhs.significand_ = -rhs.significand_;
     return rhs;
@@ -171,6 +164,22 @@ class BigFloat {
     return BigFloat{ans_precision, BigInt(std::move(ans_significand))} >> dot_bit;
   }
 
+  /**
+   * @brief Round the number down to its leading `precision` bits
+   * @param precision The number of bits to keep
+   * @return The truncated number. Its precision is at most `precision`.
+   */
+  constexpr BigFloat Truncate(int64_t precision) const {
+    BigFloat ans = *this;
+    const auto shift = static_cast<int64_t>(significand_.NumberOfBits()) - precision;
+    if (shift > 0) {
+      ans.significand_ >>= shift;
+      ans.exponent_ += shift;
+    }
+    ans.precision_ = std::min(precision_, precision);
+    return ans;
+  }
+
   constexpr BigFloat ApproximateInverse() const {
     BigUint tmp = significand_.Abs();
     const auto sign = significand_.GetSign();
@@ -224,14 +233,39 @@ class BigFloat {
   }
 
  private:
+  /// The number of unreliable bits kept below the lowest reliable bit
+  static constexpr int64_t kUnreliableBits = 64;
+
   /**
-   * @brief Multiply 2 ** `exponent_ - exponent` to the significand part, and set `exponent` to the exponent part
-   * @param exponent The exponent part after the conversion
-   * @pre exponent < exponent_
+   * @brief Compute lhs + (rhs_sign) * rhs
+   *
+   * The bits below the lowest reliable bit of either operand are dropped before the addition. The operand with the
+   * greater exponent is added with a shifted add, so neither operand is copied into a wider buffer. If one operand is
+   * far smaller than the other, the cost is proportional to the precision, not to the distance of the exponents.
    */
-  constexpr void ExtendSignificand(int64_t exponent) {
-    significand_ <<= exponent_ - exponent;
-    exponent_ = exponent;
+  static constexpr BigFloat Add(const BigFloat& lhs, const BigFloat& rhs, Sign rhs_sign) {
+    const auto cutoff = std::max(lhs.exponent_ + lhs.LowestReliableBit(), rhs.exponent_ + rhs.LowestReliableBit());
+    const bool lhs_is_high = lhs.exponent_ >= rhs.exponent_;
+    const auto& high = lhs_is_high ? lhs : rhs;
+    const auto& low = lhs_is_high ? rhs : lhs;
+    const auto high_sign = lhs_is_high ? Sign::kPositive : rhs_sign;
+    const auto low_sign = lhs_is_high ? rhs_sign : Sign::kPositive;
+
+    BigFloat ans{0};
+    ans.exponent_ = std::max(low.exponent_, cutoff - kUnreliableBits);
+    ans.significand_ = BigInt{low.significand_.Abs() >> static_cast<std::size_t>(ans.exponent_ - low.exponent_),
+                              low.significand_.GetSign() ^ low_sign};
+    if (high.exponent_ >= ans.exponent_) {
+      ans.significand_.ShlAddAssign(high.significand_.Abs(), high.significand_.GetSign() ^ high_sign,
+                                    static_cast<std::size_t>(high.exponent_ - ans.exponent_));
+    } else {
+      const auto high_significand = high.significand_.Abs() >> static_cast<std::size_t>(ans.exponent_ - high.exponent_);
+      ans.significand_.ShlAddAssign(high_significand, high.significand_.GetSign() ^ high_sign, 0);
+    }
+
+    ans.precision_ = static_cast<int64_t>(ans.significand_.NumberOfBits()) - (cutoff - ans.exponent_);
+    ans.Simplify();
+    return ans;
   }
 
   constexpr int64_t LowestReliableBit() const {
@@ -267,48 +301,119 @@ class BigFloat {
   int64_t exponent_{0};
 };
 
-constexpr inline BigFloat Inverse(BigFloat num) {
-  const auto target_precision = num.GetPrecision();
+namespace detail {
+/// The precision of the initial approximations of Newton's iterations
+inline constexpr int64_t kNewtonInitialPrecision = 30;
+/// The number of extra bits kept in each Newton's iteration
+inline constexpr int64_t kNewtonGuardBits = 8;
+
+/**
+ * @brief Plan the precisions of Newton's iterations
+ * @param precision The final precision
+ * @return The precisions of each iteration in increasing order. The last one is `precision`.
+ *
+ * The ladder is planned from the top, so that the last iteration exactly reaches `precision` instead of overshooting it
+ * by up to a factor of two.
+ */
+constexpr inline std::vector<int64_t> MakeNewtonLadder(int64_t precision) {
+  std::vector<int64_t> ladder;
+  for (auto p = precision; p > kNewtonInitialPrecision; p = p / 2 + 2) {
+    ladder.push_back(p);
+  }
+  std::reverse(ladder.begin(), ladder.end());
+  return ladder;
+}
+}  // namespace detail
+
+/**
+ * @brief Compute 1/num
+ *
+ * Each iteration a' = a + a(1 - num * a) reads only the leading bits of `num` that the iteration can use.
+ */
+constexpr inline BigFloat Inverse(const BigFloat& num) {
   BigFloat a = num.ApproximateInverse();
 
-  while (a.GetPrecision() < target_precision) {
-    a.SetPrecision(2 * a.GetPrecision());
-    auto x = BigFloat(target_precision, BigInt{1}) - num * a;
+  for (const auto precision : detail::MakeNewtonLadder(num.GetPrecision() + 1)) {
+    a.SetPrecision(precision);
+    auto x = BigFloat(precision, BigInt{1}) - num.Truncate(precision + detail::kNewtonGuardBits) * a;
     x *= a;
-    a.SetPrecision(a.GetPrecision() - 1);
+    a.SetPrecision(precision - 1);
     a = std::move(a) + std::move(x);
   }
 
   return a;
 }
 
-constexpr inline BigFloat operator/(BigFloat lhs, BigFloat rhs) {
-  return std::move(lhs) * Inverse(std::move(rhs));
-}
-
-constexpr inline BigFloat SqrtInverse(BigFloat num) {
-  const auto target_precision = num.GetPrecision();
-
+/**
+ * @brief Compute 1/sqrt(num)
+ *
+ * Each iteration a' = a + a(1 - num * a^2)/2 reads only the leading bits of `num` that the iteration can use.
+ */
+constexpr inline BigFloat SqrtInverse(const BigFloat& num) {
   BigFloat a = Inverse(num.ApproximateSqrt());
 
-  while (a.GetPrecision() < target_precision) {
-    a.SetPrecision(2 * a.GetPrecision());
-    auto x = BigFloat(target_precision, BigInt{1}) - num * a * a;
+  for (const auto precision : detail::MakeNewtonLadder(num.GetPrecision() + 1)) {
+    a.SetPrecision(precision);
+    auto x = BigFloat(precision, BigInt{1}) - num.Truncate(precision + detail::kNewtonGuardBits) * a * a;
     x = (a * x) >> 1;
-    a.SetPrecision(a.GetPrecision() - 1);
+    a.SetPrecision(precision - 1);
     a = std::move(a) + std::move(x);
   }
 
   return a;
 }
 
-constexpr inline BigFloat Sqrt(BigFloat num) {
+/**
+ * @brief Compute lhs / rhs by Karp--Markstein's method
+ *
+ * The inverse is computed only to half of the precision. The final multiplication is folded into the last Newton's
+ * iteration: with a ~ 1/rhs and y = lhs * a (both half precision), lhs / rhs ~ y + a(lhs - rhs * y).
+ */
+constexpr inline BigFloat Divide(const BigFloat& lhs, const BigFloat& rhs) {
+  const auto precision = std::min(lhs.GetPrecision(), rhs.GetPrecision());
+  const auto half_precision = precision / 2 + detail::kNewtonGuardBits;
+  if (half_precision <= 2 * detail::kNewtonInitialPrecision) {
+    return lhs * Inverse(rhs);
+  }
+
+  const auto a = Inverse(rhs.Truncate(half_precision));
+  auto y = lhs.Truncate(half_precision) * a;
+  // Treat `y` as exact so that the residual keeps its cancelled bits
+  y.SetPrecision(precision + detail::kNewtonGuardBits);
+  const auto residual =
+      lhs.Truncate(precision + detail::kNewtonGuardBits) - rhs.Truncate(precision + detail::kNewtonGuardBits) * y;
+  auto ans = std::move(y) + residual * a;
+  ans.SetPrecision(std::min(ans.GetPrecision(), precision));
+  return ans;
+}
+
+constexpr inline BigFloat operator/(const BigFloat& lhs, const BigFloat& rhs) {
+  return Divide(lhs, rhs);
+}
+
+/**
+ * @brief Compute sqrt(num) by Karp--Markstein's method
+ *
+ * With a ~ 1/sqrt(num) and y = num * a (both half precision), sqrt(num) ~ y + a(num - y^2)/2.
+ */
+constexpr inline BigFloat Sqrt(const BigFloat& num) {
   if (num.IsZero()) {
     return BigFloat(num.GetPrecision(), BigInt{0});
   }
 
-  auto sqrt_inv = SqrtInverse(num);
-  return std::move(num) * std::move(sqrt_inv);
+  const auto precision = num.GetPrecision();
+  const auto half_precision = precision / 2 + detail::kNewtonGuardBits;
+  if (half_precision <= 2 * detail::kNewtonInitialPrecision) {
+    return num * SqrtInverse(num);
+  }
+
+  const auto a = SqrtInverse(num.Truncate(half_precision));
+  auto y = num.Truncate(half_precision) * a;
+  y.SetPrecision(precision + detail::kNewtonGuardBits);
+  const auto residual = num.Truncate(precision + detail::kNewtonGuardBits) - y * y;
+  auto ans = std::move(y) + ((residual * a) >> 1);
+  ans.SetPrecision(std::min(ans.GetPrecision(), precision));
+  return ans;
 }
 }  // namespace komori
 
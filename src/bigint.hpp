@@ -59,6 +59,29 @@ class BigInt {
     return *this;
   }
 
+  /**
+   * @brief *this += rhs << shift, where rhs = (sign) * abs
+   *
+   * `rhs << shift` is never materialized.
+   */
+  constexpr BigInt& ShlAddAssign(const BigUint& abs, Sign sign, std::size_t shift) {
+    if (sign_ == sign) {
+      value_.ShlAddAssign(abs, shift);
+    } else if (value_.CompareShl(abs, shift) >= 0) {
+      value_.ShlSubAssign(abs, shift);
+    } else {
+      value_.ShlReverseSubAssign(abs, shift);
+      sign_ = sign;
+    }
+
+    return *this;
+  }
+
+  /// *this += rhs << shift
+  constexpr BigInt& ShlAddAssign(const BigInt& rhs, std::size_t shift) {
+    return ShlAddAssign(rhs.value_, rhs.sign_, shift);
+  }
+
   constexpr BigInt& operator*=(const BigInt& rhs) {
     value_ *= rhs.value_;
     sign_ = sign_ ^ rhs.sign_;
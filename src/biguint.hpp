@@ -6,6 +6,7 @@
 #include <cstdint>
 #include <exception>
 #include <iomanip>
+#include <limits>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -13,29 +14,543 @@
 #include "common.hpp"
 
 namespace komori {
-class BigUint : public std::vector<uint64_t> {
-  using Base = std::vector<uint64_t>;
+namespace detail {
+// <Limb Algorithms>
+// The algorithms in this section work on any little-endian sequence of unsigned limbs which provides `size()`,
+// `resize()`, `push_back()`, `pop_back()`, `back()` and `operator[]`, so that `BasicBigUint` and `StaticBigUint` can
+// share them. `DoubleLimb` is an unsigned type twice as wide as the limb, which holds intermediate results.
+
+/// The number of bits in a limb
+template <typename Limb>
+inline constexpr std::size_t kLimbBits = std::numeric_limits<Limb>::digits;
+
+template <typename Limbs>
+constexpr void TrimLeadingZeros(Limbs& limbs) noexcept {
+  while (!limbs.empty() && limbs.back() == 0) {
+    limbs.pop_back();
+  }
+}
+
+template <typename Limbs>
+constexpr uint64_t NumberOfBits(const Limbs& limbs) {
+  constexpr auto kBits = kLimbBits<typename Limbs::value_type>;
+
+  // Before calling `limbs.back()`, we must check if the number is zero.
+  if (limbs.empty()) {
+    return 0;
+  }
+
+  const uint64_t num_of_bits_back = std::bit_width(limbs.back());
+  const uint64_t num_of_bits_except_back = (limbs.size() - 1) * kBits;
+  return num_of_bits_back + num_of_bits_except_back;
+}
+
+template <typename Lhs, typename Rhs>
+constexpr std::strong_ordering Compare(const Lhs& lhs, const Rhs& rhs) noexcept {
+  if (lhs.size() != rhs.size()) {
+    return lhs.size() <=> rhs.size();
+  } else {
+    const auto len = lhs.size();
+    for (std::size_t i = 0; i < len; ++i) {
+      const auto lhs_value = lhs[len - i - 1];
+      const auto rhs_value = rhs[len - i - 1];
+      if (lhs_value != rhs_value) {
+        return lhs_value <=> rhs_value;
+      }
+    }
+
+    return std::strong_ordering::equal;
+  }
+}
+
+template <typename DoubleLimb, typename Lhs, typename Rhs>
+constexpr void AddAssign(Lhs& lhs, const Rhs& rhs) {
+  using Limb = typename Lhs::value_type;
+  constexpr auto kBits = kLimbBits<Limb>;
+
+  lhs.resize(std::max(lhs.size(), rhs.size()));
+
+  DoubleLimb carry = 0;
+  const auto len = lhs.size();
+  for (std::size_t i = 0; i < len && (i < rhs.size() || carry > 0); ++i) {
+    // We use DoubleLimb to handle overflows in the additions
+    const auto lhs_value = static_cast<DoubleLimb>(lhs[i]);
+    const auto rhs_value = (i < rhs.size()) ? static_cast<DoubleLimb>(rhs[i]) : 0;
+    const auto sum = lhs_value + rhs_value + carry;
+
+    // Store the lower half
+    lhs[i] = static_cast<Limb>(sum);
+    // Carry the upper half
+    carry = sum >> kBits;
+  }
+
+  if (carry > 0) {
+    lhs.push_back(static_cast<Limb>(carry));
+  }
+}
+
+/// @pre lhs >= rhs
+template <typename Lhs, typename Rhs>
+constexpr void SubAssign(Lhs& lhs, const Rhs& rhs) {
+  using Limb = typename Lhs::value_type;
+
+  if (Compare(lhs, rhs) < 0) {
+    throw std::out_of_range("`*this - rhs` must not be negative");
+  }
+
+  bool borrow = false;
+  for (std::size_t i = 0; i < rhs.size(); ++i) {
+    // lhs[i] = lhs[i] - Limb{borrow} - rhs[i]
+    // We can judge wether `a - b` caused over flow by evaluating `a < a - b`.
+    const Limb result1 = lhs[i] - static_cast<Limb>(borrow);
+    borrow = lhs[i] < result1;
+    const Limb result2 = result1 - rhs[i];
+    borrow |= result1 < result2;
+
+    lhs[i] = result2;
+  }
+
+  if (borrow) {
+    // Decrement values while the value is zero
+    for (std::size_t i = rhs.size(); i < lhs.size(); ++i) {
+      if (lhs[i]-- > 0) {
+        break;
+      }
+    }
+  }
+
+  TrimLeadingZeros(lhs);
+}
+
+template <typename Limbs>
+constexpr void ShiftRightAssign(Limbs& limbs, std::size_t rhs) {
+  constexpr auto kBits = kLimbBits<typename Limbs::value_type>;
+  const auto word_idx = rhs / kBits;
+  const auto bit_idx = rhs % kBits;
+
+  std::size_t new_size = 0;
+  if (word_idx < limbs.size()) {
+    if (bit_idx == 0) {
+      std::move(limbs.begin() + word_idx, limbs.end(), limbs.begin());
+      new_size = limbs.size() - word_idx;
+    } else {
+      for (std::size_t i = 0; i < limbs.size() - word_idx; ++i) {
+        //                  i+word_idx+1     i + word_idx
+        // <|----------------|----------------|
+        //               ^                ^
+        //            bit_idx           bit_idx
+        //                |<------------->|
+        //                new limbs[i]
+        auto word = limbs[i + word_idx] >> bit_idx;
+        if (i + word_idx + 1 < limbs.size()) {
+          word |= limbs[i + word_idx + 1] << (kBits - bit_idx);
+        }
+
+        limbs[i] = word;
+      }
+
+      new_size = std::min(limbs.size() - word_idx, limbs.size());
+    }
+  }
+
+  limbs.resize(new_size);
+  TrimLeadingZeros(limbs);
+}
+
+template <typename Limbs>
+constexpr void ShiftLeftAssign(Limbs& limbs, std::size_t rhs) {
+  constexpr auto kBits = kLimbBits<typename Limbs::value_type>;
+  const auto word_idx = rhs / kBits;
+  const auto bit_idx = rhs % kBits;
+
+  const std::size_t orig_len = limbs.size();
+  limbs.resize(orig_len + word_idx + (bit_idx > 0 ? 1 : 0));
+
+  if (bit_idx == 0) {
+    // Move all values from last to first (in order not to overwrite values)
+    for (std::size_t i = 0; i < orig_len; ++i) {
+      const std::size_t src = orig_len - i - 1;
+      const std::size_t dst = src + word_idx;
+      if (dst < limbs.size()) {
+        limbs[dst] = limbs[src];
+      }
+    }
+  } else {
+    for (std::size_t i = 0; i < orig_len; ++i) {
+      const std::size_t src = orig_len - i - 1;
+      const std::size_t dst_upper = src + word_idx + 1;
+      const std::size_t dst_lower = src + word_idx;
+      if (dst_upper < limbs.size()) {
+        limbs[dst_upper] |= limbs[src] >> (kBits - bit_idx);
+      }
+      if (dst_lower < limbs.size()) {
+        limbs[dst_lower] = limbs[src] << bit_idx;
+      }
+    }
+  }
+
+  std::fill(limbs.begin(), limbs.begin() + std::min(word_idx, limbs.size()), 0);
+  TrimLeadingZeros(limbs);
+}
+
+template <typename Limbs>
+constexpr void Increment(Limbs& limbs) {
+  for (std::size_t i = 0; i < limbs.size(); ++i) {
+    if (++limbs[i] > 0) {
+      return;
+    }
+  }
+
+  limbs.push_back(1);
+}
+
+/**
+ * @brief ans = lhs * rhs by the schoolbook method
+ * @pre `ans` is filled with lhs.size() + rhs.size() zeros
+ */
+template <typename DoubleLimb, typename Out, typename Lhs, typename Rhs>
+constexpr void MultiplyNaive(Out& ans, const Lhs& lhs, const Rhs& rhs) {
+  using Limb = typename Out::value_type;
+  constexpr auto kBits = kLimbBits<Limb>;
+
+  for (std::size_t i = 0; i < lhs.size(); ++i) {
+    for (std::size_t j = 0; j < rhs.size(); ++j) {
+      DoubleLimb carry = static_cast<DoubleLimb>(lhs[i]) * static_cast<DoubleLimb>(rhs[j]);
+      for (std::size_t k = i + j; carry > 0; ++k) {
+        const auto mul = static_cast<DoubleLimb>(ans[k]) + carry;
+        ans[k] = static_cast<Limb>(mul);
+        carry = mul >> kBits;
+      }
+    }
+  }
+
+  TrimLeadingZeros(ans);
+}
+
+/// limbs *= rhs
+template <typename DoubleLimb, typename Limbs>
+constexpr void MultiplyAssignLimb(Limbs& limbs, typename Limbs::value_type rhs) {
+  using Limb = typename Limbs::value_type;
+  constexpr auto kBits = kLimbBits<Limb>;
+
+  DoubleLimb carry = 0;
+  for (auto& limb : limbs) {
+    const auto product = static_cast<DoubleLimb>(limb) * static_cast<DoubleLimb>(rhs) + carry;
+    limb = static_cast<Limb>(product);
+    carry = product >> kBits;
+  }
+
+  if (carry > 0) {
+    limbs.push_back(static_cast<Limb>(carry));
+  }
+  TrimLeadingZeros(limbs);
+}
+
+/// ans = lhs >> rhs
+template <typename Out, typename Limbs>
+constexpr void ShiftRight(Out& ans, const Limbs& lhs, std::size_t rhs) {
+  constexpr auto kBits = kLimbBits<typename Limbs::value_type>;
+  const auto word_idx = rhs / kBits;
+  const auto bit_idx = rhs % kBits;
+
+  if (word_idx < lhs.size()) {
+    for (std::size_t i = 0; i < lhs.size() - word_idx; ++i) {
+      auto word = lhs[i + word_idx] >> bit_idx;
+      if (bit_idx > 0 && i + word_idx + 1 < lhs.size()) {
+        word |= lhs[i + word_idx + 1] << (kBits - bit_idx);
+      }
+
+      ans.push_back(word);
+    }
+  }
+
+  TrimLeadingZeros(ans);
+}
+
+/// limbs = limbs % (2 ** n)
+template <typename Limbs>
+constexpr void ModAssign2Pow(Limbs& limbs, std::size_t n) {
+  using Limb = typename Limbs::value_type;
+  constexpr auto kBits = kLimbBits<Limb>;
+  const auto word_idx = n / kBits;
+  const auto bit_idx = n % kBits;
+
+  if (limbs.size() <= word_idx) {
+    return;
+  }
+
+  limbs.resize(word_idx + 1);
+  limbs.back() &= (Limb{1} << bit_idx) - 1;
+  TrimLeadingZeros(limbs);
+}
+
+/// limbs += 2 ** n
+template <typename DoubleLimb, typename Limbs>
+constexpr void AddAssign2Pow(Limbs& limbs, std::size_t n) {
+  using Limb = typename Limbs::value_type;
+  constexpr auto kBits = kLimbBits<Limb>;
+  const auto word_idx = n / kBits;
+  const auto bit_idx = n % kBits;
+  if (word_idx >= limbs.size()) {
+    // Extend if (1 << n) is out of range
+    limbs.resize(word_idx + 1);
+  }
+
+  DoubleLimb carry = DoubleLimb{1} << bit_idx;
+  for (std::size_t i = word_idx; i < limbs.size() && carry > 0; ++i) {
+    const DoubleLimb sum = static_cast<DoubleLimb>(limbs[i]) + carry;
+    limbs[i] = static_cast<Limb>(sum);
+    carry = sum >> kBits;
+  }
+
+  if (carry > 0) {
+    limbs.push_back(static_cast<Limb>(carry));
+  }
+}
+
+/// lhs += rhs << shift
+template <typename DoubleLimb, typename Lhs, typename Rhs>
+constexpr void ShlAddAssign(Lhs& lhs, const Rhs& rhs, const std::size_t shift) {
+  using Limb = typename Lhs::value_type;
+  constexpr auto kBits = kLimbBits<Limb>;
+  const auto word_idx = shift / kBits;
+  const auto bit_idx = shift % kBits;
+
+  DoubleLimb carry = 0;
+  for (std::size_t i = 0; i < rhs.size() || carry > 0; ++i) {
+    DoubleLimb lhs_value = 0;
+    if (i + word_idx < lhs.size()) {
+      lhs_value = static_cast<DoubleLimb>(lhs[word_idx + i]);
+    }
+    DoubleLimb rhs_value = 0;
+    if (i < rhs.size()) {
+      rhs_value = static_cast<DoubleLimb>(rhs[i]) << bit_idx;
+    }
+
+    const auto sum = carry + lhs_value + rhs_value;
+    if (i + word_idx >= lhs.size()) {
+      lhs.resize(i + word_idx + 1);
+    }
+    lhs[i + word_idx] = static_cast<Limb>(sum);
+    carry = sum >> kBits;
+  }
+
+  TrimLeadingZeros(lhs);
+}
+
+/// The `i`-th limb of `limbs << shift`
+template <typename Limbs>
+constexpr typename Limbs::value_type ShiftedLimb(const Limbs& limbs, std::size_t i, std::size_t shift) noexcept {
+  using Limb = typename Limbs::value_type;
+  constexpr auto kBits = kLimbBits<Limb>;
+  const auto word_idx = shift / kBits;
+  const auto bit_idx = shift % kBits;
+
+  if (i < word_idx) {
+    return 0;
+  }
+
+  const auto j = i - word_idx;
+  Limb ans = j < limbs.size() ? static_cast<Limb>(limbs[j] << bit_idx) : 0;
+  if (bit_idx > 0 && j >= 1 && j - 1 < limbs.size()) {
+    ans |= static_cast<Limb>(limbs[j - 1] >> (kBits - bit_idx));
+  }
+  return ans;
+}
+
+/// Compare lhs with rhs << shift
+template <typename Lhs, typename Rhs>
+constexpr std::strong_ordering CompareShl(const Lhs& lhs, const Rhs& rhs, std::size_t shift) noexcept {
+  if (rhs.empty()) {
+    return lhs.empty() ? std::strong_ordering::equal : std::strong_ordering::greater;
+  }
+
+  const auto lhs_bits = NumberOfBits(lhs);
+  const auto rhs_bits = NumberOfBits(rhs) + shift;
+  if (lhs_bits != rhs_bits) {
+    return lhs_bits <=> rhs_bits;
+  }
+
+  // Both sides have the same number of limbs
+  for (std::size_t i = lhs.size(); i > 0; --i) {
+    const auto rhs_value = ShiftedLimb(rhs, i - 1, shift);
+    if (lhs[i - 1] != rhs_value) {
+      return lhs[i - 1] <=> rhs_value;
+    }
+  }
+  return std::strong_ordering::equal;
+}
+
+/// lhs -= rhs << shift
+/// @pre lhs >= rhs << shift
+template <typename Lhs, typename Rhs>
+constexpr void ShlSubAssign(Lhs& lhs, const Rhs& rhs, std::size_t shift) {
+  using Limb = typename Lhs::value_type;
+  constexpr auto kBits = kLimbBits<Limb>;
+
+  if (CompareShl(lhs, rhs, shift) < 0) {
+    throw std::out_of_range("`*this - (rhs << shift)` must not be negative");
+  }
+
+  // `rhs << shift` spans limbs up to `rhs_end`
+  const auto rhs_end = rhs.size() + shift / kBits + 1;
+  bool borrow = false;
+  for (std::size_t i = shift / kBits; i < lhs.size() && (i < rhs_end || borrow); ++i) {
+    const Limb result1 = lhs[i] - static_cast<Limb>(borrow);
+    borrow = lhs[i] < result1;
+    const Limb result2 = result1 - ShiftedLimb(rhs, i, shift);
+    borrow |= result1 < result2;
+
+    lhs[i] = result2;
+  }
+
+  TrimLeadingZeros(lhs);
+}
+
+/// lhs = (rhs << shift) - lhs
+/// @pre rhs << shift >= lhs
+template <typename Lhs, typename Rhs>
+constexpr void ShlReverseSubAssign(Lhs& lhs, const Rhs& rhs, std::size_t shift) {
+  using Limb = typename Lhs::value_type;
+  constexpr auto kBits = kLimbBits<Limb>;
+
+  if (CompareShl(lhs, rhs, shift) > 0) {
+    throw std::out_of_range("`(rhs << shift) - *this` must not be negative");
+  }
+
+  lhs.resize(DivCeil<std::size_t>(NumberOfBits(rhs) + shift, kBits));
+  bool borrow = false;
+  for (std::size_t i = 0; i < lhs.size(); ++i) {
+    const auto rhs_value = ShiftedLimb(rhs, i, shift);
+    const Limb result1 = rhs_value - static_cast<Limb>(borrow);
+    borrow = rhs_value < result1;
+    const Limb result2 = result1 - lhs[i];
+    borrow |= result1 < result2;
+
+    lhs[i] = result2;
+  }
+
+  TrimLeadingZeros(lhs);
+}
+
+/// ans = (limbs >> shift) % (2 ** mod)
+template <typename DoubleLimb, typename Out, typename Limbs>
+constexpr void ShiftMod2Pow(Out& ans, const Limbs& limbs, std::size_t shift, std::size_t mod) {
+  using Limb = typename Limbs::value_type;
+  constexpr auto kBits = kLimbBits<Limb>;
+  const auto shift_word_idx = shift / kBits;
+  const auto shift_bit_idx = shift % kBits;
+  const auto mod_word_idx = mod / kBits;
+  const auto mod_bit_idx = mod % kBits;
+
+  if (limbs.size() < shift_word_idx) {
+    return;
+  }
+
+  for (std::size_t i = 0; i < mod_word_idx + 1; ++i) {
+    const auto src_lower = i + shift_word_idx;
+    const auto src_upper = src_lower + 1;
+    if (src_lower < limbs.size()) {
+      DoubleLimb word = static_cast<DoubleLimb>(limbs[src_lower]);
+      if (src_upper < limbs.size()) {
+        word |= static_cast<DoubleLimb>(limbs[src_upper]) << kBits;
+      }
+      ans.push_back(static_cast<Limb>(word >> shift_bit_idx));
+    } else {
+      break;
+    }
+  }
+
+  if (ans.size() == mod_word_idx + 1) {
+    if (mod_bit_idx > 0) {
+      ans[mod_word_idx] &= (Limb{1} << mod_bit_idx) - 1;
+    } else {
+      ans.pop_back();
+    }
+  }
+
+  TrimLeadingZeros(ans);
+}
+
+/**
+ * @brief Repack the limbs of `src` into limbs of another width
+ * @pre The sum of the widths of both limbs is at most 128 bits
+ */
+template <typename Out, typename Limbs>
+constexpr void RepackLimbs(Out& ans, const Limbs& src) {
+  using OutLimb = typename Out::value_type;
+  constexpr auto kSrcBits = kLimbBits<typename Limbs::value_type>;
+  constexpr auto kOutBits = kLimbBits<OutLimb>;
+  static_assert(kSrcBits + kOutBits <= 128);
+
+  uint128_t buffer = 0;
+  std::size_t buffer_bits = 0;
+  for (std::size_t i = 0; i < src.size(); ++i) {
+    buffer |= static_cast<uint128_t>(src[i]) << buffer_bits;
+    buffer_bits += kSrcBits;
+    while (buffer_bits >= kOutBits) {
+      ans.push_back(static_cast<OutLimb>(buffer));
+      buffer >>= kOutBits;
+      buffer_bits -= kOutBits;
+    }
+  }
+
+  if (buffer_bits > 0) {
+    ans.push_back(static_cast<OutLimb>(buffer));
+  }
+
+  TrimLeadingZeros(ans);
+}
+// </Limb Algorithms>
+}  // namespace detail
+
+/**
+ * @brief An arbitrary precision unsigned integer
+ * @tparam Limb An unsigned integer type of each limb
+ * @tparam DoubleLimb An unsigned integer type twice as wide as `Limb`
+ *
+ * The number is stored as a little-endian sequence of limbs without leading zeros. Use the aliases `BigUint` (64-bit
+ * limbs) and `BigUint32` (32-bit limbs) instead of this template directly.
+ */
+template <typename Limb, typename DoubleLimb>
+class BasicBigUint : public std::vector<Limb> {
+  static_assert(std::numeric_limits<Limb>::is_integer && !std::numeric_limits<Limb>::is_signed);
+  static_assert(std::numeric_limits<DoubleLimb>::digits == 2 * std::numeric_limits<Limb>::digits);
+
+  using Base = std::vector<Limb>;
 
  public:
+  /// The number of bits in a limb
+  static constexpr std::size_t kLimbBits = detail::kLimbBits<Limb>;
+
   // <Constructors>
   /// Construct from a uint64 value
-  constexpr explicit BigUint(uint64_t value) : Base{value} {}
+  constexpr explicit BasicBigUint(uint64_t value) {
+    if constexpr (kLimbBits >= 64) {
+      this->push_back(static_cast<Limb>(value));
+    } else {
+      while (value > 0) {
+        this->push_back(static_cast<Limb>(value));
+        value >>= kLimbBits;
+      }
+    }
+  }
   /// Construct from a vector
-  constexpr explicit BigUint(std::vector<uint64_t> values) : Base{std::move(values)} { TrimLeadingZeros(); }
+  constexpr explicit BasicBigUint(std::vector<Limb> values) : Base{std::move(values)} { TrimLeadingZeros(); }
   /// Construct from a initializer list
-  constexpr explicit BigUint(std::initializer_list<uint64_t> value) : Base{std::move(value)} { TrimLeadingZeros(); }
-
-  constexpr BigUint() = default;
-  constexpr BigUint(const BigUint&) = default;
-  constexpr BigUint(BigUint&&) noexcept = default;
-  constexpr BigUint& operator=(const BigUint&) = default;
-  constexpr BigUint& operator=(BigUint&&) noexcept = default;
-  constexpr ~BigUint() = default;
+  constexpr explicit BasicBigUint(std::initializer_list<Limb> value) : Base{std::move(value)} { TrimLeadingZeros(); }
+
+  constexpr BasicBigUint() = default;
+  constexpr BasicBigUint(const BasicBigUint&) = default;
+  constexpr BasicBigUint(BasicBigUint&&) noexcept = default;
+  constexpr BasicBigUint& operator=(const BasicBigUint&) = default;
+  constexpr BasicBigUint& operator=(BasicBigUint&&) noexcept = default;
+  constexpr ~BasicBigUint() = default;
   // </Constructors>
 
   // <Basic Methods>
   /// Judge if the number is zero(Don't use `empty()` directly outside of this class)
-  constexpr bool IsZero() const noexcept { return empty(); }
+  constexpr bool IsZero() const noexcept { return this->empty(); }
 
   /**
    * @brief Count the number of bits to represent *this
@@ -48,24 +563,15 @@ class BigUint : public std::vector<uint64_t> {
    * BigUint{0x0, 0x1}.NumberOfBits();  // 65
    * ```
    */
-  constexpr uint64_t NumberOfBits() const {
-    // Before calling `this->back()`, we must check if the number is zero.
-    if (IsZero()) {
-      return 0;
-    }
-
-    const uint64_t num_of_bits_back = std::bit_width(this->back());
-    const uint64_t num_of_bits_except_back = (this->size() - 1) * 64;
-    return num_of_bits_back + num_of_bits_except_back;
-  }
+  constexpr uint64_t NumberOfBits() const { return detail::NumberOfBits(*this); }
 
-  constexpr BigUint Pow(uint64_t index) const {
+  constexpr BasicBigUint Pow(uint64_t index) const {
     if (index >= uint64_t{1} << 63) {
       throw std::out_of_range("The index is too big");
     }
 
-    BigUint ans = BigUint{1};
-    BigUint curr_base = *this;
+    BasicBigUint ans = BasicBigUint{1};
+    BasicBigUint curr_base = *this;
     uint64_t curr_index_mask = 1;
 
     while (curr_index_mask <= index) {
@@ -84,16 +590,16 @@ class BigUint : public std::vector<uint64_t> {
     std::ostringstream s;
     s << "0x";
 
-    for (std::size_t i = 0; i < size(); ++i) {
-      const auto j = size() - i - 1;
+    for (std::size_t i = 0; i < this->size(); ++i) {
+      const auto j = this->size() - i - 1;
       if (i == 0) {
-        s << std::hex << (*this)[j];
+        s << std::hex << uint64_t{(*this)[j]};
       } else {
-        s << std::hex << std::setfill('0') << std::setw(16) << (*this)[j];
+        s << std::hex << std::setfill('0') << std::setw(kLimbBits / 4) << uint64_t{(*this)[j]};
       }
     }
 
-    if (empty()) {
+    if (this->empty()) {
       s << "0";
     }
 
@@ -106,38 +612,21 @@ class BigUint : public std::vector<uint64_t> {
    * @throw `std::range_error` if the number is greater than 2^64-1
    */
   constexpr explicit operator uint64_t() const {
-    if (this->empty()) {
-      return 0;
-    } else if (this->size() == 1) {
-      return this->back();
-    } else {
+    if (NumberOfBits() > 64) {
       throw std::range_error("The number is too big");
     }
+
+    uint64_t ans = 0;
+    for (std::size_t i = 0; i < this->size(); ++i) {
+      ans |= static_cast<uint64_t>((*this)[i]) << (i * kLimbBits);
+    }
+    return ans;
   }
   // </Basic Methods>
 
   // <Operators>
-  constexpr BigUint& operator+=(const BigUint& rhs) {
-    this->resize(std::max(this->size(), rhs.size()));
-
-    uint128_t carry = 0;
-    const auto len = this->size();
-    for (std::size_t i = 0; i < len && (i < rhs.size() || carry > 0); ++i) {
-      // We use uint128_t to handle overflows in the additions
-      const auto lhs_value = static_cast<uint128_t>((*this)[i]);
-      const auto rhs_value = (i < rhs.size()) ? static_cast<uint128_t>(rhs[i]) : 0;
-      const auto sum = static_cast<uint128_t>(lhs_value) + static_cast<uint128_t>(rhs_value) + carry;
-
-      // Store lower 64 bits
-      (*this)[i] = static_cast<uint64_t>(sum);
-      // Carry upper 64 bits
-      carry = sum >> 64;
-    }
-
-    if (carry > 0) {
-      this->push_back(carry);
-    }
-
+  constexpr BasicBigUint& operator+=(const BasicBigUint& rhs) {
+    detail::AddAssign<DoubleLimb>(*this, rhs);
     return *this;
   }
 
@@ -147,160 +636,59 @@ class BigUint : public std::vector<uint64_t> {
    * @return `*this` after the subtraction
    * @pre *this >= rhs
    */
-  constexpr BigUint& operator-=(const BigUint& rhs) {
-    if (*this < rhs) {
-      throw std::out_of_range("`*this - rhs` must not be negative");
-    }
-
-    bool borrow = false;
-    for (std::size_t i = 0; i < rhs.size(); ++i) {
-      // (*this)[i] = (*this)[i] - uint64_t{borrow} - rhs[i]
-      // We can judge wether `a - b` caused over flow by evaluating `a < a - b`.
-      const auto result1 = (*this)[i] - static_cast<uint64_t>(borrow);
-      borrow = (*this)[i] < result1;
-      const auto result2 = result1 - rhs[i];
-      borrow |= result1 < result2;
-
-      (*this)[i] = result2;
-    }
-
-    if (borrow) {
-      // Decrement values while the value is zero
-      for (std::size_t i = rhs.size(); i < this->size(); ++i) {
-        if ((*this)[i]-- > 0) {
-          break;
-        }
-      }
-    }
-
-    TrimLeadingZeros();
+  constexpr BasicBigUint& operator-=(const BasicBigUint& rhs) {
+    detail::SubAssign(*this, rhs);
     return *this;
   }
 
-  constexpr BigUint& operator*=(const BigUint& rhs) {
+  constexpr BasicBigUint& operator*=(const BasicBigUint& rhs) {
     // The multiplication requires memory allocation, so we cannot define MulAssign operator efficiently. Therefore, we
     // use the implementation of the multiplication operator.
     *this = *this * rhs;
     return *this;
   }
 
-  constexpr BigUint& operator>>=(const std::size_t& rhs) {
-    const auto word_idx = rhs / 64;
-    const auto bit_idx = rhs % 64;
-
-    std::size_t new_size = 0;
-    if (word_idx < this->size()) {
-      if (bit_idx == 0) {
-        std::move(this->begin() + word_idx, this->end(), this->begin());
-        new_size = this->size() - word_idx;
-      } else {
-        for (std::size_t i = 0; i < this->size() - word_idx; ++i) {
-          //                  i+word_idx+1     i + word_idx
-          // <|----------------|----------------|
-          //               ^                ^
-          //            bit_idx           bit_idx
-          //                |<------------->|
-          //                new (*this)[i]
-          auto word = (*this)[i + word_idx] >> bit_idx;
-          if (i + word_idx + 1 < this->size()) {
-            word |= (*this)[i + word_idx + 1] << (64 - bit_idx);
-          }
-
-          (*this)[i] = word;
-        }
-
-        new_size = std::min(this->size() - word_idx, this->size());
-      }
-    }
-
-    this->resize(new_size);
-    TrimLeadingZeros();
+  constexpr BasicBigUint& operator>>=(const std::size_t& rhs) {
+    detail::ShiftRightAssign(*this, rhs);
     return *this;
   }
 
-  constexpr BigUint& operator<<=(const std::size_t& rhs) {
-    const auto word_idx = rhs / 64;
-    const auto bit_idx = rhs % 64;
-
-    const std::size_t orig_len = this->size();
-    this->resize(orig_len + word_idx + (bit_idx > 0 ? 1 : 0));
-
-    if (bit_idx == 0) {
-      // Move all values from last to first (in order not to overwrite values)
-      for (std::size_t i = 0; i < orig_len; ++i) {
-        const std::size_t src = orig_len - i - 1;
-        const std::size_t dst = src + word_idx;
-        if (dst < this->size()) {
-          (*this)[dst] = (*this)[src];
-        }
-      }
-    } else {
-      for (std::size_t i = 0; i < orig_len; ++i) {
-        const std::size_t src = orig_len - i - 1;
-        const std::size_t dst_upper = src + word_idx + 1;
-        const std::size_t dst_lower = src + word_idx;
-        if (dst_upper < this->size()) {
-          (*this)[dst_upper] |= (*this)[src] >> (64 - bit_idx);
-        }
-        if (dst_lower < this->size()) {
-          (*this)[dst_lower] = (*this)[src] << bit_idx;
-        }
-      }
-    }
-
-    std::fill(this->begin(), this->begin() + std::min(word_idx, this->size()), 0);
-    TrimLeadingZeros();
+  constexpr BasicBigUint& operator<<=(const std::size_t& rhs) {
+    detail::ShiftLeftAssign(*this, rhs);
     return *this;
   }
 
-  constexpr BigUint& operator++() {
-    for (std::size_t i = 0; i < this->size(); ++i) {
-      if (++(*this)[i] > 0) {
-        return *this;
-      }
-    }
-
-    this->push_back(1);
+  constexpr BasicBigUint& operator++() {
+    detail::Increment(*this);
     return *this;
   }
 
-  constexpr BigUint operator++(int) {
-    BigUint ret = *this;
+  constexpr BasicBigUint operator++(int) {
+    BasicBigUint ret = *this;
     operator++();
     return ret;
   }
 
-  friend constexpr BigUint operator+(const BigUint& lhs, const BigUint& rhs) {
-    BigUint tmp = lhs;
+  friend constexpr BasicBigUint operator+(const BasicBigUint& lhs, const BasicBigUint& rhs) {
+    BasicBigUint tmp = lhs;
     tmp += rhs;
     return tmp;
   }
 
-  friend constexpr BigUint operator-(const BigUint& lhs, const BigUint& rhs) {
-    BigUint tmp = lhs;
+  friend constexpr BasicBigUint operator-(const BasicBigUint& lhs, const BasicBigUint& rhs) {
+    BasicBigUint tmp = lhs;
     tmp -= rhs;
     return tmp;
   }
 
-  friend constexpr BigUint MultiplyNaive(const BigUint& lhs, const BigUint& rhs) {
-    std::vector<uint64_t> ans(lhs.size() + rhs.size());
-    for (std::size_t i = 0; i < lhs.size(); ++i) {
-      for (std::size_t j = 0; j < rhs.size(); ++j) {
-        uint128_t carry = static_cast<uint128_t>(lhs[i]) * static_cast<uint128_t>(rhs[j]);
-        for (std::size_t k = i + j; carry > 0; ++k) {
-          const auto mul = static_cast<uint128_t>(ans[k]) + carry;
-          ans[k] = static_cast<uint64_t>(mul);
-          carry = mul >> 64;
-        }
-      }
-    }
-
-    BigUint ret = BigUint(std::move(ans));
-    ret.TrimLeadingZeros();
-    return ret;
+  friend constexpr BasicBigUint MultiplyNaive(const BasicBigUint& lhs, const BasicBigUint& rhs) {
+    BasicBigUint ans;
+    ans.resize(lhs.size() + rhs.size());
+    detail::MultiplyNaive<DoubleLimb>(ans, lhs, rhs);
+    return ans;
   }
 
-  friend constexpr BigUint MultiplyKaratsuba(const BigUint& lhs, const BigUint& rhs) {
+  friend constexpr BasicBigUint MultiplyKaratsuba(const BasicBigUint& lhs, const BasicBigUint& rhs) {
     const auto max_byte_len = std::max(lhs.size(), rhs.size());
     const auto min_byte_len = std::min(lhs.size(), rhs.size());
 
@@ -308,7 +696,7 @@ class BigUint : public std::vector<uint64_t> {
       return MultiplyNaive(lhs, rhs);
     }
 
-    const auto shift_bits = (max_byte_len + 1) / 2 * 64;
+    const auto shift_bits = (max_byte_len + 1) / 2 * kLimbBits;
     const auto lhs_high = lhs >> shift_bits;
     const auto rhs_high = rhs >> shift_bits;
     const auto lhs_low = lhs.ShiftMod2Pow(0, shift_bits);
@@ -318,13 +706,13 @@ class BigUint : public std::vector<uint64_t> {
     const auto k2 = MultiplyKaratsuba(lhs_high, rhs_high);
     const auto k3 = MultiplyKaratsuba(lhs_high + lhs_low, rhs_high + rhs_low);
 
-    BigUint result = k1;
+    BasicBigUint result = k1;
     result.ShlAddAssign(k2, 2 * shift_bits);
     result.ShlAddAssign(k3 - k1 - k2, shift_bits);
     return result;
   }
 
-  friend constexpr BigUint operator*(const BigUint& lhs, const BigUint& rhs) {
+  friend constexpr BasicBigUint operator*(const BasicBigUint& lhs, const BasicBigUint& rhs) {
     const auto min_byte_len = std::min(lhs.size(), rhs.size());
 
     if (min_byte_len <= 64) {
@@ -334,52 +722,24 @@ class BigUint : public std::vector<uint64_t> {
     }
   }
 
-  friend constexpr BigUint operator>>(const BigUint& lhs, const std::size_t& rhs) {
+  friend constexpr BasicBigUint operator>>(const BasicBigUint& lhs, const std::size_t& rhs) {
     // Don't use operator>>= because it requires the whole copy of `lhs`
-    const auto word_idx = rhs / 64;
-    const auto bit_idx = rhs % 64;
-
-    std::vector<uint64_t> ans;
-    if (word_idx < lhs.size()) {
-      for (std::size_t i = 0; i < lhs.size() - word_idx; ++i) {
-        auto word = lhs[i + word_idx] >> bit_idx;
-        if (bit_idx > 0 && i + word_idx + 1 < lhs.size()) {
-          word |= lhs[i + word_idx + 1] << (64 - bit_idx);
-        }
-
-        ans.push_back(word);
-      }
-    }
-
-    BigUint ret = BigUint(std::move(ans));
-    ret.TrimLeadingZeros();
-    return ret;
+    BasicBigUint ans;
+    detail::ShiftRight(ans, lhs, rhs);
+    return ans;
   }
 
-  friend constexpr BigUint operator<<(const BigUint& lhs, const std::size_t& rhs) {
-    BigUint tmp = lhs;
+  friend constexpr BasicBigUint operator<<(const BasicBigUint& lhs, const std::size_t& rhs) {
+    BasicBigUint tmp = lhs;
     tmp <<= rhs;
     return tmp;
   }
 
-  friend constexpr std::strong_ordering operator<=>(const BigUint& lhs, const BigUint& rhs) noexcept {
-    if (lhs.size() != rhs.size()) {
-      return lhs.size() <=> rhs.size();
-    } else {
-      const auto len = lhs.size();
-      for (std::size_t i = 0; i < len; ++i) {
-        const auto lhs_value = lhs[len - i - 1];
-        const auto rhs_value = rhs[len - i - 1];
-        if (lhs_value != rhs_value) {
-          return lhs_value <=> rhs_value;
-        }
-      }
-
-      return std::strong_ordering::equal;
-    }
+  friend constexpr std::strong_ordering operator<=>(const BasicBigUint& lhs, const BasicBigUint& rhs) noexcept {
+    return detail::Compare(lhs, rhs);
   }
 
-  friend constexpr bool operator==(const BigUint& lhs, const BigUint& rhs) noexcept = default;
+  friend constexpr bool operator==(const BasicBigUint& lhs, const BasicBigUint& rhs) noexcept = default;
   // </Operators>
 
   // <Minor Methods>
@@ -390,18 +750,8 @@ class BigUint : public std::vector<uint64_t> {
    * @brief *this = *this % (2 ** n)
    * @param n Index of power of 2
    */
-  constexpr BigUint& ModAssign2Pow(std::size_t n) {
-    const auto word_idx = n / 64;
-    const auto bit_idx = n % 64;
-
-    if (this->size() <= word_idx) {
-      return *this;
-    }
-
-    this->resize(word_idx + 1);
-    this->back() &= (uint64_t{1} << bit_idx) - 1;
-    TrimLeadingZeros();
-
+  constexpr BasicBigUint& ModAssign2Pow(std::size_t n) {
+    detail::ModAssign2Pow(*this, n);
     return *this;
   }
 
@@ -409,25 +759,8 @@ class BigUint : public std::vector<uint64_t> {
    * @brief *this += 2 ** n
    * @param n Index of power of 2
    */
-  constexpr BigUint& AddAssign2Pow(std::size_t n) {
-    const auto word_idx = n / 64;
-    const auto bit_idx = n % 64;
-    if (word_idx >= this->size()) {
-      // Extend if (1 << n) is out of range
-      this->resize(word_idx + 1);
-    }
-
-    uint128_t carry = uint128_t{1} << bit_idx;
-    for (std::size_t i = word_idx; i < this->size() && carry > 0; ++i) {
-      const uint128_t sum = static_cast<uint128_t>((*this)[i]) + carry;
-      (*this)[i] = static_cast<uint64_t>(sum);
-      carry = sum >> 64;
-    }
-
-    if (carry > 0) {
-      this->push_back(carry);
-    }
-
+  constexpr BasicBigUint& AddAssign2Pow(std::size_t n) {
+    detail::AddAssign2Pow<DoubleLimb>(*this, n);
     return *this;
   }
 
@@ -437,85 +770,74 @@ class BigUint : public std::vector<uint64_t> {
    * @param shift
    * @return
    */
-  constexpr BigUint& ShlAddAssign(const BigUint& rhs, const std::size_t shift) {
-    const auto word_idx = shift / 64;
-    const auto bit_idx = shift % 64;
-
-    uint128_t carry = 0;
-    for (std::size_t i = 0; i < rhs.size() || carry > 0; ++i) {
-      uint128_t lhs_value = 0;
-      if (i + word_idx < this->size()) {
-        lhs_value = static_cast<uint128_t>((*this)[word_idx + i]);
-      }
-      uint128_t rhs_value = 0;
-      if (i < rhs.size()) {
-        rhs_value = static_cast<uint128_t>(rhs[i]) << bit_idx;
-      }
-
-      const auto sum = carry + static_cast<uint128_t>(lhs_value) + static_cast<uint128_t>(rhs_value);
-      if (i + word_idx >= this->size()) {
-        this->resize(i + word_idx + 1);
-      }
-      (*this)[i + word_idx] = static_cast<uint64_t>(sum);
-      carry = sum >> 64;
-    }
-
-    TrimLeadingZeros();
+  constexpr BasicBigUint& ShlAddAssign(const BasicBigUint& rhs, const std::size_t shift) {
+    detail::ShlAddAssign<DoubleLimb>(*this, rhs, shift);
     return *this;
   }
 
   /**
-   * @brief (*this >> shift) % (2 ** mod)
+   * @brief *this -= rhs << shift
+   * @pre *this >= rhs << shift
    */
-  constexpr BigUint ShiftMod2Pow(std::size_t shift, std::size_t mod) const {
-    const auto shift_word_idx = shift / 64;
-    const auto shift_bit_idx = shift % 64;
-    const auto mod_word_idx = mod / 64;
-    const auto mod_bit_idx = mod % 64;
-
-    if (this->size() < shift_word_idx) {
-      return BigUint{};
-    }
+  constexpr BasicBigUint& ShlSubAssign(const BasicBigUint& rhs, const std::size_t shift) {
+    detail::ShlSubAssign(*this, rhs, shift);
+    return *this;
+  }
 
-    std::vector<uint64_t> ans;
-    ans.reserve(mod_word_idx + 1);
-    for (std::size_t i = 0; i < mod_word_idx + 1; ++i) {
-      const auto src_lower = i + shift_word_idx;
-      const auto src_upper = src_lower + 1;
-      if (src_lower < this->size()) {
-        uint128_t word = static_cast<uint128_t>((*this)[src_lower]);
-        if (src_upper < this->size()) {
-          word |= static_cast<uint128_t>((*this)[src_upper]) << 64;
-        }
-        ans.push_back(static_cast<uint64_t>(word >> shift_bit_idx));
-      } else {
-        break;
-      }
-    }
+  /**
+   * @brief *this = (rhs << shift) - *this
+   * @pre rhs << shift >= *this
+   */
+  constexpr BasicBigUint& ShlReverseSubAssign(const BasicBigUint& rhs, const std::size_t shift) {
+    detail::ShlReverseSubAssign(*this, rhs, shift);
+    return *this;
+  }
 
-    if (ans.size() == mod_word_idx + 1) {
-      if (mod_bit_idx > 0) {
-        ans[mod_word_idx] &= (uint64_t{1} << mod_bit_idx) - 1;
-      } else {
-        ans.pop_back();
-      }
-    }
+  /// Compare *this with rhs << shift without shifting `rhs`
+  constexpr std::strong_ordering CompareShl(const BasicBigUint& rhs, const std::size_t shift) const noexcept {
+    return detail::CompareShl(*this, rhs, shift);
+  }
 
-    BigUint ret(std::move(ans));
-    ret.TrimLeadingZeros();
-    return ret;
+  /**
+   * @brief (*this >> shift) % (2 ** mod)
+   */
+  constexpr BasicBigUint ShiftMod2Pow(std::size_t shift, std::size_t mod) const {
+    BasicBigUint ans;
+    ans.reserve(mod / kLimbBits + 1);
+    detail::ShiftMod2Pow<DoubleLimb>(ans, *this, shift, mod);
+    return ans;
   }
   // </Minor Methods>
 
  private:
-  constexpr BigUint& TrimLeadingZeros() noexcept {
-    while (!this->empty() && this->back() == 0) {
-      this->pop_back();
-    }
-
+  constexpr BasicBigUint& TrimLeadingZeros() noexcept {
+    detail::TrimLeadingZeros(*this);
     return *this;
   }
 };
+
+/// An unsigned integer with 64-bit limbs
+using BigUint = BasicBigUint<uint64_t, uint128_t>;
+/// An unsigned integer with 32-bit limbs
+using BigUint32 = BasicBigUint<uint32_t, uint64_t>;
+
+/**
+ * @brief Convert the limb width of `num`
+ * @tparam To `BasicBigUint` with the new limb width
+ * @param num The number to be converted
+ * @return The same value represented by `To`
+ *
+ * ```cpp
+ * const auto x = LimbCast<BigUint32>(BigUint{0x334, 0x264});
+ * ```
+ */
+template <typename To, typename Limb, typename DoubleLimb>
+constexpr To LimbCast(const BasicBigUint<Limb, DoubleLimb>& num) {
+  To ans;
+  ans.reserve(DivCeil(num.NumberOfBits(), To::kLimbBits));
+  detail::RepackLimbs(ans, num);
+  return ans;
+}
 }  // namespace komori
 
-#endif  // KOMORI_BIGUINT_HPP_
\ No newline at end of file
+#endif  // KOMORI_BIGUINT_HPP_
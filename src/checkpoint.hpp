@@ -0,0 +1,76 @@
+#ifndef KOMORI_CHECKPOINT_HPP_
+#define KOMORI_CHECKPOINT_HPP_
+
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <utility>
+
+#include "serialize.hpp"
+
+namespace komori {
+/**
+ * @brief A directory of intermediate results of a long computation
+ *
+ * Each entry is a file that holds a sequence of serialized numbers. An entry is written to a temporary file and
+ * renamed, so a crash leaves either the complete entry or no entry. An entry that cannot be read is treated as missing
+ * and is recomputed by the caller.
+ */
+class Checkpoint {
+ public:
+  /// Open `directory`, creating it if it does not exist
+  explicit Checkpoint(std::filesystem::path directory) : directory_{std::move(directory)} {
+    std::filesystem::create_directories(directory_);
+  }
+
+  const std::filesystem::path& Directory() const noexcept { return directory_; }
+
+  bool Exists(const std::string& name) const { return std::filesystem::exists(PathOf(name)); }
+
+  /// Write `values` to the entry `name`, replacing the old one
+  template <typename... Ts>
+  void Save(const std::string& name, const Ts&... values) const {
+    const auto path = PathOf(name);
+    auto tmp_path = path;
+    tmp_path += ".tmp";
+
+    {
+      std::ofstream os(tmp_path, std::ios::binary | std::ios::trunc);
+      if (!os) {
+        throw SerializeError("Failed to open " + tmp_path.string());
+      }
+      (Serialize(os, values), ...);
+      os.flush();
+      if (!os) {
+        throw SerializeError("Failed to write " + tmp_path.string());
+      }
+    }
+    std::filesystem::rename(tmp_path, path);
+  }
+
+  /// Read the entry `name` written by `Save<Ts...>()`. It returns `std::nullopt` if the entry is missing or broken.
+  template <typename... Ts>
+  std::optional<std::tuple<Ts...>> Load(const std::string& name) const {
+    std::ifstream is(PathOf(name), std::ios::binary);
+    if (!is) {
+      return std::nullopt;
+    }
+
+    try {
+      // Braced initialization reads the values in order
+      return std::tuple<Ts...>{Deserialize<Ts>(is)...};
+    } catch (const SerializeError&) {
+      return std::nullopt;
+    }
+  }
+
+ private:
+  std::filesystem::path PathOf(const std::string& name) const { return directory_ / (name + ".bin"); }
+
+  std::filesystem::path directory_;
+};
+}  // namespace komori
+
+#endif  // KOMORI_CHECKPOINT_HPP_
@@ -0,0 +1,209 @@
+#ifndef KOMORI_CONSTANTS_HPP_
+#define KOMORI_CONSTANTS_HPP_
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <numbers>
+#include <string>
+#include <string_view>
+
+#include "bigfixed.hpp"
+#include "bigint.hpp"
+#include "hypergeometric.hpp"
+#include "planner.hpp"
+
+namespace komori {
+namespace detail {
+/// log2(n!)
+inline double Log2Factorial(uint64_t n) {
+  return std::lgamma(static_cast<double>(n) + 1) / std::numbers::ln2;
+}
+
+/// log2(3 * 5 * ... * (2n + 1)) = log2((2n + 1)!) - n - log2(n!)
+inline double Log2OddProduct(uint64_t n) {
+  return Log2Factorial(2 * n + 1) - static_cast<double>(n) - Log2Factorial(n);
+}
+
+/**
+ * @brief The number of terms of an alternating series whose k-th term is at most a(k) 2^(-bits_per_term k)
+ *
+ * The terms decrease, so the truncation error is less than the first omitted term a(n + 1) 2^(-bits_per_term (n + 1)).
+ */
+template <typename A>
+constexpr uint64_t AlternatingTermsFor(uint64_t bits, uint64_t bits_per_term, A a) {
+  uint64_t terms = 0;
+  while (bits_per_term * (terms + 1) < bits + static_cast<uint64_t>(std::bit_width(a(terms + 1)))) {
+    ++terms;
+  }
+  return terms;
+}
+
+/// The number of extra fractional bits to absorb the rounding errors of the final division or square root
+inline constexpr uint64_t kConstantGuardBits = kFinalStageErrorBits + 4;
+
+/// The constants computed for `digits` digits are within 2^(-ConstantErrorBits(digits)) of the true values
+constexpr inline uint64_t ConstantErrorBits(uint64_t digits) {
+  return static_cast<uint64_t>(static_cast<double>(digits) * kLog2Of10) + 2;
+}
+
+/// The number of fractional bits to compute `digits` decimal digits after the decimal point
+constexpr inline uint64_t ConstantFracBits(uint64_t digits) {
+  return ConstantErrorBits(digits) + kConstantGuardBits;
+}
+
+/// The number of digits added when the truncation of a constant is ambiguous. It doubles on each retry.
+inline constexpr uint64_t kConstantRetryDigits = 8;
+}  // namespace detail
+
+// <Series>
+/// e = sum_k 1 / k!
+struct ESeries {
+  constexpr HypergeometricTerm Term(uint64_t k) const {
+    if (k == 0) {
+      return {{}, {}, {1}, Sign::kPositive};
+    }
+    return {{}, {k}, {1}, Sign::kPositive};
+  }
+
+  double EstimateQBits(uint64_t n) const { return detail::Log2Factorial(n); }
+
+  constexpr uint64_t SieveLimit(uint64_t n) const noexcept { return n; }
+
+  /// The truncation error after n terms is less than 2 / (n + 1)!, and floor(log2(k)) bounds log2(k) from below
+  constexpr uint64_t TermsFor(uint64_t bits) const {
+    uint64_t terms = 0;
+    uint64_t log2_factorial = 0;
+    while (log2_factorial < bits + 1) {
+      ++terms;
+      log2_factorial += static_cast<uint64_t>(std::bit_width(terms + 1)) - 1;
+    }
+    return terms;
+  }
+
+  constexpr std::string_view Name() const noexcept { return "e"; }
+};
+
+/// ln(2) = 3/4 sum_k (-1)^k (k!)^2 / (2^k (2k + 1)!), whose terms decrease by a factor of 8
+struct Ln2Series {
+  constexpr HypergeometricTerm Term(uint64_t k) const {
+    if (k == 0) {
+      return {{}, {}, {1}, Sign::kPositive};
+    }
+    return {{k}, {4, 2 * k + 1}, {1}, (k % 2 == 0) ? Sign::kPositive : Sign::kNegative};
+  }
+
+  /// sum_{k<=n} log2(4 (2k + 1))
+  double EstimateQBits(uint64_t n) const { return 2 * static_cast<double>(n) + detail::Log2OddProduct(n); }
+
+  constexpr uint64_t SieveLimit(uint64_t n) const noexcept { return 2 * n + 1; }
+
+  constexpr uint64_t TermsFor(uint64_t bits) const {
+    return detail::AlternatingTermsFor(bits, 3, [](uint64_t) { return uint64_t{1}; });
+  }
+
+  constexpr std::string_view Name() const noexcept { return "ln2"; }
+};
+
+/// zeta(3) = 1/64 sum_k (-1)^k (205k^2 + 250k + 77) (k!)^10 / ((2k + 1)!)^5 (Amdeberhan), ~10 bits per term
+struct Zeta3Series {
+  constexpr HypergeometricTerm Term(uint64_t k) const {
+    const auto a = 205 * k * k + 250 * k + 77;
+    if (k == 0) {
+      return {{}, {}, {a}, Sign::kPositive};
+    }
+    const auto odd = 2 * k + 1;
+    return {{k, k, k, k, k}, {32, odd, odd, odd, odd, odd}, {a}, (k % 2 == 0) ? Sign::kPositive : Sign::kNegative};
+  }
+
+  /// sum_{k<=n} log2(32 (2k + 1)^5)
+  double EstimateQBits(uint64_t n) const { return 5 * static_cast<double>(n) + 5 * detail::Log2OddProduct(n); }
+
+  constexpr uint64_t SieveLimit(uint64_t n) const noexcept { return 2 * n + 1; }
+
+  constexpr uint64_t TermsFor(uint64_t bits) const {
+    return detail::AlternatingTermsFor(bits, 10, [](uint64_t k) { return 205 * k * k + 250 * k + 77; });
+  }
+
+  constexpr std::string_view Name() const noexcept { return "zeta3"; }
+};
+
+/**
+ * @brief Catalan's constant G = 1/18 sum_k (-1)^k (40k^2 + 56k + 19) R(k)
+ *
+ * R(k) = prod_{j<=k} 32 j^3 (2j - 1) / ((4j + 1)^2 (4j + 3)^2) is below 4^(-k), so each term adds ~2 bits.
+ */
+struct CatalanSeries {
+  constexpr HypergeometricTerm Term(uint64_t k) const {
+    const auto a = 40 * k * k + 56 * k + 19;
+    if (k == 0) {
+      return {{}, {}, {a}, Sign::kPositive};
+    }
+    return {{32, k, k, k, 2 * k - 1},
+            {4 * k + 1, 4 * k + 1, 4 * k + 3, 4 * k + 3},
+            {a},
+            (k % 2 == 0) ? Sign::kPositive : Sign::kNegative};
+  }
+
+  /// sum_{k<=n} log2((4k + 1)^2 (4k + 3)^2) ~ sum_{k<=n} 4 log2(2 (2k + 1))
+  double EstimateQBits(uint64_t n) const { return 4 * static_cast<double>(n) + 4 * detail::Log2OddProduct(n); }
+
+  constexpr uint64_t SieveLimit(uint64_t n) const noexcept { return 4 * n + 3; }
+
+  constexpr uint64_t TermsFor(uint64_t bits) const {
+    return detail::AlternatingTermsFor(bits, 2, [](uint64_t k) { return 40 * k * k + 56 * k + 19; });
+  }
+
+  constexpr std::string_view Name() const noexcept { return "catalan"; }
+};
+// </Series>
+
+// <Constants>
+// Each function returns the constant within a quarter of 10^(-digits). Its first `digits` decimal digits after the
+// decimal point may still be off by one in the last digit. See `GetConstantString()`.
+
+constexpr inline BigFixed ComputeE(uint64_t digits, const SeriesOptions& options = {}) {
+  return ComputeSeriesSum(ESeries{}, detail::ConstantFracBits(digits), 1, 1, options);
+}
+
+constexpr inline BigFixed ComputeLn2(uint64_t digits, const SeriesOptions& options = {}) {
+  return ComputeSeriesSum(Ln2Series{}, detail::ConstantFracBits(digits), 3, 4, options);
+}
+
+constexpr inline BigFixed ComputeZeta3(uint64_t digits, const SeriesOptions& options = {}) {
+  return ComputeSeriesSum(Zeta3Series{}, detail::ConstantFracBits(digits), 1, 64, options);
+}
+
+constexpr inline BigFixed ComputeCatalan(uint64_t digits, const SeriesOptions& options = {}) {
+  return ComputeSeriesSum(CatalanSeries{}, detail::ConstantFracBits(digits), 1, 18, options);
+}
+
+/// The golden ratio (1 + sqrt(5)) / 2, which needs a square root instead of a series
+constexpr inline BigFixed ComputeGoldenRatio(uint64_t digits) {
+  const auto frac_bits = detail::ConstantFracBits(digits);
+  return (BigFixed(frac_bits, BigInt{1}) + Sqrt(BigFixed(frac_bits, BigInt{5}))) >> 1;
+}
+
+/**
+ * @brief Get the decimal representation of a constant in [0, 10) with exactly `digits` digits after the decimal point
+ * @param compute A function that computes the constant for a number of digits, e.g. `[](uint64_t d) { return
+ *                ComputeE(d); }`
+ *
+ * The constant is computed again with more digits while its truncation is ambiguous. See `IsTruncationExact()`.
+ */
+template <typename Compute>
+constexpr std::string GetConstantString(Compute compute, uint64_t digits) {
+  for (uint64_t extra = 0;; extra = std::max(2 * extra, detail::kConstantRetryDigits)) {
+    const auto value = compute(digits + extra);
+    if (IsTruncationExact(value, digits, detail::ConstantErrorBits(digits + extra))) {
+      auto str = ToDecimalString(value);
+      str.resize(digits + 2);
+      return str;
+    }
+  }
+}
+// </Constants>
+}  // namespace komori
+
+#endif  // KOMORI_CONSTANTS_HPP_
@@ -0,0 +1,458 @@
+#ifndef KOMORI_DECIMAL_HPP_
+#define KOMORI_DECIMAL_HPP_
+
+#include <array>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bigfloat.hpp"
+#include "biguint.hpp"
+#include "io.hpp"
+#include "ssa.hpp"
+
+namespace komori {
+/// The radix of `DecimalBigUint`
+inline constexpr uint64_t kDecimalBase = 10'000'000'000'000'000'000ULL;
+/// The number of decimal digits in a limb of `DecimalBigUint`
+inline constexpr std::size_t kDecimalLimbDigits = 19;
+
+/**
+ * @brief An arbitrary precision unsigned integer in radix 10^19
+ *
+ * Each limb holds 19 decimal digits (0 <= limb < 10^19), so the decimal representation is obtained by formatting limbs
+ * one by one. The layout follows `BigUint`: little-endian limbs without leading zeros.
+ */
+class DecimalBigUint : public std::vector<uint64_t> {
+  using Base = std::vector<uint64_t>;
+
+ public:
+  // <Constructors>
+  /// Construct from a uint64 value
+  constexpr explicit DecimalBigUint(uint64_t value) {
+    while (value > 0) {
+      push_back(value % kDecimalBase);
+      value /= kDecimalBase;
+    }
+  }
+  /// Construct from a vector of limbs. Each limb must be less than 10^19.
+  constexpr explicit DecimalBigUint(std::vector<uint64_t> values) : Base{std::move(values)} { TrimLeadingZeros(); }
+  /// Construct from a initializer list of limbs. Each limb must be less than 10^19.
+  constexpr explicit DecimalBigUint(std::initializer_list<uint64_t> values) : Base{values} { TrimLeadingZeros(); }
+
+  constexpr DecimalBigUint() = default;
+  constexpr DecimalBigUint(const DecimalBigUint&) = default;
+  constexpr DecimalBigUint(DecimalBigUint&&) noexcept = default;
+  constexpr DecimalBigUint& operator=(const DecimalBigUint&) = default;
+  constexpr DecimalBigUint& operator=(DecimalBigUint&&) noexcept = default;
+  constexpr ~DecimalBigUint() = default;
+  // </Constructors>
+
+  // <Basic Methods>
+  constexpr bool IsZero() const noexcept { return empty(); }
+
+  /// Count the number of decimal digits to represent *this. Zero has no digits.
+  constexpr uint64_t NumberOfDigits() const noexcept {
+    if (IsZero()) {
+      return 0;
+    }
+
+    uint64_t back_digits = 0;
+    for (uint64_t value = back(); value > 0; value /= 10) {
+      ++back_digits;
+    }
+    return (size() - 1) * kDecimalLimbDigits + back_digits;
+  }
+
+  constexpr DecimalBigUint Pow(uint64_t index) const {
+    DecimalBigUint ans{1};
+    DecimalBigUint curr_base = *this;
+    for (uint64_t curr_index_mask = 1; curr_index_mask <= index; curr_index_mask <<= 1) {
+      if (index & curr_index_mask) {
+        ans = ans * curr_base;
+      }
+      if ((curr_index_mask << 1) <= index) {
+        curr_base = curr_base * curr_base;
+      }
+    }
+
+    return ans;
+  }
+
+  /// Format the number in decimal. Unlike `ToString(const BigUint&)`, this is a linear pass over the limbs.
+  constexpr std::string ToString() const {
+    if (IsZero()) {
+      return std::string{"0"};
+    }
+
+    // The leading limb has no zero padding. `std::to_string` cannot be used in constant evaluation.
+    const auto back_digits = NumberOfDigits() - (size() - 1) * kDecimalLimbDigits;
+    auto ans = detail::MakePaddedString(back(), static_cast<int64_t>(back_digits));
+    ans.reserve(size() * kDecimalLimbDigits);
+    for (std::size_t i = 1; i < size(); ++i) {
+      ans += detail::MakePaddedString((*this)[size() - i - 1], kDecimalLimbDigits);
+    }
+    return ans;
+  }
+  // </Basic Methods>
+
+  // <Operators>
+  constexpr DecimalBigUint& operator+=(const DecimalBigUint& rhs) {
+    ShlAddAssign(rhs, 0);
+    return *this;
+  }
+
+  /// @pre *this >= rhs
+  constexpr DecimalBigUint& operator-=(const DecimalBigUint& rhs) {
+    if (*this < rhs) {
+      throw std::out_of_range("`*this - rhs` must not be negative");
+    }
+
+    bool borrow = false;
+    for (std::size_t i = 0; i < size() && (i < rhs.size() || borrow); ++i) {
+      const auto sub = (i < rhs.size() ? rhs[i] : 0) + static_cast<uint64_t>(borrow);
+      borrow = (*this)[i] < sub;
+      (*this)[i] = borrow ? (*this)[i] + (kDecimalBase - sub) : (*this)[i] - sub;
+    }
+
+    TrimLeadingZeros();
+    return *this;
+  }
+
+  friend constexpr DecimalBigUint operator+(const DecimalBigUint& lhs, const DecimalBigUint& rhs) {
+    DecimalBigUint tmp = lhs;
+    tmp += rhs;
+    return tmp;
+  }
+
+  friend constexpr DecimalBigUint operator-(const DecimalBigUint& lhs, const DecimalBigUint& rhs) {
+    DecimalBigUint tmp = lhs;
+    tmp -= rhs;
+    return tmp;
+  }
+
+  friend constexpr DecimalBigUint MultiplyNaive(const DecimalBigUint& lhs, const DecimalBigUint& rhs) {
+    std::vector<uint64_t> ans(lhs.size() + rhs.size());
+    for (std::size_t i = 0; i < lhs.size(); ++i) {
+      uint128_t carry = 0;
+      std::size_t k = i;
+      for (std::size_t j = 0; j < rhs.size(); ++j, ++k) {
+        // (10^19-1)^2 + 2 * (10^19-1) < 2^128
+        const auto value =
+            static_cast<uint128_t>(lhs[i]) * static_cast<uint128_t>(rhs[j]) + static_cast<uint128_t>(ans[k]) + carry;
+        ans[k] = static_cast<uint64_t>(value % kDecimalBase);
+        carry = value / kDecimalBase;
+      }
+
+      for (; carry > 0; ++k) {
+        const auto value = static_cast<uint128_t>(ans[k]) + carry;
+        ans[k] = static_cast<uint64_t>(value % kDecimalBase);
+        carry = value / kDecimalBase;
+      }
+    }
+
+    return DecimalBigUint(std::move(ans));
+  }
+
+  friend constexpr DecimalBigUint MultiplyKaratsuba(const DecimalBigUint& lhs, const DecimalBigUint& rhs) {
+    const auto max_len = std::max(lhs.size(), rhs.size());
+    const auto min_len = std::min(lhs.size(), rhs.size());
+
+    if (min_len <= kKaratsubaThreshold) {
+      return MultiplyNaive(lhs, rhs);
+    }
+
+    const auto shift = (max_len + 1) / 2;
+    const auto [lhs_high, lhs_low] = lhs.Split(shift);
+    const auto [rhs_high, rhs_low] = rhs.Split(shift);
+
+    const auto k1 = MultiplyKaratsuba(lhs_low, rhs_low);
+    const auto k2 = MultiplyKaratsuba(lhs_high, rhs_high);
+    const auto k3 = MultiplyKaratsuba(lhs_high + lhs_low, rhs_high + rhs_low);
+
+    DecimalBigUint result = k1;
+    result.ShlAddAssign(k2, 2 * shift);
+    result.ShlAddAssign(k3 - k1 - k2, shift);
+    return result;
+  }
+
+  /**
+   * @brief Multiply two numbers through a binary number-theoretic transform (SSA)
+   *
+   * The limbs are packed into a binary integer at a fixed stride (Kronecker substitution), so that one binary product
+   * holds all the coefficients of the polynomial product. The coefficients are then carried in radix 10^19.
+   */
+  friend constexpr DecimalBigUint MultiplyNTT(const DecimalBigUint& lhs, const DecimalBigUint& rhs) {
+    if (lhs.IsZero() || rhs.IsZero()) {
+      return DecimalBigUint{};
+    }
+
+    // Each coefficient is less than min_len * 10^38 < 2^(127 + bit_width(min_len))
+    const auto min_len = std::min(lhs.size(), rhs.size());
+    const auto stride = 128 + static_cast<std::size_t>(std::bit_width(min_len));
+
+    const auto product = Multiply(lhs.Pack(stride), rhs.Pack(stride));
+
+    const auto len = lhs.size() + rhs.size();
+    std::vector<uint64_t> ans(len);
+    std::array<uint64_t, 3> carry{};
+    for (std::size_t i = 0; i < len; ++i) {
+      auto value = ExtractBits(product, i * stride, stride);
+      AddWords(value, carry);
+      ans[i] = DivModBase(value);
+      carry = value;
+    }
+
+    return DecimalBigUint(std::move(ans));
+  }
+
+  friend constexpr DecimalBigUint operator*(const DecimalBigUint& lhs, const DecimalBigUint& rhs) {
+    const auto min_len = std::min(lhs.size(), rhs.size());
+    if (min_len <= kKaratsubaThreshold) {
+      return MultiplyNaive(lhs, rhs);
+    } else if (min_len < kNTTThreshold) {
+      return MultiplyKaratsuba(lhs, rhs);
+    } else {
+      return MultiplyNTT(lhs, rhs);
+    }
+  }
+
+  friend constexpr std::strong_ordering operator<=>(const DecimalBigUint& lhs, const DecimalBigUint& rhs) noexcept {
+    return detail::Compare(lhs, rhs);
+  }
+
+  friend constexpr bool operator==(const DecimalBigUint& lhs, const DecimalBigUint& rhs) noexcept = default;
+  // </Operators>
+
+  // <Minor Methods>
+  /// *this += rhs * 10^(19 * shift)
+  constexpr DecimalBigUint& ShlAddAssign(const DecimalBigUint& rhs, std::size_t shift) {
+    if (size() < rhs.size() + shift) {
+      resize(rhs.size() + shift);
+    }
+
+    uint64_t carry = 0;
+    for (std::size_t i = shift; i < size() && (i - shift < rhs.size() || carry > 0); ++i) {
+      // 2 * 10^19 > 2^64, so compare against the complement instead of adding first
+      const auto add = (i - shift < rhs.size() ? rhs[i - shift] : 0) + carry;
+      carry = (*this)[i] >= kDecimalBase - add;
+      (*this)[i] = carry ? (*this)[i] - (kDecimalBase - add) : (*this)[i] + add;
+    }
+
+    if (carry > 0) {
+      push_back(carry);
+    }
+    return *this;
+  }
+
+  /// Split into (*this / 10^(19 * shift), *this % 10^(19 * shift))
+  constexpr std::pair<DecimalBigUint, DecimalBigUint> Split(std::size_t shift) const {
+    if (shift >= size()) {
+      return {DecimalBigUint{}, *this};
+    }
+
+    return {DecimalBigUint(std::vector<uint64_t>(begin() + shift, end())),
+            DecimalBigUint(std::vector<uint64_t>(begin(), begin() + shift))};
+  }
+  // </Minor Methods>
+
+ private:
+  static constexpr std::size_t kKaratsubaThreshold = 32;
+  static constexpr std::size_t kNTTThreshold = 512;
+
+  constexpr DecimalBigUint& TrimLeadingZeros() noexcept {
+    detail::TrimLeadingZeros(*this);
+    return *this;
+  }
+
+  /// Place the limbs at every `stride` bits of a binary integer
+  constexpr BigUint Pack(std::size_t stride) const {
+    std::vector<uint64_t> ans(DivCeil(size() * stride, 64) + 1);
+    for (std::size_t i = 0; i < size(); ++i) {
+      const auto bit = i * stride;
+      const auto word_idx = bit / 64;
+      const auto bit_idx = bit % 64;
+      ans[word_idx] |= (*this)[i] << bit_idx;
+      if (bit_idx > 0) {
+        ans[word_idx + 1] |= (*this)[i] >> (64 - bit_idx);
+      }
+    }
+    return BigUint(std::move(ans));
+  }
+
+  /// Read `width` (<= 192) bits from `bit` of `num`
+  static constexpr std::array<uint64_t, 3> ExtractBits(const BigUint& num, std::size_t bit, std::size_t width) {
+    const auto word_idx = bit / 64;
+    const auto bit_idx = bit % 64;
+    auto word = [&](std::size_t i) -> uint64_t { return i < num.size() ? num[i] : 0; };
+
+    std::array<uint64_t, 3> ans{};
+    for (std::size_t i = 0; i < ans.size(); ++i) {
+      ans[i] = word(word_idx + i) >> bit_idx;
+      if (bit_idx > 0) {
+        ans[i] |= word(word_idx + i + 1) << (64 - bit_idx);
+      }
+
+      const auto low = 64 * i;
+      if (width <= low) {
+        ans[i] = 0;
+      } else if (width < low + 64) {
+        ans[i] &= (uint64_t{1} << (width - low)) - 1;
+      }
+    }
+    return ans;
+  }
+
+  static constexpr void AddWords(std::array<uint64_t, 3>& lhs, const std::array<uint64_t, 3>& rhs) noexcept {
+    uint128_t carry = 0;
+    for (std::size_t i = 0; i < lhs.size(); ++i) {
+      const auto sum = static_cast<uint128_t>(lhs[i]) + static_cast<uint128_t>(rhs[i]) + carry;
+      lhs[i] = static_cast<uint64_t>(sum);
+      carry = sum >> 64;
+    }
+  }
+
+  /// value /= 10^19 and return the remainder
+  static constexpr uint64_t DivModBase(std::array<uint64_t, 3>& value) noexcept {
+    uint128_t rem = 0;
+    for (std::size_t i = 0; i < value.size(); ++i) {
+      const auto j = value.size() - i - 1;
+      const auto curr = (rem << 64) | value[j];
+      value[j] = static_cast<uint64_t>(curr / kDecimalBase);
+      rem = curr % kDecimalBase;
+    }
+    return static_cast<uint64_t>(rem);
+  }
+};
+
+namespace detail {
+/// The number of limbs up to which radix conversions are done by the quadratic method
+inline constexpr std::size_t kRadixConversionThreshold = 32;
+
+/**
+ * @brief Compute `table[i] = base^(2^i)` for all i with 2^i < len
+ */
+template <typename T>
+constexpr std::vector<T> MakeSquareTable(T base, std::size_t len) {
+  std::vector<T> table;
+  table.push_back(std::move(base));
+  for (std::size_t half = 1; 2 * half < len; half *= 2) {
+    const auto& last = table.back();
+    table.push_back(last * last);
+  }
+  return table;
+}
+
+constexpr inline DecimalBigUint ToDecimalNaive(BigUint num) {
+  std::vector<uint64_t> ans;
+  while (!num.IsZero()) {
+    // Divide `num` by 10^19 from the most significant limb
+    uint128_t rem = 0;
+    for (std::size_t i = 0; i < num.size(); ++i) {
+      const auto j = num.size() - i - 1;
+      const auto curr = (rem << 64) | num[j];
+      num[j] = static_cast<uint64_t>(curr / kDecimalBase);
+      rem = curr % kDecimalBase;
+    }
+    TrimLeadingZeros(num);
+    ans.push_back(static_cast<uint64_t>(rem));
+  }
+  return DecimalBigUint(std::move(ans));
+}
+
+/// `pow2_table[i]` is 2^(64 * 2^i) in decimal
+constexpr inline DecimalBigUint ToDecimal(const BigUint& num, const std::vector<DecimalBigUint>& pow2_table) {
+  if (num.size() <= kRadixConversionThreshold) {
+    return ToDecimalNaive(num);
+  }
+
+  std::size_t level = 0;
+  while ((std::size_t{2} << level) < num.size()) {
+    ++level;
+  }
+  const auto shift = std::size_t{1} << level;
+
+  auto high = ToDecimal(num >> (64 * shift), pow2_table);
+  auto low = ToDecimal(num.ShiftMod2Pow(0, 64 * shift), pow2_table);
+  auto ans = high * pow2_table[level];
+  ans += low;
+  return ans;
+}
+
+/// `pow10_table[i]` is 10^(19 * 2^i) in binary
+constexpr inline BigUint ToBinary(const DecimalBigUint& num, const std::vector<BigUint>& pow10_table) {
+  if (num.size() <= 1) {
+    return num.IsZero() ? BigUint{} : BigUint{num[0]};
+  }
+
+  std::size_t level = 0;
+  while ((std::size_t{2} << level) < num.size()) {
+    ++level;
+  }
+  const auto [high, low] = num.Split(std::size_t{1} << level);
+
+  auto ans = Multiply(ToBinary(high, pow10_table), pow10_table[level]);
+  ans += ToBinary(low, pow10_table);
+  return ans;
+}
+}  // namespace detail
+
+/**
+ * @brief Convert a binary integer to radix 10^19
+ *
+ * The number is split in halves recursively, and the upper half is scaled by a power of 2^64 computed in radix 10^19.
+ * The powers are squared from 2^64, so no division by large numbers is needed.
+ */
+constexpr inline DecimalBigUint ToDecimal(const BigUint& num) {
+  // 2^64 = 1'8446744073709551616
+  const auto pow2_table = detail::MakeSquareTable(DecimalBigUint{8'446'744'073'709'551'616ULL, 1}, num.size());
+  return detail::ToDecimal(num, pow2_table);
+}
+
+/// Convert an integer in radix 10^19 to binary
+constexpr inline BigUint ToBinary(const DecimalBigUint& num) {
+  const auto pow10_table = detail::MakeSquareTable(BigUint{kDecimalBase}, num.size());
+  return detail::ToBinary(num, pow10_table);
+}
+
+namespace detail {
+/**
+ * @brief Format `frac / 2^frac_bits` (< 1) in decimal exactly
+ * @param frac The numerator of the fraction
+ * @param frac_bits The number of fractional bits
+ * @param digit_len The number of digits to be returned
+ *
+ * The digits are written by `ScaledRemainderTree::ConvertFraction()`, which works at the precision of each half of the
+ * digits instead of forming frac * 5^frac_bits, and converts the halves in parallel at run time.
+ */
+constexpr inline std::string FractionToDecimalString(const BigUint& frac, uint64_t frac_bits, uint64_t digit_len) {
+  std::string ans(digit_len, '0');
+  PowerTable local;
+  ScaledRemainderTree tree{SelectPowerTable(local), ConversionThreadPool(digit_len)};
+  tree.ConvertFraction(frac, frac_bits, digit_len, ans, 0);
+  return ans;
+}
+}  // namespace detail
+
+/**
+ * @brief Convert a number to a decimal string by exact radix conversion
+ * @param num The number to be converted
+ * @return The same format as `ToString(const BigFloat&)`
+ */
+constexpr inline std::string ToDecimalString(const BigFloat& num) {
+  constexpr double log2_10 = 3.321928094887362;
+
+  auto integer_part_str = ToString(num.IntegerPart());
+  const auto fractional_part = num.FractionalPart();
+  const auto frac_precision = static_cast<uint64_t>(fractional_part.GetFractionalPartPrecision());
+  const auto digit_len = static_cast<uint64_t>(static_cast<double>(frac_precision) / log2_10);
+  if (digit_len == 0) {
+    return std::move(integer_part_str) + ".";
+  }
+
+  const auto scaled = (fractional_part << static_cast<int64_t>(frac_precision)).IntegerPart().Abs();
+  return std::move(integer_part_str) + "." + detail::FractionToDecimalString(scaled, frac_precision, digit_len);
+}
+}  // namespace komori
+
+#endif  // KOMORI_DECIMAL_HPP_
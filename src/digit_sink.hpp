@@ -0,0 +1,142 @@
+#ifndef KOMORI_DIGIT_SINK_HPP_
+#define KOMORI_DIGIT_SINK_HPP_
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace komori {
+/// An error in writing digits to a sink
+class DigitSinkError : public std::runtime_error {
+ public:
+  using std::runtime_error::runtime_error;
+};
+
+/**
+ * @brief A destination of the digits of a conversion
+ *
+ * `Write()` is called with consecutive pieces of the output in order, so a sink never needs to hold the whole output.
+ */
+template <typename T>
+concept DigitSink = requires(T& sink, std::string_view digits) { sink.Write(digits); };
+
+/// A sink that writes to a `std::ostream`
+class OstreamDigitSink {
+ public:
+  explicit OstreamDigitSink(std::ostream& os) : os_{os} {}
+
+  void Write(std::string_view digits) {
+    os_.write(digits.data(), static_cast<std::streamsize>(digits.size()));
+    if (!os_) {
+      throw DigitSinkError("Failed to write digits to a stream");
+    }
+  }
+
+ private:
+  std::ostream& os_;
+};
+
+/// A sink that writes to a file descriptor. The descriptor is not closed by the sink.
+class FdDigitSink {
+ public:
+  explicit FdDigitSink(int fd) : fd_{fd} {}
+
+  void Write(std::string_view digits) {
+    while (!digits.empty()) {
+      const auto written = ::write(fd_, digits.data(), digits.size());
+      if (written < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        throw DigitSinkError(std::string{"Failed to write digits: "} + std::strerror(errno));
+      }
+      digits.remove_prefix(static_cast<std::size_t>(written));
+    }
+  }
+
+ private:
+  int fd_;
+};
+
+/// A sink that passes each piece to `func`, e.g. to copy it into a buffer of the caller
+template <typename F>
+class CallbackDigitSink {
+ public:
+  explicit CallbackDigitSink(F func) : func_{std::move(func)} {}
+
+  void Write(std::string_view digits) { func_(digits); }
+
+ private:
+  F func_;
+};
+
+/// A sink that appends to a string. It holds the whole output, so it is meant for short outputs.
+class StringDigitSink {
+ public:
+  void Write(std::string_view digits) { str_ += digits; }
+
+  const std::string& Str() const noexcept { return str_; }
+
+ private:
+  std::string str_;
+};
+
+/// The default number of digits in a chunk of `ChunkedDigitSink`
+inline constexpr std::size_t kDigitChunkSize = std::size_t{1} << 20;
+
+/**
+ * @brief A sink that regroups the pieces into chunks of a fixed size for another sink
+ *
+ * Every chunk but the last has exactly `chunk_size` digits. The last one is written by `Flush()`, which must be called
+ * after the last piece. Full chunks of a long piece are passed through without a copy.
+ */
+template <DigitSink Sink>
+class ChunkedDigitSink {
+ public:
+  explicit ChunkedDigitSink(Sink& sink, std::size_t chunk_size = kDigitChunkSize)
+      : sink_{sink}, chunk_size_{std::max<std::size_t>(chunk_size, 1)} {}
+
+  void Write(std::string_view digits) {
+    while (!digits.empty()) {
+      if (buffer_.empty() && digits.size() >= chunk_size_) {
+        sink_.Write(digits.substr(0, chunk_size_));
+        digits.remove_prefix(chunk_size_);
+        continue;
+      }
+
+      const auto len = std::min(digits.size(), chunk_size_ - buffer_.size());
+      buffer_.append(digits.substr(0, len));
+      digits.remove_prefix(len);
+      if (buffer_.size() == chunk_size_) {
+        sink_.Write(buffer_);
+        buffer_.clear();
+      }
+    }
+  }
+
+  /// Write the last partial chunk, if any
+  void Flush() {
+    if (!buffer_.empty()) {
+      sink_.Write(buffer_);
+      buffer_.clear();
+    }
+  }
+
+  std::size_t ChunkSize() const noexcept { return chunk_size_; }
+
+ private:
+  Sink& sink_;
+  std::size_t chunk_size_;
+  std::string buffer_;
+};
+}  // namespace komori
+
+#endif  // KOMORI_DIGIT_SINK_HPP_
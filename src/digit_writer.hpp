@@ -0,0 +1,522 @@
+#ifndef KOMORI_DIGIT_WRITER_HPP_
+#define KOMORI_DIGIT_WRITER_HPP_
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#endif
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <new>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "digit_sink.hpp"
+#include "thread_pool.hpp"
+
+#if __has_include(<linux/io_uring.h>) && defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define KOMORI_HAS_IO_URING 1
+#else
+#define KOMORI_HAS_IO_URING 0
+#endif
+
+namespace komori {
+/// The options of `DigitFileWriter`
+struct DigitWriterOptions {
+  /// The size of each of the two buffers. It is rounded up to a multiple of `detail::kDirectIoAlignment`, and at most
+  /// `detail::kMaxDigitBufferSize`.
+  std::size_t buffer_size{std::size_t{8} << 20};
+  /// Write with io_uring if the kernel allows it
+  bool use_io_uring{true};
+  /// Bypass the page cache with O_DIRECT if the file system supports it
+  bool use_direct_io{true};
+};
+
+/// The statistics of `DigitFileWriter`
+struct DigitWriterStats {
+  /// The number of bytes of the file
+  uint64_t bytes{0};
+  /// The number of write requests of full or final buffers
+  uint64_t writes{0};
+  /// The time in which the producer waited for a buffer to be written
+  double wait_seconds{0};
+  /// The time from the open to the close of the file
+  double total_seconds{0};
+  /// Whether the buffers were written with io_uring instead of `pwrite()`
+  bool io_uring{false};
+  /// Whether the file was written with O_DIRECT
+  bool direct_io{false};
+
+  double BytesPerSecond() const noexcept { return total_seconds > 0 ? static_cast<double>(bytes) / total_seconds : 0; }
+
+  std::string DebugString() const {
+    std::string s;
+    s += "bytes=" + std::to_string(bytes);
+    s += " writes=" + std::to_string(writes);
+    s += " wait_seconds=" + std::to_string(wait_seconds);
+    s += " total_seconds=" + std::to_string(total_seconds);
+    s += " bytes_per_second=" + std::to_string(BytesPerSecond());
+    s += " io_uring=" + std::string{io_uring ? "true" : "false"};
+    s += " direct_io=" + std::string{direct_io ? "true" : "false"};
+    return s;
+  }
+};
+
+namespace detail {
+/// The alignment of the buffers, offsets and lengths of O_DIRECT writes
+inline constexpr std::size_t kDirectIoAlignment = 4096;
+/// The maximum size of a buffer of `DigitFileWriter`, whose length must fit in a write request of io_uring
+inline constexpr std::size_t kMaxDigitBufferSize = std::size_t{1} << 30;
+
+struct AlignedFree {
+  void operator()(char* ptr) const noexcept { std::free(ptr); }
+};
+
+/// A buffer of `size` bytes aligned for O_DIRECT. `size` must be a multiple of `kDirectIoAlignment`.
+inline std::unique_ptr<char, AlignedFree> MakeAlignedBuffer(std::size_t size) {
+  auto* ptr = static_cast<char*>(std::aligned_alloc(kDirectIoAlignment, size));
+  if (ptr == nullptr) {
+    throw std::bad_alloc();
+  }
+  return std::unique_ptr<char, AlignedFree>(ptr);
+}
+
+/**
+ * @brief Write `data[0...len)` to `fd` at `offset` by `pwrite()`
+ *
+ * Some file systems accept O_DIRECT in `open()` and reject it in writes, so on EINVAL the flag is cleared and the
+ * write is retried through the page cache.
+ */
+inline void WriteAllAt(int fd, const char* data, std::size_t len, uint64_t offset) {
+  while (len > 0) {
+    const auto written = ::pwrite(fd, data, len, static_cast<off_t>(offset));
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      const int flags = ::fcntl(fd, F_GETFL);
+      if (errno == EINVAL && flags >= 0 && (flags & O_DIRECT) != 0 && ::fcntl(fd, F_SETFL, flags & ~O_DIRECT) == 0) {
+        continue;
+      }
+      throw DigitSinkError(std::string{"Failed to write digits: "} + std::strerror(errno));
+    }
+    data += written;
+    len -= static_cast<std::size_t>(written);
+    offset += static_cast<uint64_t>(written);
+  }
+}
+
+#if KOMORI_HAS_IO_URING
+/**
+ * @brief A minimal io_uring with raw system calls, which submits writes and waits for their completions
+ *
+ * The rings are shared with the kernel, so the heads and tails are accessed atomically: the tail of the submission
+ * ring is published with release after the entry is filled, and the tail of the completion ring is read with acquire.
+ */
+class IoUring {
+ public:
+  /// Set up a ring of `entries` entries. `Valid()` is false if the kernel does not allow io_uring.
+  explicit IoUring(unsigned entries) {
+    io_uring_params params{};
+    const auto fd = ::syscall(__NR_io_uring_setup, entries, &params);
+    if (fd < 0) {
+      return;
+    }
+    fd_ = static_cast<int>(fd);
+
+    sq_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap) {
+      sq_size_ = cq_size_ = std::max(sq_size_, cq_size_);
+    }
+    sq_ptr_ = ::mmap(nullptr, sq_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQ_RING);
+    cq_ptr_ = single_mmap ? sq_ptr_
+                          : ::mmap(nullptr, cq_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_,
+                                   IORING_OFF_CQ_RING);
+    sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqes = ::mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQES);
+    if (sq_ptr_ == MAP_FAILED || cq_ptr_ == MAP_FAILED || sqes == MAP_FAILED) {
+      if (sqes != MAP_FAILED) {
+        ::munmap(sqes, sqes_size_);
+      }
+      Close();
+      return;
+    }
+
+    auto* sq = static_cast<char*>(sq_ptr_);
+    sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sq_mask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+    auto* cq = static_cast<char*>(cq_ptr_);
+    cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cq_mask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+  }
+
+  IoUring(const IoUring&) = delete;
+  IoUring(IoUring&&) = delete;
+  IoUring& operator=(const IoUring&) = delete;
+  IoUring& operator=(IoUring&&) = delete;
+  ~IoUring() { Close(); }
+
+  bool Valid() const noexcept { return sqes_ != nullptr; }
+
+  /// Submit a write of `data[0...len)` to `fd` at `offset`. It returns false if the submission is rejected.
+  bool SubmitWrite(int fd, const char* data, unsigned len, uint64_t offset, uint64_t user_data) {
+    const auto tail = std::atomic_ref(*sq_tail_).load(std::memory_order_relaxed);
+    const auto index = tail & sq_mask_;
+    auto& sqe = sqes_[index];
+    std::memset(&sqe, 0, sizeof(sqe));
+    sqe.opcode = IORING_OP_WRITE;
+    sqe.fd = fd;
+    sqe.addr = reinterpret_cast<uint64_t>(data);
+    sqe.len = len;
+    sqe.off = offset;
+    sqe.user_data = user_data;
+    sq_array_[index] = index;
+    std::atomic_ref(*sq_tail_).store(tail + 1, std::memory_order_release);
+
+    for (;;) {
+      const auto submitted = ::syscall(__NR_io_uring_enter, fd_, 1, 0, 0, nullptr, 0);
+      if (submitted >= 0 || errno != EINTR) {
+        return submitted == 1;
+      }
+    }
+  }
+
+  /// Wait for a completion and return its user data and result, which is the number of bytes or minus errno
+  std::pair<uint64_t, int32_t> WaitCompletion() {
+    for (;;) {
+      const auto head = std::atomic_ref(*cq_head_).load(std::memory_order_relaxed);
+      if (head != std::atomic_ref(*cq_tail_).load(std::memory_order_acquire)) {
+        const auto& cqe = cqes_[head & cq_mask_];
+        const std::pair<uint64_t, int32_t> ans{cqe.user_data, cqe.res};
+        std::atomic_ref(*cq_head_).store(head + 1, std::memory_order_release);
+        return ans;
+      }
+
+      const auto ret = ::syscall(__NR_io_uring_enter, fd_, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+      if (ret < 0 && errno != EINTR) {
+        throw DigitSinkError(std::string{"Failed to wait for io_uring: "} + std::strerror(errno));
+      }
+    }
+  }
+
+ private:
+  void Close() noexcept {
+    if (sqes_ != nullptr) {
+      ::munmap(sqes_, sqes_size_);
+      sqes_ = nullptr;
+    }
+    if (cq_ptr_ != nullptr && cq_ptr_ != MAP_FAILED && cq_ptr_ != sq_ptr_) {
+      ::munmap(cq_ptr_, cq_size_);
+    }
+    if (sq_ptr_ != nullptr && sq_ptr_ != MAP_FAILED) {
+      ::munmap(sq_ptr_, sq_size_);
+    }
+    sq_ptr_ = cq_ptr_ = nullptr;
+    if (fd_ >= 0) {
+      ::close(fd_);
+      fd_ = -1;
+    }
+  }
+
+  int fd_{-1};
+  void* sq_ptr_{nullptr};
+  void* cq_ptr_{nullptr};
+  std::size_t sq_size_{0};
+  std::size_t cq_size_{0};
+  std::size_t sqes_size_{0};
+
+  unsigned* sq_tail_{nullptr};
+  unsigned sq_mask_{0};
+  unsigned* sq_array_{nullptr};
+  io_uring_sqe* sqes_{nullptr};
+
+  unsigned* cq_head_{nullptr};
+  unsigned* cq_tail_{nullptr};
+  unsigned cq_mask_{0};
+  io_uring_cqe* cqes_{nullptr};
+};
+#endif
+}  // namespace detail
+
+/**
+ * @brief A sink that writes digits to a file with two buffers, so that the conversion and the disk I/O overlap
+ *
+ * The digits are copied into one of two aligned buffers. A full buffer is submitted to io_uring, or to a worker
+ * thread that calls `pwrite()` if io_uring is not available, and the producer continues with the other buffer. It
+ * waits only if the other buffer is still being written, and the time is recorded in `Stats()`.
+ *
+ * With O_DIRECT, the last buffer is padded to the alignment and the file is truncated to its length in `Close()`,
+ * which must be called to complete the file. The destructor closes the file but ignores the errors. If a write fails,
+ * the writes in flight are waited for and the file is closed before the error is thrown.
+ */
+class DigitFileWriter {
+ public:
+  explicit DigitFileWriter(const std::filesystem::path& path, const DigitWriterOptions& options = {})
+      : start_{std::chrono::steady_clock::now()},
+        buffer_size_{std::clamp<std::size_t>(
+            (std::min(options.buffer_size, detail::kMaxDigitBufferSize) + detail::kDirectIoAlignment - 1) /
+                detail::kDirectIoAlignment * detail::kDirectIoAlignment,
+            detail::kDirectIoAlignment,
+            detail::kMaxDigitBufferSize)} {
+    // The file is opened last, so that nothing can throw after `fd_` is set
+    for (auto& slot : slots_) {
+      slot.buffer = detail::MakeAlignedBuffer(buffer_size_);
+    }
+#if KOMORI_HAS_IO_URING
+    if (options.use_io_uring) {
+      ring_.emplace(static_cast<unsigned>(kNumBuffers));
+      if (!ring_->Valid()) {
+        ring_.reset();
+      }
+    }
+    stats_.io_uring = ring_.has_value();
+#endif
+
+    constexpr int kFlags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+    if (options.use_direct_io) {
+      fd_ = ::open(path.c_str(), kFlags | O_DIRECT, 0644);
+      stats_.direct_io = fd_ >= 0;
+    }
+    if (fd_ < 0) {
+      fd_ = ::open(path.c_str(), kFlags, 0644);
+    }
+    if (fd_ < 0) {
+      throw DigitSinkError("Failed to open " + path.string() + ": " + std::strerror(errno));
+    }
+  }
+
+  DigitFileWriter(const DigitFileWriter&) = delete;
+  DigitFileWriter(DigitFileWriter&&) = delete;
+  DigitFileWriter& operator=(const DigitFileWriter&) = delete;
+  DigitFileWriter& operator=(DigitFileWriter&&) = delete;
+
+  ~DigitFileWriter() {
+    try {
+      Close();
+    } catch (...) {
+    }
+  }
+
+  void Write(std::string_view digits) {
+    if (fd_ < 0) {
+      throw DigitSinkError("The digit file is closed");
+    }
+
+    try {
+      while (!digits.empty()) {
+        const auto len = std::min(digits.size(), buffer_size_ - filled_);
+        std::memcpy(slots_[current_].buffer.get() + filled_, digits.data(), len);
+        filled_ += len;
+        digits.remove_prefix(len);
+        if (filled_ == buffer_size_) {
+          SubmitCurrent(buffer_size_);
+        }
+      }
+    } catch (...) {
+      Abort();
+      throw;
+    }
+  }
+
+  /// Write the last buffer, wait for all writes and close the file
+  void Close() {
+    if (fd_ < 0) {
+      return;
+    }
+
+    try {
+      Finish();
+    } catch (...) {
+      Abort();
+      throw;
+    }
+  }
+
+  /// The statistics, which are complete after `Close()`
+  const DigitWriterStats& Stats() const noexcept { return stats_; }
+
+ private:
+  static constexpr std::size_t kNumBuffers = 2;
+
+  /// A buffer and its write in flight
+  struct Slot {
+    std::unique_ptr<char, detail::AlignedFree> buffer;
+    uint64_t offset{0};
+    std::size_t len{0};
+    bool in_flight{false};
+    std::optional<Task<void>> task;
+  };
+
+  /// The body of `Close()`
+  void Finish() {
+    const auto length = offset_ + filled_;
+    if (filled_ > 0) {
+      const auto padded = stats_.direct_io ? (filled_ + detail::kDirectIoAlignment - 1) / detail::kDirectIoAlignment *
+                                                 detail::kDirectIoAlignment
+                                           : filled_;
+      std::memset(slots_[current_].buffer.get() + filled_, 0, padded - filled_);
+      SubmitCurrent(padded);
+    }
+    for (std::size_t i = 0; i < kNumBuffers; ++i) {
+      Wait(i);
+    }
+    if (offset_ != length && ::ftruncate(fd_, static_cast<off_t>(length)) != 0) {
+      throw DigitSinkError(std::string{"Failed to truncate the digit file: "} + std::strerror(errno));
+    }
+
+    // O_DIRECT may have been cleared by `detail::WriteAllAt()`
+    const int flags = ::fcntl(fd_, F_GETFL);
+    stats_.direct_io = flags >= 0 && (flags & O_DIRECT) != 0;
+    ::close(fd_);
+    fd_ = -1;
+    stats_.bytes = length;
+    stats_.total_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+  }
+
+  /**
+   * @brief Wait for every write in flight ignoring the errors, and close the file
+   *
+   * If the completions of io_uring cannot be reaped, the kernel may still read the buffers, so they are leaked rather
+   * than freed.
+   */
+  void Abort() noexcept {
+    for (auto& slot : slots_) {
+#if KOMORI_HAS_IO_URING
+      while (ring_ && slot.in_flight) {
+        try {
+          const auto [user_data, res] = ring_->WaitCompletion();
+          slots_[user_data].in_flight = false;
+        } catch (...) {
+          for (auto& other : slots_) {
+            if (other.in_flight) {
+              static_cast<void>(other.buffer.release());
+              other.in_flight = false;
+            }
+          }
+        }
+      }
+#endif
+      // The destructor of the task waits for the write and ignores its error
+      slot.task.reset();
+      slot.in_flight = false;
+    }
+
+#if KOMORI_HAS_IO_URING
+    ring_.reset();
+#endif
+    filled_ = 0;
+    if (fd_ >= 0) {
+      ::close(fd_);
+      fd_ = -1;
+    }
+  }
+
+  /// Start writing `len` bytes of the current buffer and switch to the other buffer
+  void SubmitCurrent(std::size_t len) {
+    auto& slot = slots_[current_];
+    slot.offset = offset_;
+    slot.len = len;
+    slot.in_flight = true;
+    ++stats_.writes;
+
+#if KOMORI_HAS_IO_URING
+    if (ring_) {
+      if (!ring_->SubmitWrite(fd_, slot.buffer.get(), static_cast<unsigned>(len), offset_, current_)) {
+        // The ring is dropped after the other write, so that the rejected entry is never submitted later
+        slot.in_flight = false;
+        Wait((current_ + 1) % kNumBuffers);
+        ring_.reset();
+        detail::WriteAllAt(fd_, slot.buffer.get(), len, offset_);
+      }
+    } else
+#endif
+    {
+      if (!io_pool_) {
+        io_pool_.emplace(2);
+      }
+      slot.task.emplace(io_pool_->Submit([fd = fd_, data = slot.buffer.get(), len, offset = offset_] {
+        detail::WriteAllAt(fd, data, len, offset);
+      }));
+    }
+
+    offset_ += len;
+    filled_ = 0;
+    current_ = (current_ + 1) % kNumBuffers;
+    Wait(current_);
+  }
+
+  /// Wait until the write of `slots_[index]` is finished
+  void Wait(std::size_t index) {
+    auto& slot = slots_[index];
+    if (!slot.in_flight) {
+      return;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+#if KOMORI_HAS_IO_URING
+    if (ring_) {
+      while (slot.in_flight) {
+        const auto [user_data, res] = ring_->WaitCompletion();
+        Complete(slots_[user_data], res);
+      }
+    }
+#endif
+    if (slot.task) {
+      auto task = std::move(*slot.task);
+      slot.task.reset();
+      slot.in_flight = false;
+      task.Get();
+    }
+    stats_.wait_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  }
+
+  /// Finish a write of io_uring. A short or failed write is completed by `pwrite()`.
+  void Complete(Slot& slot, int32_t res) {
+    slot.in_flight = false;
+    const auto done = res > 0 ? static_cast<std::size_t>(res) : 0;
+    if (done < slot.len) {
+      detail::WriteAllAt(fd_, slot.buffer.get() + done, slot.len - done, slot.offset + done);
+    }
+  }
+
+  std::chrono::steady_clock::time_point start_;
+  std::size_t buffer_size_;
+  int fd_{-1};
+  /// The pool for `pwrite()` without io_uring, whose only worker writes while the caller converts. It is created by
+  /// the first write without io_uring, and outlives the tasks in `slots_`.
+  std::optional<ThreadPool> io_pool_;
+  std::array<Slot, kNumBuffers> slots_;
+  std::size_t current_{0};
+  std::size_t filled_{0};
+  uint64_t offset_{0};
+  DigitWriterStats stats_;
+#if KOMORI_HAS_IO_URING
+  std::optional<detail::IoUring> ring_;
+#endif
+};
+}  // namespace komori
+
+#endif  // KOMORI_DIGIT_WRITER_HPP_
@@ -0,0 +1,460 @@
+#ifndef KOMORI_DISK_BIGUINT_HPP_
+#define KOMORI_DISK_BIGUINT_HPP_
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bigint.hpp"
+#include "biguint.hpp"
+#include "gf2n1.hpp"
+#include "ssa.hpp"
+
+namespace komori {
+/// An error in creating, resizing or mapping a scratch file
+class DiskError : public std::runtime_error {
+ public:
+  using std::runtime_error::runtime_error;
+};
+
+/**
+ * @brief A directory for the files of `DiskBigUint`
+ *
+ * Each file is unlinked as soon as it is created, so it is removed when its number is destroyed or the process exits,
+ * even by a crash.
+ */
+class ScratchDirectory {
+ public:
+  /// Open `directory`, creating it if it does not exist
+  explicit ScratchDirectory(std::filesystem::path directory) : directory_{std::move(directory)} {
+    std::filesystem::create_directories(directory_);
+  }
+
+  const std::filesystem::path& Directory() const noexcept { return directory_; }
+
+  /// Create an empty unlinked file and return its descriptor
+  int CreateFile() const {
+    const auto id = next_id_.fetch_add(1, std::memory_order_relaxed);
+    const auto path = directory_ / ("scratch_" + std::to_string(::getpid()) + "_" + std::to_string(id) + ".bin");
+    const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+    if (fd < 0) {
+      throw DiskError("Failed to create " + path.string() + ": " + std::strerror(errno));
+    }
+    ::unlink(path.c_str());
+    return fd;
+  }
+
+ private:
+  std::filesystem::path directory_;
+  static inline std::atomic<uint64_t> next_id_{0};
+};
+
+/**
+ * @brief A non-negative integer whose limbs are in a memory-mapped file of a `ScratchDirectory`
+ *
+ * The limbs are little endian like `BigUint`, but leading zero limbs are allowed, so `size()` is a capacity. The
+ * operating system pages the limbs in and out, so the integer may be larger than the memory as long as it is accessed
+ * in blocks. The scratch directory must outlive the integer.
+ */
+class DiskBigUint {
+ public:
+  /// Zero with `size` limbs of storage
+  DiskBigUint(const ScratchDirectory& scratch, std::size_t size) : scratch_{&scratch}, fd_{scratch.CreateFile()} {
+    Resize(size);
+  }
+
+  DiskBigUint(const ScratchDirectory& scratch, const BigUint& value) : DiskBigUint(scratch, value.size()) {
+    std::copy(value.begin(), value.end(), data_);
+  }
+
+  DiskBigUint(const DiskBigUint&) = delete;
+  DiskBigUint& operator=(const DiskBigUint&) = delete;
+
+  DiskBigUint(DiskBigUint&& rhs) noexcept
+      : scratch_{rhs.scratch_},
+        fd_{std::exchange(rhs.fd_, -1)},
+        data_{std::exchange(rhs.data_, nullptr)},
+        size_{std::exchange(rhs.size_, 0)} {}
+
+  DiskBigUint& operator=(DiskBigUint&& rhs) noexcept {
+    if (this != &rhs) {
+      Close();
+      scratch_ = rhs.scratch_;
+      fd_ = std::exchange(rhs.fd_, -1);
+      data_ = std::exchange(rhs.data_, nullptr);
+      size_ = std::exchange(rhs.size_, 0);
+    }
+    return *this;
+  }
+
+  ~DiskBigUint() { Close(); }
+
+  const ScratchDirectory& Scratch() const noexcept { return *scratch_; }
+
+  std::size_t size() const noexcept { return size_; }
+  uint64_t* data() noexcept { return data_; }
+  const uint64_t* data() const noexcept { return data_; }
+  uint64_t& operator[](std::size_t i) noexcept { return data_[i]; }
+  const uint64_t& operator[](std::size_t i) const noexcept { return data_[i]; }
+
+  uint64_t NumberOfBits() const noexcept {
+    for (auto i = size_; i > 0; --i) {
+      if (data_[i - 1] != 0) {
+        return 64 * (i - 1) + static_cast<uint64_t>(std::bit_width(data_[i - 1]));
+      }
+    }
+    return 0;
+  }
+
+  BigUint ToBigUint() const { return BigUint(std::vector<uint64_t>(data_, data_ + size_)); }
+
+  /// Change the storage to `size` limbs. The new limbs are zero.
+  void Resize(std::size_t size) {
+    Unmap();
+    if (::ftruncate(fd_, static_cast<off_t>(size * sizeof(uint64_t))) != 0) {
+      throw DiskError(std::string{"Failed to resize a scratch file: "} + std::strerror(errno));
+    }
+    if (size > 0) {
+      void* addr = ::mmap(nullptr, size * sizeof(uint64_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+      if (addr == MAP_FAILED) {
+        throw DiskError(std::string{"Failed to map a scratch file: "} + std::strerror(errno));
+      }
+      data_ = static_cast<uint64_t*>(addr);
+    }
+    size_ = size;
+  }
+
+  /// Drop the leading zero limbs
+  void ShrinkToFit() { Resize((NumberOfBits() + 63) / 64); }
+
+ private:
+  void Unmap() noexcept {
+    if (data_ != nullptr) {
+      ::munmap(data_, size_ * sizeof(uint64_t));
+      data_ = nullptr;
+    }
+  }
+
+  void Close() noexcept {
+    Unmap();
+    if (fd_ >= 0) {
+      ::close(fd_);
+      fd_ = -1;
+    }
+  }
+
+  const ScratchDirectory* scratch_;
+  int fd_;
+  uint64_t* data_{nullptr};
+  std::size_t size_{0};
+};
+
+/// A `BigInt` whose absolute value is a `DiskBigUint`
+struct DiskBigInt {
+  DiskBigInt(const ScratchDirectory& scratch, const BigInt& value)
+      : abs{scratch, value.Abs()}, sign{value.GetSign()} {}
+
+  BigInt ToBigInt() const { return BigInt(abs.ToBigUint(), sign); }
+
+  DiskBigUint abs;
+  Sign sign;
+};
+
+// <Out-of-core Arithmetic>
+// The operations read their operands and write their results in one pass from the lowest limb, so each page of the
+// files is touched once. The results are created in the scratch directory of the left operand.
+
+namespace detail {
+/// The minimum bit length of operands of `Multiply()` of `DiskBigUint` to run the transform out of core
+inline constexpr uint64_t kOutOfCoreSSAThresholdBits = uint64_t{1} << 24;
+
+using DiskElement = BasicGF2PowNPlus1<BigUint>;
+
+/// (limbs >> offset) % 2^count
+inline BigUint ExtractBits(std::span<const uint64_t> limbs, uint64_t offset, uint64_t count) {
+  std::vector<uint64_t> ans;
+  ShiftMod2Pow<uint128_t>(ans, limbs, offset, count);
+  return BigUint(std::move(ans));
+}
+
+/// ans += x << shift
+inline void ShlAddAssign(DiskBigUint& ans, const BigUint& x, uint64_t shift) {
+  const auto word_idx = shift / 64;
+  const auto bit_idx = shift % 64;
+
+  uint128_t carry = 0;
+  for (std::size_t i = 0; i < x.size() || carry > 0; ++i) {
+    if (word_idx + i >= ans.size()) {
+      throw std::out_of_range("The sum does not fit in the storage");
+    }
+
+    uint128_t sum = carry + ans[word_idx + i];
+    if (i < x.size()) {
+      sum += static_cast<uint128_t>(x[i]) << bit_idx;
+    }
+    ans[word_idx + i] = static_cast<uint64_t>(sum);
+    carry = sum >> 64;
+  }
+}
+
+/**
+ * @brief Transform `values` in place from natural order to natural order as `BasicSplittedInteger::NTT()` does
+ * @param root_shift The primitive root of unity of the length of `values` is 2^root_shift
+ */
+inline void NTTElements(std::vector<DiskElement>& values, uint64_t root_shift, uint64_t n) {
+  const uint64_t len = values.size();
+  for (uint64_t q = len / 2; q > 0; q /= 2) {
+    const auto p = len / q / 2;
+    for (uint64_t i = 0; i < q; ++i) {
+      const auto w = DiskElement::Make2Pow(i * p * root_shift, n);
+      for (uint64_t j = i; j < len; j += 2 * q) {
+        auto tmp = values[j] - values[j + q];
+        values[j] += values[j + q];
+        tmp *= w;
+        values[j + q] = std::move(tmp);
+      }
+    }
+  }
+
+  uint64_t i = 0;
+  for (uint64_t j = 1; j < len; ++j) {
+    auto l = len / 2;
+    i ^= l;
+    while (i < l) {
+      l /= 2;
+      i ^= l;
+    }
+    if (j < i) {
+      std::swap(values[i], values[j]);
+    }
+  }
+}
+
+/**
+ * @brief An integer split into 2^k elements of Z/(2^n+1)Z for SSA, stored in fixed-width slots of a `DiskBigUint`
+ *
+ * The transform of length N = R C is computed by the four-step method with w = 2^(2n/N): the length-C transforms of the
+ * R columns x[j1 + R j2] (0 <= j2 < C), the twiddle factors w^(j1 k2), and the length-R transforms of the C rows. Only
+ * one column or row of about sqrt(N) elements is in memory at a time.
+ *
+ * The transform is left transposed, i.e. X[C k1 + k2] is in the slot k1 + R k2. It is fine for pointwise products
+ * because `INTT()` undoes the steps in reverse order.
+ */
+class DiskSplittedInteger {
+ public:
+  DiskSplittedInteger(const DiskBigUint& num, uint64_t k)
+      : k_{k},
+        n_{Calc_n(k)},
+        m_{Calc_M(k)},
+        row_len_{uint64_t{1} << (k / 2)},
+        column_len_{uint64_t{1} << (k - k / 2)},
+        slot_limbs_{n_ / 64 + 1},
+        slots_{num.Scratch(), (uint64_t{1} << k) * slot_limbs_} {
+    const std::span<const uint64_t> limbs{num.data(), num.size()};
+    for (uint64_t i = 0; i < (uint64_t{1} << k_); ++i) {
+      Store(i, DiskElement{n_, ExtractBits(limbs, i * m_, m_)});
+    }
+  }
+
+  DiskBigUint Get() const {
+    const auto N = uint64_t{1} << k_;
+    DiskBigUint ans{slots_.Scratch(), ((N - 1) * m_ + n_ + 1) / 64 + 2};
+    for (uint64_t i = 0; i < N; ++i) {
+      ShlAddAssign(ans, Load(i).Get(), i * m_);
+    }
+    ans.ShrinkToFit();
+    return ans;
+  }
+
+  void NTT() {
+    const auto s = 2 * n_ >> k_;
+    for (uint64_t j1 = 0; j1 < row_len_; ++j1) {
+      auto column = LoadColumn(j1);
+      NTTElements(column, row_len_ * s, n_);
+      for (uint64_t k2 = 0; k2 < column_len_; ++k2) {
+        column[k2] *= DiskElement::Make2Pow(j1 * k2 * s, n_);
+      }
+      StoreColumn(j1, column);
+    }
+
+    for (uint64_t k2 = 0; k2 < column_len_; ++k2) {
+      auto row = LoadRow(k2);
+      NTTElements(row, column_len_ * s, n_);
+      StoreRow(k2, row);
+    }
+  }
+
+  void INTT() {
+    const auto s = 2 * n_ >> k_;
+    for (uint64_t k2 = 0; k2 < column_len_; ++k2) {
+      auto row = LoadRow(k2);
+      NTTElements(row, 2 * n_ - column_len_ * s, n_);
+      StoreRow(k2, row);
+    }
+
+    const auto scale = DiskElement::Make2Pow(2 * n_ - k_, n_);
+    for (uint64_t j1 = 0; j1 < row_len_; ++j1) {
+      auto column = LoadColumn(j1);
+      for (uint64_t k2 = 0; k2 < column_len_; ++k2) {
+        column[k2] *= DiskElement::Make2Pow(2 * n_ - (j1 * k2 * s) % (2 * n_), n_);
+      }
+      NTTElements(column, 2 * n_ - row_len_ * s, n_);
+      for (auto& x : column) {
+        x *= scale;
+      }
+      StoreColumn(j1, column);
+    }
+  }
+
+  DiskSplittedInteger& operator*=(const DiskSplittedInteger& rhs) {
+    for (uint64_t i = 0; i < (uint64_t{1} << k_); ++i) {
+      Store(i, Load(i) * rhs.Load(i));
+    }
+    return *this;
+  }
+
+ private:
+  DiskElement Load(uint64_t i) const {
+    const auto* slot = slots_.data() + i * slot_limbs_;
+    return DiskElement{n_, BigUint(std::vector<uint64_t>(slot, slot + slot_limbs_))};
+  }
+
+  void Store(uint64_t i, const DiskElement& x) {
+    auto* slot = slots_.data() + i * slot_limbs_;
+    const auto& value = x.Get();
+    std::copy(value.begin(), value.end(), slot);
+    std::fill(slot + value.size(), slot + slot_limbs_, 0);
+  }
+
+  std::vector<DiskElement> LoadRow(uint64_t k2) const {
+    std::vector<DiskElement> row;
+    row.reserve(row_len_);
+    for (uint64_t j1 = 0; j1 < row_len_; ++j1) {
+      row.push_back(Load(j1 + row_len_ * k2));
+    }
+    return row;
+  }
+
+  void StoreRow(uint64_t k2, const std::vector<DiskElement>& row) {
+    for (uint64_t j1 = 0; j1 < row_len_; ++j1) {
+      Store(j1 + row_len_ * k2, row[j1]);
+    }
+  }
+
+  std::vector<DiskElement> LoadColumn(uint64_t j1) const {
+    std::vector<DiskElement> column;
+    column.reserve(column_len_);
+    for (uint64_t j2 = 0; j2 < column_len_; ++j2) {
+      column.push_back(Load(j1 + row_len_ * j2));
+    }
+    return column;
+  }
+
+  void StoreColumn(uint64_t j1, const std::vector<DiskElement>& column) {
+    for (uint64_t j2 = 0; j2 < column_len_; ++j2) {
+      Store(j1 + row_len_ * j2, column[j2]);
+    }
+  }
+
+  uint64_t k_;
+  uint64_t n_;
+  uint64_t m_;
+  uint64_t row_len_;
+  uint64_t column_len_;
+  uint64_t slot_limbs_;
+  DiskBigUint slots_;
+};
+
+/// Multiply by SSA whose transforms, pointwise products and recombination run out of core
+inline DiskBigUint MultiplyOutOfCore(const DiskBigUint& lhs, const DiskBigUint& rhs) {
+  const auto k = Best_k(std::max(lhs.NumberOfBits(), rhs.NumberOfBits()));
+  DiskSplittedInteger l(lhs, k);
+  {
+    DiskSplittedInteger r(rhs, k);
+    l.NTT();
+    r.NTT();
+    l *= r;
+  }
+  l.INTT();
+  return l.Get();
+}
+}  // namespace detail
+
+inline DiskBigUint operator+(const DiskBigUint& lhs, const DiskBigUint& rhs) {
+  DiskBigUint ans{lhs.Scratch(), std::max(lhs.size(), rhs.size()) + 1};
+  uint128_t carry = 0;
+  for (std::size_t i = 0; i + 1 < ans.size(); ++i) {
+    const auto sum = carry + (i < lhs.size() ? lhs[i] : 0) + (i < rhs.size() ? rhs[i] : 0);
+    ans[i] = static_cast<uint64_t>(sum);
+    carry = sum >> 64;
+  }
+  ans[ans.size() - 1] = static_cast<uint64_t>(carry);
+  ans.ShrinkToFit();
+  return ans;
+}
+
+inline DiskBigUint operator<<(const DiskBigUint& lhs, uint64_t shift) {
+  const auto word_idx = shift / 64;
+  const auto bit_idx = shift % 64;
+
+  DiskBigUint ans{lhs.Scratch(), lhs.size() + word_idx + 1};
+  uint64_t carry = 0;
+  for (std::size_t i = 0; i < lhs.size(); ++i) {
+    ans[word_idx + i] = (lhs[i] << bit_idx) | carry;
+    carry = bit_idx > 0 ? lhs[i] >> (64 - bit_idx) : 0;
+  }
+  ans[ans.size() - 1] = carry;
+  ans.ShrinkToFit();
+  return ans;
+}
+
+inline DiskBigUint operator>>(const DiskBigUint& lhs, uint64_t shift) {
+  const auto word_idx = shift / 64;
+  const auto bit_idx = shift % 64;
+  if (word_idx >= lhs.size()) {
+    return DiskBigUint{lhs.Scratch(), 0};
+  }
+
+  DiskBigUint ans{lhs.Scratch(), lhs.size() - word_idx};
+  for (std::size_t i = 0; i < ans.size(); ++i) {
+    const auto upper = (bit_idx > 0 && word_idx + i + 1 < lhs.size()) ? lhs[word_idx + i + 1] << (64 - bit_idx) : 0;
+    ans[i] = (lhs[word_idx + i] >> bit_idx) | upper;
+  }
+  ans.ShrinkToFit();
+  return ans;
+}
+
+/**
+ * @brief Multiply integers on disk
+ *
+ * Operands shorter than `detail::kOutOfCoreSSAThresholdBits` are multiplied in memory. Otherwise only a column or a
+ * row of the transform is in memory at a time. See `detail::DiskSplittedInteger`.
+ */
+inline DiskBigUint Multiply(const DiskBigUint& lhs, const DiskBigUint& rhs) {
+  const auto bit_len = std::max(lhs.NumberOfBits(), rhs.NumberOfBits());
+  if (lhs.NumberOfBits() == 0 || rhs.NumberOfBits() == 0) {
+    return DiskBigUint{lhs.Scratch(), 0};
+  }
+  if (bit_len < detail::kOutOfCoreSSAThresholdBits) {
+    return DiskBigUint{lhs.Scratch(), Multiply(lhs.ToBigUint(), rhs.ToBigUint())};
+  }
+  return detail::MultiplyOutOfCore(lhs, rhs);
+}
+// </Out-of-core Arithmetic>
+}  // namespace komori
+
+#endif  // KOMORI_DISK_BIGUINT_HPP_
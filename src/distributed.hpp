@@ -0,0 +1,483 @@
+#ifndef KOMORI_DISTRIBUTED_HPP_
+#define KOMORI_DISTRIBUTED_HPP_
+
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <streambuf>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "bigint.hpp"
+#include "checkpoint.hpp"
+#include "hypergeometric.hpp"
+#include "serialize.hpp"
+#include "ssa.hpp"
+#include "thread_pool.hpp"
+
+namespace komori {
+/// An error in starting or talking to worker processes
+class DistributedError : public std::runtime_error {
+ public:
+  using std::runtime_error::runtime_error;
+};
+
+namespace detail {
+#ifdef MSG_NOSIGNAL
+/// A closed peer makes `send()` fail instead of raising SIGPIPE
+inline constexpr int kSendFlags = MSG_NOSIGNAL;
+#else
+inline constexpr int kSendFlags = 0;
+#endif
+
+/**
+ * @brief A buffered stream buffer over a socket
+ *
+ * Reads and writes larger than the buffer bypass it, so the limbs of large numbers are sent and received without a
+ * second copy.
+ */
+class FdStreamBuf : public std::streambuf {
+ public:
+  explicit FdStreamBuf(int fd) : fd_{fd} {
+    setg(in_.data(), in_.data(), in_.data());
+    setp(out_.data(), out_.data() + out_.size());
+  }
+
+  FdStreamBuf(const FdStreamBuf&) = delete;
+  FdStreamBuf& operator=(const FdStreamBuf&) = delete;
+
+ protected:
+  int_type underflow() override {
+    const auto n = Read(in_.data(), in_.size());
+    if (n <= 0) {
+      return traits_type::eof();
+    }
+
+    setg(in_.data(), in_.data(), in_.data() + n);
+    return traits_type::to_int_type(*gptr());
+  }
+
+  std::streamsize xsgetn(char* s, std::streamsize count) override {
+    std::streamsize done = 0;
+    while (done < count) {
+      if (gptr() < egptr()) {
+        const auto len = std::min<std::streamsize>(egptr() - gptr(), count - done);
+        std::memcpy(s + done, gptr(), static_cast<std::size_t>(len));
+        gbump(static_cast<int>(len));
+        done += len;
+      } else if (count - done >= static_cast<std::streamsize>(in_.size())) {
+        const auto n = Read(s + done, static_cast<std::size_t>(count - done));
+        if (n <= 0) {
+          break;
+        }
+        done += n;
+      } else if (traits_type::eq_int_type(underflow(), traits_type::eof())) {
+        break;
+      }
+    }
+    return done;
+  }
+
+  int_type overflow(int_type ch) override {
+    if (!Flush()) {
+      return traits_type::eof();
+    }
+
+    if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+      *pptr() = traits_type::to_char_type(ch);
+      pbump(1);
+    }
+    return traits_type::not_eof(ch);
+  }
+
+  std::streamsize xsputn(const char* s, std::streamsize count) override {
+    if (count < static_cast<std::streamsize>(out_.size())) {
+      return std::streambuf::xsputn(s, count);
+    }
+
+    if (!Flush() || !WriteAll(s, static_cast<std::size_t>(count))) {
+      return 0;
+    }
+    return count;
+  }
+
+  int sync() override { return Flush() ? 0 : -1; }
+
+ private:
+  ssize_t Read(char* s, std::size_t size) {
+    for (;;) {
+      const auto n = ::read(fd_, s, size);
+      if (n >= 0 || errno != EINTR) {
+        return n;
+      }
+    }
+  }
+
+  bool WriteAll(const char* s, std::size_t size) {
+    while (size > 0) {
+      const auto n = ::send(fd_, s, size, kSendFlags);
+      if (n < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        return false;
+      }
+      s += n;
+      size -= static_cast<std::size_t>(n);
+    }
+    return true;
+  }
+
+  bool Flush() {
+    const auto ok = WriteAll(pbase(), static_cast<std::size_t>(pptr() - pbase()));
+    setp(out_.data(), out_.data() + out_.size());
+    return ok;
+  }
+
+  int fd_;
+  std::array<char, std::size_t{1} << 16> in_;
+  std::array<char, std::size_t{1} << 16> out_;
+};
+
+/// The requests from the coordinator to a worker
+enum class WorkerCommand : uint64_t {
+  /// Exit the worker
+  kExit = 0,
+  /// Read n1, n2 and need_p, and reply P(n1, n2), Q(n1, n2) and T(n1, n2)
+  kComputeRange = 1,
+  /// Read two `BigInt`s and reply their product
+  kMultiply = 2,
+};
+
+/// Products whose operands are smaller than this (in bits) are computed by the coordinator
+inline constexpr uint64_t kDistributedMergeMinBits = uint64_t{1} << 20;
+}  // namespace detail
+
+/**
+ * @brief Binary splitting by worker processes on the same machine
+ *
+ * The constructor forks `num_workers` workers, each connected to the coordinator by a Unix socket. `ComputeRange()`
+ * splits the terms into one range per worker with about the same bit width, and the workers compute their (P, Q, T)
+ * serially and send them back in the format of `Serialize()`. The coordinator merges the results level by level. The
+ * products of a merge whose operands have at least `merge_min_bits` bits are sent to the workers as well, so a large
+ * merge is split across the workers.
+ *
+ * With a checkpoint, the results of the ranges are saved, and the saved ones are loaded instead of being sent to the
+ * workers. The entries are shared with `SeriesDriver`.
+ *
+ * Each worker has at most one request in flight, so neither side blocks on a full socket while the other is writing.
+ *
+ * Create the coordinator before `ThreadPool::Default()` or any other thread starts, e.g. at the beginning of `main()`.
+ * A forked worker has only the forking thread, so a lock held by another thread of the coordinator at the fork, such as
+ * one of the pool or of the allocator, is never released in the worker. The workers call
+ * `ThreadPool::DisableDefault()` and compute serially, which avoids the pool but not the other locks.
+ */
+template <HypergeometricSeries S>
+class DistributedSeries {
+ public:
+  DistributedSeries(S series, std::size_t num_workers, uint64_t merge_min_bits = detail::kDistributedMergeMinBits)
+      : series_{std::move(series)}, merge_min_bits_{merge_min_bits} {
+    try {
+      for (std::size_t i = 0; i < num_workers; ++i) {
+        StartWorker();
+      }
+    } catch (...) {
+      Shutdown();
+      throw;
+    }
+  }
+
+  DistributedSeries(const DistributedSeries&) = delete;
+  DistributedSeries(DistributedSeries&&) = delete;
+  DistributedSeries& operator=(const DistributedSeries&) = delete;
+  DistributedSeries& operator=(DistributedSeries&&) = delete;
+
+  ~DistributedSeries() { Shutdown(); }
+
+  std::size_t NumWorkers() const noexcept { return workers_.size(); }
+  /// The number of products of merges computed by the workers
+  uint64_t RemoteProducts() const noexcept { return remote_products_; }
+  /// The number of ranges loaded from the checkpoint
+  uint64_t LoadedRanges() const noexcept { return loaded_ranges_; }
+
+  /**
+   * @brief Compute P(n1, n2), Q(n1, n2) and T(n1, n2). P is returned as zero unless `need_p`.
+   * @param checkpoint If not null, the results of the ranges are saved to and loaded from it
+   * @throw `SerializeError` if a worker exits or sends a broken result
+   */
+  std::tuple<BigInt, BigInt, BigInt> ComputeRange(uint64_t n1,
+                                                  uint64_t n2,
+                                                  bool need_p,
+                                                  const Checkpoint* checkpoint = nullptr) {
+    const auto num_ranges = std::min<uint64_t>(workers_.size(), n2 - n1);
+    if (num_ranges == 0) {
+      auto pqt = detail::ComputePQT(series_, n1, n2);
+      if (!need_p) {
+        std::get<0>(pqt) = BigInt{};
+      }
+      return pqt;
+    }
+
+    const auto bounds = Partition(n1, n2, num_ranges);
+    std::vector<Node> nodes(num_ranges);
+    std::vector<bool> loaded(num_ranges, false);
+    for (std::size_t i = 0; i < num_ranges; ++i) {
+      nodes[i].need_p = need_p || i + 1 < num_ranges;
+      if (auto pqt = LoadRange(checkpoint, bounds[i], bounds[i + 1], nodes[i].need_p)) {
+        std::tie(nodes[i].p, nodes[i].q, nodes[i].t) = std::move(*pqt);
+        loaded[i] = true;
+        continue;
+      }
+
+      auto& os = *workers_[i].stream;
+      detail::WriteWord(os, static_cast<uint64_t>(detail::WorkerCommand::kComputeRange));
+      detail::WriteWord(os, bounds[i]);
+      detail::WriteWord(os, bounds[i + 1]);
+      detail::WriteWord(os, nodes[i].need_p ? 1 : 0);
+      os.flush();
+    }
+    for (std::size_t i = 0; i < num_ranges; ++i) {
+      if (loaded[i]) {
+        continue;
+      }
+
+      auto& is = *workers_[i].stream;
+      nodes[i].p = Deserialize<BigInt>(is);
+      nodes[i].q = Deserialize<BigInt>(is);
+      nodes[i].t = Deserialize<BigInt>(is);
+      if (checkpoint != nullptr) {
+        checkpoint->Save(detail::SubtreeCheckpointName(series_, bounds[i], bounds[i + 1], nodes[i].need_p),
+                          nodes[i].p, nodes[i].q, nodes[i].t);
+      }
+    }
+
+    while (nodes.size() > 1) {
+      nodes = MergeLevel(std::move(nodes));
+    }
+    return {std::move(nodes[0].p), std::move(nodes[0].q), std::move(nodes[0].t)};
+  }
+
+ private:
+  struct Worker {
+    pid_t pid;
+    int fd;
+    std::unique_ptr<detail::FdStreamBuf> buf;
+    std::unique_ptr<std::iostream> stream;
+  };
+
+  struct Node {
+    BigInt p;
+    BigInt q;
+    BigInt t;
+    bool need_p{true};
+  };
+
+  /// lhs * rhs, stored to `*out`
+  struct Product {
+    const BigInt* lhs;
+    const BigInt* rhs;
+    BigInt* out;
+  };
+
+  void StartWorker() {
+    int fds[2];
+    if (::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+      throw DistributedError("Failed to create a socket pair");
+    }
+
+    const auto pid = ::fork();
+    if (pid < 0) {
+      ::close(fds[0]);
+      ::close(fds[1]);
+      throw DistributedError("Failed to fork a worker");
+    }
+
+    if (pid == 0) {
+      ::close(fds[0]);
+      for (const auto& worker : workers_) {
+        ::close(worker.fd);
+      }
+      RunWorker(fds[1]);
+    }
+
+    ::close(fds[1]);
+    auto buf = std::make_unique<detail::FdStreamBuf>(fds[0]);
+    auto stream = std::make_unique<std::iostream>(buf.get());
+    workers_.push_back({pid, fds[0], std::move(buf), std::move(stream)});
+  }
+
+  /// The main loop of a worker. It never returns, and it exits without running the destructors of the coordinator.
+  [[noreturn]] void RunWorker(int fd) noexcept {
+    ThreadPool::DisableDefault();
+
+    int status = 0;
+    try {
+      detail::FdStreamBuf buf{fd};
+      std::iostream io{&buf};
+      for (;;) {
+        const auto command = static_cast<detail::WorkerCommand>(detail::ReadWord(io));
+        if (command == detail::WorkerCommand::kExit) {
+          break;
+        } else if (command == detail::WorkerCommand::kComputeRange) {
+          const auto n1 = detail::ReadWord(io);
+          const auto n2 = detail::ReadWord(io);
+          const auto need_p = detail::ReadWord(io) != 0;
+          const auto [p, q, t] = detail::ComputePQT(series_, n1, n2);
+          Serialize(io, need_p ? p : BigInt{});
+          Serialize(io, q);
+          Serialize(io, t);
+        } else if (command == detail::WorkerCommand::kMultiply) {
+          const auto lhs = Deserialize<BigInt>(io);
+          const auto rhs = Deserialize<BigInt>(io);
+          Serialize(io, Multiply(lhs, rhs));
+        } else {
+          status = 1;
+          break;
+        }
+        io.flush();
+      }
+    } catch (const SerializeError&) {
+      // The coordinator has closed the socket
+    } catch (...) {
+      status = 1;
+    }
+
+    ::close(fd);
+    ::_exit(status);
+  }
+
+  void Shutdown() noexcept {
+    for (auto& worker : workers_) {
+      try {
+        detail::WriteWord(*worker.stream, static_cast<uint64_t>(detail::WorkerCommand::kExit));
+        worker.stream->flush();
+      } catch (...) {
+        // The worker has already exited
+      }
+      worker.stream.reset();
+      worker.buf.reset();
+      ::close(worker.fd);
+      ::waitpid(worker.pid, nullptr, 0);
+    }
+    workers_.clear();
+  }
+
+  /// Load the result of the range (n1, n2] from `checkpoint` if it is not null
+  std::optional<std::tuple<BigInt, BigInt, BigInt>> LoadRange(const Checkpoint* checkpoint,
+                                                              uint64_t n1,
+                                                              uint64_t n2,
+                                                              bool need_p) {
+    if (checkpoint == nullptr) {
+      return std::nullopt;
+    }
+
+    auto pqt = checkpoint->Load<BigInt, BigInt, BigInt>(detail::SubtreeCheckpointName(series_, n1, n2, need_p));
+    if (pqt) {
+      ++loaded_ranges_;
+    }
+    return pqt;
+  }
+
+  /// Split [n1, n2) into `num_ranges` nonempty ranges whose Q have about the same bit width
+  std::vector<uint64_t> Partition(uint64_t n1, uint64_t n2, uint64_t num_ranges) const {
+    const auto base = series_.EstimateQBits(n1);
+    const auto total = series_.EstimateQBits(n2) - base;
+
+    std::vector<uint64_t> bounds{n1};
+    for (uint64_t i = 1; i < num_ranges; ++i) {
+      const auto target = base + total * static_cast<double>(i) / static_cast<double>(num_ranges);
+      uint64_t l = bounds.back() + 1;
+      uint64_t r = n2 - (num_ranges - i);
+      while (l < r) {
+        const auto m = l + (r - l) / 2;
+        if (series_.EstimateQBits(m) < target) {
+          l = m + 1;
+        } else {
+          r = m;
+        }
+      }
+      bounds.push_back(l);
+    }
+    bounds.push_back(n2);
+    return bounds;
+  }
+
+  /// Merge the adjacent pairs of `nodes`. The large products are computed by the workers.
+  std::vector<Node> MergeLevel(std::vector<Node> nodes) {
+    std::vector<Node> merged((nodes.size() + 1) / 2);
+    // t1 q2 and t2 p1 of each pair
+    std::vector<std::pair<BigInt, BigInt>> t_terms(nodes.size() / 2);
+    std::vector<Product> remote;
+    std::vector<Product> local;
+
+    for (std::size_t i = 0; i + 1 < nodes.size(); i += 2) {
+      const auto& left = nodes[i];
+      const auto& right = nodes[i + 1];
+      auto& node = merged[i / 2];
+      auto& [t1_q2, t2_p1] = t_terms[i / 2];
+      node.need_p = right.need_p;
+
+      const auto bits = std::min(left.q.NumberOfBits(), right.q.NumberOfBits());
+      auto& products = bits >= merge_min_bits_ ? remote : local;
+      products.push_back({&left.t, &right.q, &t1_q2});
+      products.push_back({&right.t, &left.p, &t2_p1});
+      if (node.need_p) {
+        products.push_back({&left.p, &right.p, &node.p});
+      }
+      products.push_back({&left.q, &right.q, &node.q});
+    }
+    if (nodes.size() % 2 == 1) {
+      merged.back() = std::move(nodes.back());
+    }
+
+    RunRemoteProducts(remote);
+    for (const auto& product : local) {
+      *product.out = Multiply(*product.lhs, *product.rhs);
+    }
+
+    for (std::size_t i = 0; i < t_terms.size(); ++i) {
+      merged[i].t = t_terms[i].first + t_terms[i].second;
+    }
+    return merged;
+  }
+
+  /// Compute `products` by the workers, at most one request per worker at a time
+  void RunRemoteProducts(const std::vector<Product>& products) {
+    for (std::size_t begin = 0; begin < products.size(); begin += workers_.size()) {
+      const auto end = std::min(products.size(), begin + workers_.size());
+      for (auto i = begin; i < end; ++i) {
+        auto& os = *workers_[i - begin].stream;
+        detail::WriteWord(os, static_cast<uint64_t>(detail::WorkerCommand::kMultiply));
+        Serialize(os, *products[i].lhs);
+        Serialize(os, *products[i].rhs);
+        os.flush();
+      }
+      for (auto i = begin; i < end; ++i) {
+        *products[i].out = Deserialize<BigInt>(*workers_[i - begin].stream);
+      }
+      remote_products_ += end - begin;
+    }
+  }
+
+  S series_;
+  const uint64_t merge_min_bits_;
+  std::vector<Worker> workers_;
+  uint64_t remote_products_{0};
+  uint64_t loaded_ranges_{0};
+};
+}  // namespace komori
+
+#endif  // KOMORI_DISTRIBUTED_HPP_
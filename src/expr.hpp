@@ -0,0 +1,310 @@
+#ifndef KOMORI_EXPR_HPP_
+#define KOMORI_EXPR_HPP_
+
+#include <array>
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "bigint.hpp"
+#include "biguint.hpp"
+#include "ssa.hpp"
+
+namespace komori {
+/**
+ * @brief A lazily evaluated term `coefficient * lhs * rhs`
+ * @tparam T `BigUint` or `BigInt`
+ *
+ * If `rhs` is `nullptr`, the term is `coefficient * lhs`. The term only refers to the operands, so they must outlive the
+ * expression.
+ */
+template <typename T>
+struct ProductTerm {
+  const T* lhs;
+  const T* rhs;
+  uint64_t coefficient;
+};
+
+/**
+ * @brief An expression `terms[0] + terms[1] + ... + terms[N-1]`
+ * @tparam T `BigUint` or `BigInt`
+ * @tparam N The number of terms
+ *
+ * The expression is built by `Lazy()` and the operators below, and computed by `Evaluate()`:
+ * ```cpp
+ * auto t = Evaluate(Lazy(t1) * Lazy(q2) + Lazy(t2) * Lazy(p1));
+ * auto d = Evaluate((Lazy(q) * A + Lazy(t)) * 12);
+ * ```
+ */
+template <typename T, std::size_t N>
+struct SumOfProducts {
+  std::array<ProductTerm<T>, N> terms;
+};
+
+/// A reference to an operand of an expression
+template <typename T>
+struct LazyRef {
+  const T& value;
+};
+
+/// Make `value` an operand of an expression
+template <typename T>
+constexpr LazyRef<T> Lazy(const T& value) noexcept {
+  return LazyRef<T>{value};
+}
+
+namespace detail {
+constexpr inline uint64_t MultiplyCoefficient(uint64_t lhs, uint64_t rhs) {
+  const auto product = static_cast<uint128_t>(lhs) * static_cast<uint128_t>(rhs);
+  if (product >> 64) {
+    throw std::overflow_error("The coefficient is too big");
+  }
+  return static_cast<uint64_t>(product);
+}
+
+/**
+ * @brief out += x * coefficient
+ * @pre `out` has enough length to store the result
+ */
+constexpr inline void AddMultiplySmallTo(std::vector<uint64_t>& out, const BigUint& x, uint64_t coefficient) {
+  uint128_t carry = 0;
+  std::size_t i = 0;
+  for (; i < x.size(); ++i) {
+    const auto sum = static_cast<uint128_t>(out[i]) + static_cast<uint128_t>(x[i]) * coefficient + carry;
+    out[i] = static_cast<uint64_t>(sum);
+    carry = sum >> 64;
+  }
+
+  for (; carry > 0; ++i) {
+    const auto sum = static_cast<uint128_t>(out[i]) + carry;
+    out[i] = static_cast<uint64_t>(sum);
+    carry = sum >> 64;
+  }
+}
+
+/**
+ * @brief out += lhs * rhs by the schoolbook method without any temporary buffer
+ * @pre `out` has enough length to store the result
+ */
+constexpr inline void AddMultiplyNaiveTo(std::vector<uint64_t>& out, const BigUint& lhs, const BigUint& rhs) {
+  for (std::size_t i = 0; i < lhs.size(); ++i) {
+    uint128_t carry = 0;
+    std::size_t k = i;
+    for (std::size_t j = 0; j < rhs.size(); ++j, ++k) {
+      // (2^64-1) + (2^64-1)^2 + (2^64-1) = 2^128-1, so the sum never overflows
+      const auto sum =
+          static_cast<uint128_t>(out[k]) + static_cast<uint128_t>(lhs[i]) * static_cast<uint128_t>(rhs[j]) + carry;
+      out[k] = static_cast<uint64_t>(sum);
+      carry = sum >> 64;
+    }
+
+    for (; carry > 0; ++k) {
+      const auto sum = static_cast<uint128_t>(out[k]) + carry;
+      out[k] = static_cast<uint64_t>(sum);
+      carry = sum >> 64;
+    }
+  }
+}
+
+/**
+ * @brief Judge if the products in `terms` can be accumulated in the SSA-transformed domain
+ *
+ * Each coefficient of a cyclic convolution is less than 2^(k-1+2m) and the modulus is 2^n+1 (n >= k+2m), so the sum of
+ * two products can be recovered exactly. A single product is left to `Multiply()`.
+ */
+constexpr inline bool CanFuseBySSA(std::span<const ProductTerm<BigUint>> terms) {
+  std::size_t product_count = 0;
+  for (const auto& term : terms) {
+    if (term.rhs == nullptr) {
+      continue;
+    }
+
+    const auto number_of_bits = std::min(term.lhs->NumberOfBits(), term.rhs->NumberOfBits());
+    if (term.coefficient != 1 || number_of_bits < kSSAThresholdBits) {
+      return false;
+    }
+    ++product_count;
+  }
+
+  return product_count == 2;
+}
+
+/// Compute the sum of products in `terms` in the SSA-transformed domain. Transforms of repeated operands are shared.
+constexpr inline BigUint EvaluateProductsBySSA(std::span<const ProductTerm<BigUint>> terms) {
+  uint64_t bit_len = 0;
+  for (const auto& term : terms) {
+    if (term.rhs != nullptr) {
+      bit_len = std::max({bit_len, term.lhs->NumberOfBits(), term.rhs->NumberOfBits()});
+    }
+  }
+  // One more bit is needed in order not to wrap around the sum of products
+  const auto k = Best_k(bit_len + 1);
+
+  std::vector<std::pair<const BigUint*, SplittedInteger>> transformed;
+  // Reserve in order not to invalidate the references returned by `transform()`
+  transformed.reserve(2 * terms.size());
+  auto transform = [&](const BigUint* num) -> const SplittedInteger& {
+    for (const auto& [key, value] : transformed) {
+      if (key == num) {
+        return value;
+      }
+    }
+
+    SplittedInteger value(*num, k, MultiplyThreadPool(bit_len, kParallelSSAThresholdBits));
+    value.NTT();
+    transformed.emplace_back(num, std::move(value));
+    return transformed.back().second;
+  };
+
+  std::vector<SplittedInteger> products;
+  for (const auto& term : terms) {
+    if (term.rhs != nullptr) {
+      auto product = transform(term.lhs);
+      product *= transform(term.rhs);
+      products.push_back(std::move(product));
+    }
+  }
+
+  auto& ans = products.front();
+  for (std::size_t i = 1; i < products.size(); ++i) {
+    ans += products[i];
+  }
+  ans.INTT();
+  return ans.Get();
+}
+
+/// Compute the sum of `terms` with a single output buffer
+constexpr inline BigUint EvaluateTerms(std::span<const ProductTerm<BigUint>> terms) {
+  const bool fused = CanFuseBySSA(terms);
+  std::vector<uint64_t> out;
+  if (fused) {
+    out = EvaluateProductsBySSA(terms);
+  }
+
+  std::size_t len = out.size();
+  for (const auto& term : terms) {
+    const auto rhs_len = (term.rhs != nullptr) ? term.rhs->size() : 0;
+    len = std::max(len, term.lhs->size() + rhs_len + 1);
+  }
+  // The carries of the N-term sum fit into one more word
+  out.resize(len + 1);
+
+  for (const auto& term : terms) {
+    if (term.rhs == nullptr) {
+      AddMultiplySmallTo(out, *term.lhs, term.coefficient);
+    } else if (fused) {
+      // Already accumulated in the transformed domain
+      continue;
+    } else if (term.coefficient == 1 && std::min(term.lhs->size(), term.rhs->size()) <= 64) {
+      AddMultiplyNaiveTo(out, *term.lhs, *term.rhs);
+    } else {
+      AddMultiplySmallTo(out, Multiply(*term.lhs, *term.rhs), term.coefficient);
+    }
+  }
+
+  return BigUint(std::move(out));
+}
+}  // namespace detail
+
+/**
+ * @brief Evaluate the expression
+ * @return The sum of the terms in `expr`
+ *
+ * The result is accumulated into a single buffer instead of materializing each product and each partial sum. If the
+ * products are large enough, they are also accumulated in the SSA-transformed domain so that only one inverse
+ * transform is needed.
+ */
+template <std::size_t N>
+constexpr BigUint Evaluate(const SumOfProducts<BigUint, N>& expr) {
+  return detail::EvaluateTerms(expr.terms);
+}
+
+template <std::size_t N>
+constexpr BigInt Evaluate(const SumOfProducts<BigInt, N>& expr) {
+  // Split the terms by the sign, and compute `positive - negative`
+  std::array<ProductTerm<BigUint>, N> positive{};
+  std::array<ProductTerm<BigUint>, N> negative{};
+  std::size_t positive_len = 0;
+  std::size_t negative_len = 0;
+  for (const auto& [lhs, rhs, coefficient] : expr.terms) {
+    auto sign = lhs->GetSign();
+    const BigUint* rhs_abs = nullptr;
+    if (rhs != nullptr) {
+      sign = sign ^ rhs->GetSign();
+      rhs_abs = &rhs->Abs();
+    }
+
+    if (sign == Sign::kPositive) {
+      positive[positive_len++] = {&lhs->Abs(), rhs_abs, coefficient};
+    } else {
+      negative[negative_len++] = {&lhs->Abs(), rhs_abs, coefficient};
+    }
+  }
+
+  auto positive_sum = detail::EvaluateTerms(std::span{positive.data(), positive_len});
+  if (negative_len == 0) {
+    return BigInt{std::move(positive_sum)};
+  }
+
+  auto negative_sum = detail::EvaluateTerms(std::span{negative.data(), negative_len});
+  if (positive_sum >= negative_sum) {
+    positive_sum -= negative_sum;
+    return BigInt{std::move(positive_sum)};
+  } else {
+    negative_sum -= positive_sum;
+    return BigInt{std::move(negative_sum), Sign::kNegative};
+  }
+}
+
+// <Operators>
+template <typename T>
+constexpr SumOfProducts<T, 1> operator*(LazyRef<T> lhs, LazyRef<T> rhs) noexcept {
+  return {{{{&lhs.value, &rhs.value, 1}}}};
+}
+
+template <typename T>
+constexpr SumOfProducts<T, 1> operator*(LazyRef<T> lhs, uint64_t rhs) noexcept {
+  return {{{{&lhs.value, nullptr, rhs}}}};
+}
+
+template <typename T>
+constexpr SumOfProducts<T, 1> operator*(uint64_t lhs, LazyRef<T> rhs) noexcept {
+  return rhs * lhs;
+}
+
+template <typename T, std::size_t N>
+constexpr SumOfProducts<T, N> operator*(SumOfProducts<T, N> lhs, uint64_t rhs) {
+  for (auto& term : lhs.terms) {
+    term.coefficient = detail::MultiplyCoefficient(term.coefficient, rhs);
+  }
+  return lhs;
+}
+
+template <typename T, std::size_t N>
+constexpr SumOfProducts<T, N> operator*(uint64_t lhs, SumOfProducts<T, N> rhs) {
+  return std::move(rhs) * lhs;
+}
+
+template <typename T, std::size_t N, std::size_t M>
+constexpr SumOfProducts<T, N + M> operator+(const SumOfProducts<T, N>& lhs, const SumOfProducts<T, M>& rhs) noexcept {
+  SumOfProducts<T, N + M> ans{};
+  std::copy(lhs.terms.begin(), lhs.terms.end(), ans.terms.begin());
+  std::copy(rhs.terms.begin(), rhs.terms.end(), ans.terms.begin() + N);
+  return ans;
+}
+
+template <typename T, std::size_t N>
+constexpr SumOfProducts<T, N + 1> operator+(const SumOfProducts<T, N>& lhs, LazyRef<T> rhs) noexcept {
+  return lhs + rhs * uint64_t{1};
+}
+
+template <typename T, std::size_t N>
+constexpr SumOfProducts<T, N + 1> operator+(LazyRef<T> lhs, const SumOfProducts<T, N>& rhs) noexcept {
+  return lhs * uint64_t{1} + rhs;
+}
+// </Operators>
+}  // namespace komori
+
+#endif  // KOMORI_EXPR_HPP_
@@ -0,0 +1,254 @@
+#ifndef KOMORI_FACTORIZATION_HPP_
+#define KOMORI_FACTORIZATION_HPP_
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "biguint.hpp"
+#include "ssa.hpp"
+
+namespace komori {
+/**
+ * @brief A positive integer represented by its prime factors
+ *
+ * The factors are kept as (prime, exponent) pairs sorted by the prime, so that multiplication, division and gcd are
+ * linear merges of two lists. The default value is 1.
+ */
+class Factorization {
+ public:
+  /// A pair of a prime and its exponent
+  using Factor = std::pair<uint64_t, uint64_t>;
+
+  constexpr Factorization() = default;
+
+  /// Construct from (prime, exponent) pairs sorted by the prime with positive exponents
+  constexpr explicit Factorization(std::vector<Factor> factors) : factors_{std::move(factors)} {}
+
+  constexpr const std::vector<Factor>& Factors() const noexcept { return factors_; }
+  constexpr bool IsOne() const noexcept { return factors_.empty(); }
+
+  constexpr Factorization Pow(uint64_t index) const {
+    if (index == 0) {
+      return {};
+    }
+
+    auto ans = *this;
+    for (auto& [prime, exponent] : ans.factors_) {
+      exponent *= index;
+    }
+    return ans;
+  }
+
+  /**
+   * @brief Multiply the prime powers out
+   *
+   * The prime powers are packed into limbs, and the limbs are multiplied by a product tree so that the operands of each
+   * multiplication have about the same size.
+   */
+  constexpr BigUint ToBigUint() const {
+    std::vector<BigUint> products;
+    uint64_t limb = 1;
+    for (const auto& [prime, exponent] : factors_) {
+      for (uint64_t i = 0; i < exponent; ++i) {
+        if (limb > std::numeric_limits<uint64_t>::max() / prime) {
+          products.push_back(BigUint{limb});
+          limb = 1;
+        }
+        limb *= prime;
+      }
+    }
+    products.push_back(BigUint{limb});
+
+    while (products.size() > 1) {
+      std::vector<BigUint> next;
+      next.reserve((products.size() + 1) / 2);
+      for (std::size_t i = 0; i + 1 < products.size(); i += 2) {
+        next.push_back(Multiply(products[i], products[i + 1]));
+      }
+      if (products.size() % 2 == 1) {
+        next.push_back(std::move(products.back()));
+      }
+      products = std::move(next);
+    }
+
+    return std::move(products.front());
+  }
+
+  constexpr Factorization& operator*=(const Factorization& rhs) {
+    std::vector<Factor> ans;
+    ans.reserve(factors_.size() + rhs.factors_.size());
+
+    auto l = factors_.begin();
+    auto r = rhs.factors_.begin();
+    while (l != factors_.end() || r != rhs.factors_.end()) {
+      if (r == rhs.factors_.end() || (l != factors_.end() && l->first < r->first)) {
+        ans.push_back(*l++);
+      } else if (l == factors_.end() || r->first < l->first) {
+        ans.push_back(*r++);
+      } else {
+        ans.emplace_back(l->first, l->second + r->second);
+        ++l;
+        ++r;
+      }
+    }
+
+    factors_ = std::move(ans);
+    return *this;
+  }
+
+  /**
+   * @brief Divide by `rhs`
+   * @throw `std::invalid_argument` if `rhs` does not divide `*this`
+   */
+  constexpr Factorization& operator/=(const Factorization& rhs) {
+    std::vector<Factor> ans;
+    ans.reserve(factors_.size());
+
+    auto r = rhs.factors_.begin();
+    for (const auto& [prime, exponent] : factors_) {
+      if (r != rhs.factors_.end() && r->first < prime) {
+        break;
+      }
+
+      if (r != rhs.factors_.end() && r->first == prime) {
+        if (r->second > exponent) {
+          break;
+        }
+        if (r->second < exponent) {
+          ans.emplace_back(prime, exponent - r->second);
+        }
+        ++r;
+      } else {
+        ans.emplace_back(prime, exponent);
+      }
+    }
+
+    if (r != rhs.factors_.end()) {
+      throw std::invalid_argument("The divisor is not a factor");
+    }
+
+    factors_ = std::move(ans);
+    return *this;
+  }
+
+  friend constexpr Factorization operator*(Factorization lhs, const Factorization& rhs) {
+    lhs *= rhs;
+    return lhs;
+  }
+
+  friend constexpr Factorization operator/(Factorization lhs, const Factorization& rhs) {
+    lhs /= rhs;
+    return lhs;
+  }
+
+  friend constexpr bool operator==(const Factorization& lhs, const Factorization& rhs) noexcept = default;
+
+  /// The greatest common divisor, i.e. the minimum exponent of each prime
+  friend constexpr Factorization Gcd(const Factorization& lhs, const Factorization& rhs) {
+    std::vector<Factor> ans;
+
+    auto l = lhs.factors_.begin();
+    auto r = rhs.factors_.begin();
+    while (l != lhs.factors_.end() && r != rhs.factors_.end()) {
+      if (l->first < r->first) {
+        ++l;
+      } else if (r->first < l->first) {
+        ++r;
+      } else {
+        ans.emplace_back(l->first, std::min(l->second, r->second));
+        ++l;
+        ++r;
+      }
+    }
+
+    return Factorization{std::move(ans)};
+  }
+
+ private:
+  std::vector<Factor> factors_;
+};
+
+/**
+ * @brief A table of the smallest prime factors of the integers up to a limit
+ *
+ * Integers up to the limit are factorized by following the table. Larger integers are factorized by trial division by
+ * the primes in the table, which succeeds if at most one prime factor is greater than the limit.
+ */
+class PrimeSieve {
+ public:
+  /// Construct the table for [0, limit]
+  constexpr explicit PrimeSieve(uint64_t limit) : smallest_prime_factors_(std::max<uint64_t>(limit, 1) + 1) {
+    for (uint64_t i = 2; i * i < smallest_prime_factors_.size(); ++i) {
+      if (!IsPrime(i)) {
+        continue;
+      }
+
+      for (uint64_t j = i * i; j < smallest_prime_factors_.size(); j += i) {
+        if (smallest_prime_factors_[j] == 0) {
+          smallest_prime_factors_[j] = static_cast<uint32_t>(i);
+        }
+      }
+    }
+  }
+
+  constexpr uint64_t Limit() const noexcept { return smallest_prime_factors_.size() - 1; }
+
+  /**
+   * @brief Factorize `n`
+   * @throw `std::out_of_range` if `n` is zero, or if `n` has two or more prime factors above `Limit()`
+   */
+  constexpr Factorization Factorize(uint64_t n) const {
+    if (n == 0) {
+      throw std::out_of_range("Zero cannot be factorized");
+    }
+
+    std::vector<Factorization::Factor> factors;
+    auto push = [&](uint64_t prime) {
+      if (!factors.empty() && factors.back().first == prime) {
+        ++factors.back().second;
+      } else {
+        factors.emplace_back(prime, 1);
+      }
+    };
+
+    if (n > Limit()) {
+      uint64_t prime = 2;
+      for (; prime <= Limit() && prime * prime <= n; ++prime) {
+        while (IsPrime(prime) && n % prime == 0) {
+          push(prime);
+          n /= prime;
+        }
+      }
+
+      if (n > Limit()) {
+        // `n` is a prime unless a prime factor up to sqrt(n) is left untried
+        if (prime * prime <= n) {
+          throw std::out_of_range("The number has too large prime factors");
+        }
+        push(n);
+        return Factorization{std::move(factors)};
+      }
+    }
+
+    while (n > 1) {
+      const auto prime = IsPrime(n) ? n : uint64_t{smallest_prime_factors_[n]};
+      push(prime);
+      n /= prime;
+    }
+    return Factorization{std::move(factors)};
+  }
+
+ private:
+  /// @pre 2 <= n <= Limit()
+  constexpr bool IsPrime(uint64_t n) const noexcept { return smallest_prime_factors_[n] == 0; }
+
+  /// The smallest prime factor of each composite number, or 0 for primes. It is at most sqrt(Limit()).
+  std::vector<uint32_t> smallest_prime_factors_;
+};
+}  // namespace komori
+
+#endif  // KOMORI_FACTORIZATION_HPP_
@@ -9,7 +9,12 @@
 #include "biguint.hpp"
 
 namespace komori {
-class GF2PowNPlus1 {
+/**
+ * @brief An element of Z/(2^n+1)Z
+ * @tparam UInt `BasicBigUint` which stores the value
+ */
+template <typename UInt>
+class BasicGF2PowNPlus1 {
  private:
   constexpr void ApplyMod() {
     // We want to get y(0 <= y < 2**n + 1) such that
@@ -21,7 +26,7 @@ class GF2PowNPlus1 {
     //     = r - q (mod 2**n + 1)
     // follows. Therefore, we will calculate
     //     r - q
-    BigUint q = value_ >> n_;
+    UInt q = value_ >> n_;
     if (q.IsZero()) {
       return;
     }
@@ -36,29 +41,29 @@ class GF2PowNPlus1 {
   }
 
  public:
-  GF2PowNPlus1() = delete;
-  explicit constexpr GF2PowNPlus1(std::size_t n) : n_{n}, value_{} {}
-  constexpr GF2PowNPlus1(std::size_t n, BigUint value) : n_{n}, value_{std::move(value)} {}
-  constexpr GF2PowNPlus1(const GF2PowNPlus1&) = default;
-  constexpr GF2PowNPlus1(GF2PowNPlus1&&) noexcept = default;
-  constexpr GF2PowNPlus1& operator=(const GF2PowNPlus1&) = default;
-  constexpr GF2PowNPlus1& operator=(GF2PowNPlus1&&) noexcept = default;
-  constexpr ~GF2PowNPlus1() = default;
-
-  static constexpr GF2PowNPlus1 Make2Pow(std::size_t p, std::size_t n) {
+  BasicGF2PowNPlus1() = delete;
+  explicit constexpr BasicGF2PowNPlus1(std::size_t n) : n_{n}, value_{} {}
+  constexpr BasicGF2PowNPlus1(std::size_t n, UInt value) : n_{n}, value_{std::move(value)} {}
+  constexpr BasicGF2PowNPlus1(const BasicGF2PowNPlus1&) = default;
+  constexpr BasicGF2PowNPlus1(BasicGF2PowNPlus1&&) noexcept = default;
+  constexpr BasicGF2PowNPlus1& operator=(const BasicGF2PowNPlus1&) = default;
+  constexpr BasicGF2PowNPlus1& operator=(BasicGF2PowNPlus1&&) noexcept = default;
+  constexpr ~BasicGF2PowNPlus1() = default;
+
+  static constexpr BasicGF2PowNPlus1 Make2Pow(std::size_t p, std::size_t n) {
     p = p % (2 * n);
-    BigUint ans{1};
+    UInt ans{1};
     ans <<= p;
-    GF2PowNPlus1 ret(n, std::move(ans));
+    BasicGF2PowNPlus1 ret(n, std::move(ans));
     if (p > n) {
       ret.ApplyMod();
     }
     return ret;
   }
 
-  constexpr const BigUint& Get() const noexcept { return value_; }
+  constexpr const UInt& Get() const noexcept { return value_; }
 
-  constexpr GF2PowNPlus1& operator+=(const GF2PowNPlus1& rhs) {
+  constexpr BasicGF2PowNPlus1& operator+=(const BasicGF2PowNPlus1& rhs) {
     if (n_ != rhs.n_) {
       throw std::invalid_argument("n mismatch");
     }
@@ -67,7 +72,7 @@ class GF2PowNPlus1 {
     return *this;
   }
 
-  constexpr GF2PowNPlus1& operator-=(const GF2PowNPlus1& rhs) {
+  constexpr BasicGF2PowNPlus1& operator-=(const BasicGF2PowNPlus1& rhs) {
     if (n_ != rhs.n_) {
       throw std::invalid_argument("n mismatch");
     }
@@ -80,7 +85,7 @@ class GF2PowNPlus1 {
     return *this;
   }
 
-  constexpr GF2PowNPlus1& operator*=(const GF2PowNPlus1& rhs) {
+  constexpr BasicGF2PowNPlus1& operator*=(const BasicGF2PowNPlus1& rhs) {
     if (n_ != rhs.n_) {
       throw std::invalid_argument("n mismatch");
     }
@@ -89,20 +94,20 @@ class GF2PowNPlus1 {
     return *this;
   }
 
-  friend constexpr GF2PowNPlus1 operator+(const GF2PowNPlus1& lhs, const GF2PowNPlus1& rhs) {
-    GF2PowNPlus1 tmp = lhs;
+  friend constexpr BasicGF2PowNPlus1 operator+(const BasicGF2PowNPlus1& lhs, const BasicGF2PowNPlus1& rhs) {
+    BasicGF2PowNPlus1 tmp = lhs;
     tmp += rhs;
     return tmp;
   }
 
-  friend constexpr GF2PowNPlus1 operator-(const GF2PowNPlus1& lhs, const GF2PowNPlus1& rhs) {
-    GF2PowNPlus1 tmp = lhs;
+  friend constexpr BasicGF2PowNPlus1 operator-(const BasicGF2PowNPlus1& lhs, const BasicGF2PowNPlus1& rhs) {
+    BasicGF2PowNPlus1 tmp = lhs;
     tmp -= rhs;
     return tmp;
   }
 
-  friend constexpr GF2PowNPlus1 operator*(const GF2PowNPlus1& lhs, const GF2PowNPlus1& rhs) {
-    GF2PowNPlus1 tmp = lhs;
+  friend constexpr BasicGF2PowNPlus1 operator*(const BasicGF2PowNPlus1& lhs, const BasicGF2PowNPlus1& rhs) {
+    BasicGF2PowNPlus1 tmp = lhs;
     tmp *= rhs;
     return tmp;
   }
@@ -114,8 +119,10 @@ class GF2PowNPlus1 {
   }
 
   std::size_t n_;
-  BigUint value_;
+  UInt value_;
 };
+
+using GF2PowNPlus1 = BasicGF2PowNPlus1<BigUint>;
 }  // namespace komori
 
 #endif  // KOMORI_GF2N1_HPP_
\ No newline at end of file
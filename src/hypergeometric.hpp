@@ -0,0 +1,835 @@
+#ifndef KOMORI_HYPERGEOMETRIC_HPP_
+#define KOMORI_HYPERGEOMETRIC_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+
+#include "bigfixed.hpp"
+#include "bigint.hpp"
+#include "biguint.hpp"
+#include "checkpoint.hpp"
+#include "disk_biguint.hpp"
+#include "expr.hpp"
+#include "factorization.hpp"
+#include "ssa.hpp"
+#include "static_biguint.hpp"
+#include "thread_pool.hpp"
+
+namespace komori {
+/// The maximum number of factors of p(k), q(k) and a(k)
+inline constexpr std::size_t kMaxTermFactors = 8;
+
+/// The factors of a term. Each factor fits in a limb, and the empty list means 1.
+using TermFactors = StaticVector<uint64_t, kMaxTermFactors>;
+
+/**
+ * @brief The k-th term of a hypergeometric series
+ *
+ * The series is S = sum_{k>=0} a(k) p(1) ... p(k) / (q(1) ... q(k)), where p(k), q(k) and |a(k)| are given as products
+ * of small factors and a(k) has the sign `a_sign`. For k = 0, only `a` and `a_sign` are used.
+ */
+struct HypergeometricTerm {
+  TermFactors p;
+  TermFactors q;
+  TermFactors a;
+  Sign a_sign{Sign::kPositive};
+};
+
+/**
+ * @brief A term generator of a hypergeometric series summed by binary splitting
+ *
+ * - `Term(k)` returns the k-th term. The factors must not decrease as k grows, which gives the bounds of the leaf
+ *   blocks from the last term.
+ * - `EstimateQBits(n)` estimates log2 Q(0, n) at run time to balance and schedule the subtrees.
+ * - `SieveLimit(n)` is the size of the sieve that factorizes p(k) and q(k) for k <= n in the common-factor removal. A
+ *   factor above it may have at most one prime factor above it.
+ * - `TermsFor(bits)` is the number of terms n such that S - (a(0) + T(0, n) / Q(0, n)) is below 2^(-bits).
+ * - `Name()` identifies the series in checkpoints.
+ */
+template <typename S>
+concept HypergeometricSeries = requires(const S& series, uint64_t k) {
+  { series.Term(k) } -> std::same_as<HypergeometricTerm>;
+  { series.EstimateQBits(k) } -> std::convertible_to<double>;
+  { series.SieveLimit(k) } -> std::convertible_to<uint64_t>;
+  { series.TermsFor(k) } -> std::convertible_to<uint64_t>;
+  { series.Name() } -> std::convertible_to<std::string_view>;
+};
+
+/// How to compute a series
+struct SeriesOptions {
+  /// Whether to remove the common prime factors of P and Q. It does not change the ratio T / Q.
+  bool remove_common_factors{false};
+  /// The budget of the bytes of the live integers. Concurrency is limited to fit in it.
+  uint64_t memory_budget_bytes{std::numeric_limits<uint64_t>::max()};
+  /// The directory to spill large intermediate results to while other subtrees are computed, and to merge them in
+  /// when the merge does not fit in the budget. Disabled if empty.
+  std::string spill_directory{};
+};
+
+/// The statistics of binary splitting
+struct SeriesReport {
+  /// The peak of the bytes of the live integers
+  uint64_t peak_bytes{0};
+  /// The number of subtrees and products that were not run concurrently because of the memory budget
+  uint64_t deferred_tasks{0};
+  /// The number of subtrees loaded from a checkpoint
+  uint64_t loaded_subtrees{0};
+  /// The number of subtrees whose results were spilled to disk
+  uint64_t spilled_subtrees{0};
+  /// The number of merges whose products were formed out of core because of the memory budget
+  uint64_t out_of_core_merges{0};
+  /// The number of products of merges computed by worker processes
+  uint64_t remote_products{0};
+};
+
+namespace detail {
+/// The capacity of the accumulators of `ComputeLeafBlock()` in 64-bit limbs, which holds a single term of
+/// `kMaxTermFactors` factors in each of p, q and a. See `FitsInLeafBlock()`.
+inline constexpr std::size_t kLeafBlockLimbs = 2 * kMaxTermFactors + 1;
+
+/// The sum of the bit widths of `factors`, an upper bound of the bit width of their product
+constexpr inline uint64_t FactorBits(const TermFactors& factors) noexcept {
+  uint64_t bits = 0;
+  for (const auto factor : factors) {
+    bits += static_cast<uint64_t>(std::bit_width(factor));
+  }
+  return bits;
+}
+
+/// Multiply adjacent factors while the product fits in a limb, so that fewer limb multiplications are needed
+constexpr inline TermFactors PackFactors(const TermFactors& factors) {
+  TermFactors packed;
+  uint64_t limb = 1;
+  for (const auto factor : factors) {
+    if (factor == 0) {
+      // e.g. a vanishing a(k)
+      TermFactors zero;
+      zero.push_back(0);
+      return zero;
+    }
+    if (limb > std::numeric_limits<uint64_t>::max() / factor) {
+      packed.push_back(limb);
+      limb = 1;
+    }
+    limb *= factor;
+  }
+  if (limb > 1) {
+    packed.push_back(limb);
+  }
+  return packed;
+}
+
+/// Whether the terms in (n1, n2] fit in the accumulators of `ComputeLeafBlock()`
+template <HypergeometricSeries S>
+constexpr bool FitsInLeafBlock(const S& series, uint64_t n1, uint64_t n2) {
+  // A single term has at most 64 * kMaxTermFactors bits in each of p, q and a, and T = a(n2) p(n2) fits in the
+  // accumulators. This is the base case of the binary splitting.
+  static_assert(64 * (2 * kMaxTermFactors) + 64 <= 64 * kLeafBlockLimbs);
+  if (n2 - n1 <= 1) {
+    return true;
+  }
+
+  // The factors grow with k, so the last term bounds the others. T(n1, n2) < (n2 - n1) * a(n2) * max(p, q)^(n2 - n1).
+  const auto term = series.Term(n2);
+  const auto term_bits = std::max(FactorBits(term.p), FactorBits(term.q));
+  return (n2 - n1) * term_bits + FactorBits(term.a) + 64 <= 64 * kLeafBlockLimbs;
+}
+
+/**
+ * @brief Compute P(n1, n2), Q(n1, n2) and T(n1, n2) for a block of consecutive terms
+ *
+ * The terms are merged one by one into fixed-size accumulators: P *= p(k), Q *= q(k) and T = T q(k) + a(k) P(n1, k).
+ * The factors of each term are packed into limbs, so the accumulators are multiplied limb by limb, and only one
+ * `BigInt` triple is created per block.
+ *
+ * @pre `FitsInLeafBlock(series, n1, n2)`
+ */
+template <HypergeometricSeries S>
+constexpr std::tuple<BigInt, BigInt, BigInt> ComputeLeafBlock(const S& series, uint64_t n1, uint64_t n2) {
+  using LeafUint = StaticBigUint<kLeafBlockLimbs>;
+
+  LeafUint p{uint64_t{1}};
+  LeafUint q{uint64_t{1}};
+  LeafUint t;
+  auto t_sign = Sign::kPositive;
+  for (uint64_t k = n1 + 1; k <= n2; ++k) {
+    const auto term = series.Term(k);
+
+    for (const auto factor : PackFactors(term.p)) {
+      p *= factor;
+    }
+
+    // a(k) P(n1, k)
+    auto x = p;
+    for (const auto factor : PackFactors(term.a)) {
+      x *= factor;
+    }
+
+    for (const auto factor : PackFactors(term.q)) {
+      q *= factor;
+      t *= factor;
+    }
+
+    if (t_sign == term.a_sign || t.IsZero()) {
+      t += x;
+      t_sign = term.a_sign;
+    } else if (t >= x) {
+      t -= x;
+    } else {
+      t = x - t;
+      t_sign = term.a_sign;
+    }
+  }
+
+  return {BigInt{p.ToBigUint()}, BigInt{q.ToBigUint()}, BigInt{t.ToBigUint(), t_sign}};
+}
+
+/// Compute P(n1, n2), Q(n1, n2) and T(n1, n2) by binary splitting
+template <HypergeometricSeries S>
+constexpr std::tuple<BigInt, BigInt, BigInt> ComputePQT(const S& series, uint64_t n1, uint64_t n2) {
+  if (FitsInLeafBlock(series, n1, n2)) {
+    return ComputeLeafBlock(series, n1, n2);
+  } else {
+    const auto m = (n1 + n2) / 2;
+
+    auto [p1, q1, t1] = ComputePQT(series, n1, m);
+    auto [p2, q2, t2] = ComputePQT(series, m, n2);
+
+    auto t = Evaluate(Lazy(t1) * Lazy(q2) + Lazy(t2) * Lazy(p1));
+
+    auto p = Multiply(std::move(p1), std::move(p2));
+    auto q = Multiply(std::move(q1), std::move(q2));
+
+    return {std::move(p), std::move(q), std::move(t)};
+  }
+}
+
+/// P(n1, n2), Q(n1, n2) and T(n1, n2) with the prime factors of P and Q
+struct FactoredPQT {
+  BigInt p;
+  BigInt q;
+  BigInt t;
+  Factorization p_factors;
+  Factorization q_factors;
+};
+
+/**
+ * @brief Compute P(n1, n2), Q(n1, n2) and T(n1, n2) by binary splitting with common factors removed
+ * @param sieve A sieve that covers `series.SieveLimit(n2)`
+ *
+ * In each merge, a common factor d of P(n1, m) and Q(m, n2) divides P, Q and T of the parent, because T = T1 Q2 +
+ * P1 T2. Dividing P1 and Q2 by d before the merge scales P, Q and T by 1/d, which keeps the ratios P/Q and T/Q that
+ * the sum depends on. d is found from the factorizations, and the divisions are exact. Only the parent's P and Q are
+ * divided; T is not factorized.
+ */
+template <HypergeometricSeries S>
+constexpr FactoredPQT ComputeFactoredPQT(const S& series, uint64_t n1, uint64_t n2, const PrimeSieve& sieve) {
+  if (FitsInLeafBlock(series, n1, n2)) {
+    auto [p, q, t] = ComputeLeafBlock(series, n1, n2);
+
+    Factorization p_factors;
+    Factorization q_factors;
+    for (uint64_t k = n1 + 1; k <= n2; ++k) {
+      const auto term = series.Term(k);
+      for (const auto factor : term.p) {
+        p_factors *= sieve.Factorize(factor);
+      }
+      for (const auto factor : term.q) {
+        q_factors *= sieve.Factorize(factor);
+      }
+    }
+
+    return {std::move(p), std::move(q), std::move(t), std::move(p_factors), std::move(q_factors)};
+  } else {
+    const auto m = (n1 + n2) / 2;
+
+    auto left = ComputeFactoredPQT(series, n1, m, sieve);
+    auto right = ComputeFactoredPQT(series, m, n2, sieve);
+
+    const auto common = Gcd(left.p_factors, right.q_factors);
+    if (!common.IsOne()) {
+      const auto d = common.ToBigUint();
+      left.p = BigInt{ExactDivide(left.p.Abs(), d)};
+      right.q = BigInt{ExactDivide(right.q.Abs(), d)};
+      left.p_factors /= common;
+      right.q_factors /= common;
+    }
+
+    auto t = Evaluate(Lazy(left.t) * Lazy(right.q) + Lazy(right.t) * Lazy(left.p));
+    auto p = Multiply(left.p, right.p);
+    auto q = Multiply(left.q, right.q);
+
+    return {std::move(p), std::move(q), std::move(t), std::move(left.p_factors) * right.p_factors,
+            std::move(left.q_factors) * right.q_factors};
+  }
+}
+
+/// Subtrees and products smaller than this (in bits) are computed serially
+inline constexpr double kParallelCutoffBits = 1 << 16;
+
+/**
+ * @brief Choose the split point of [n1, n2) so that both halves have about the same bit width
+ *
+ * The terms grow with n, so the midpoint gives the right half larger operands. Splitting by the estimated bit width
+ * balances the work of the two subtrees.
+ */
+template <HypergeometricSeries S>
+uint64_t SplitByBitSize(const S& series, uint64_t n1, uint64_t n2) {
+  const auto base = series.EstimateQBits(n1);
+  const auto half = (series.EstimateQBits(n2) - base) / 2;
+
+  uint64_t l = n1 + 1;
+  uint64_t r = n2 - 1;
+  while (l < r) {
+    const auto m = l + (r - l) / 2;
+    if (series.EstimateQBits(m) - base < half) {
+      l = m + 1;
+    } else {
+      r = m;
+    }
+  }
+  return l;
+}
+
+/**
+ * @brief Compute P(n1, n2), Q(n1, n2) and T(n1, n2) by binary splitting in parallel
+ * @param pool The pool to run the subtrees and the products
+ * @param cutoff_bits Subtrees whose Q has fewer bits than this are computed by `ComputePQT()`
+ *
+ * The right subtree is submitted to `pool` while the current thread computes the left one. In each merge, P and Q are
+ * multiplied in other tasks while the current thread evaluates T.
+ */
+template <HypergeometricSeries S>
+std::tuple<BigInt, BigInt, BigInt> ComputePQTParallel(const S& series,
+                                                      uint64_t n1,
+                                                      uint64_t n2,
+                                                      ThreadPool& pool,
+                                                      double cutoff_bits = kParallelCutoffBits) {
+  if (n2 - n1 <= 1 || series.EstimateQBits(n2) - series.EstimateQBits(n1) < cutoff_bits) {
+    return ComputePQT(series, n1, n2);
+  }
+
+  const auto m = SplitByBitSize(series, n1, n2);
+  auto right = pool.Submit([=, &series, &pool] { return ComputePQTParallel(series, m, n2, pool, cutoff_bits); });
+  auto left_pqt = ComputePQTParallel(series, n1, m, pool, cutoff_bits);
+  auto right_pqt = right.Get();
+
+  const auto& [p1, q1, t1] = left_pqt;
+  const auto& [p2, q2, t2] = right_pqt;
+  auto p = pool.Submit([&left_pqt, &right_pqt] { return Multiply(std::get<0>(left_pqt), std::get<0>(right_pqt)); });
+  auto q = pool.Submit([&left_pqt, &right_pqt] { return Multiply(std::get<1>(left_pqt), std::get<1>(right_pqt)); });
+  auto t = Evaluate(Lazy(t1) * Lazy(q2) + Lazy(t2) * Lazy(p1));
+
+  return {p.Get(), q.Get(), std::move(t)};
+}
+
+/**
+ * @brief Count the bytes of the live integers of binary splitting
+ *
+ * `Live()` is the sum of the sizes of the results and the products being formed. The reserved bytes are the estimated
+ * peaks of the subtrees and products running in other tasks, which are checked against the budget before they start.
+ */
+class MemoryTracker {
+ public:
+  explicit MemoryTracker(uint64_t budget_bytes) : budget_bytes_{budget_bytes} {}
+
+  uint64_t Budget() const noexcept { return budget_bytes_; }
+  uint64_t Live() const noexcept { return live_bytes_.load(std::memory_order_relaxed); }
+  uint64_t Peak() const noexcept { return peak_bytes_.load(std::memory_order_relaxed); }
+
+  void Add(uint64_t bytes) noexcept {
+    const auto live = live_bytes_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    auto peak = peak_bytes_.load(std::memory_order_relaxed);
+    while (live > peak && !peak_bytes_.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+  }
+
+  void Release(uint64_t bytes) noexcept { live_bytes_.fetch_sub(bytes, std::memory_order_relaxed); }
+
+  /**
+   * @brief Reserve `bytes` for a concurrent task if the live, the reserved and `bytes` fit in the budget
+   * @return `false` if the task should run in the current thread instead
+   */
+  bool TryReserve(uint64_t bytes) noexcept {
+    auto reserved = reserved_bytes_.load(std::memory_order_relaxed);
+    do {
+      if (Live() + reserved + bytes > budget_bytes_) {
+        return false;
+      }
+    } while (!reserved_bytes_.compare_exchange_weak(reserved, reserved + bytes, std::memory_order_relaxed));
+    return true;
+  }
+
+  void Unreserve(uint64_t bytes) noexcept { reserved_bytes_.fetch_sub(bytes, std::memory_order_relaxed); }
+
+  /// Check if `bytes` more fit in the budget together with the live and the reserved bytes
+  bool Fits(uint64_t bytes) const noexcept {
+    return Live() + reserved_bytes_.load(std::memory_order_relaxed) + bytes <= budget_bytes_;
+  }
+
+ private:
+  const uint64_t budget_bytes_;
+  std::atomic<uint64_t> live_bytes_{0};
+  std::atomic<uint64_t> reserved_bytes_{0};
+  std::atomic<uint64_t> peak_bytes_{0};
+};
+
+/// The number of bytes of the limbs of `x`
+inline uint64_t BytesOf(const BigInt& x) {
+  return x.Abs().size() * sizeof(uint64_t);
+}
+
+/**
+ * @brief An estimate of the peak bytes to compute the subtree (n1, n2] serially
+ *
+ * The result holds P, Q and T, which are at most about as large as Q, and the last merge forms a product as large as
+ * Q while its inputs are alive.
+ */
+template <HypergeometricSeries S>
+uint64_t EstimateSubtreePeakBytes(const S& series, uint64_t n1, uint64_t n2) {
+  return static_cast<uint64_t>(4 * (series.EstimateQBits(n2) - series.EstimateQBits(n1)) / 8);
+}
+
+/// Subtrees smaller than this (in bits of Q) are not saved to checkpoints
+inline constexpr double kCheckpointMinBits = 1 << 20;
+/// Subtrees smaller than this (in bits of Q) are not spilled to disk
+inline constexpr double kSpillMinBits = 1 << 26;
+
+/// The name of the checkpoint entry of the subtree (n1, n2] of `series`
+template <HypergeometricSeries S>
+std::string SubtreeCheckpointName(const S& series, uint64_t n1, uint64_t n2, bool need_p) {
+  return std::string{series.Name()} + (need_p ? "_pqt_" : "_qt_") + std::to_string(n1) + "_" + std::to_string(n2);
+}
+
+/**
+ * @brief Binary splitting that computes only the outputs each node needs under a memory budget
+ *
+ * P of a node is needed only by its parent's T and P, so the nodes on the rightmost spine, including the root, skip P.
+ * A merge computes T first and frees T1 and T2, then P (if needed) and frees P1 and P2, then Q. The inputs are freed as
+ * soon as their last product finishes.
+ *
+ * A subtree or a product runs in another task of the pool only if its estimated peak fits in the budget together with
+ * the live integers and the other concurrent tasks. Otherwise it runs in the current thread after its sibling, so the
+ * budget bounds the extra memory of parallelism. The serial schedule itself is never refused; `PeakBytes()` reports
+ * whether it fit.
+ *
+ * With a checkpoint, the results of the subtrees whose Q has at least `checkpoint_min_bits` bits are saved, and the
+ * saved results are loaded instead of computing the subtrees again.
+ *
+ * With a scratch directory, the result of a left subtree whose Q has at least `spill_min_bits` bits is written to disk
+ * and released while its right sibling is computed, in another task or in the current thread. If the products of a
+ * merge of such subtrees do not fit in the budget, both inputs stay on disk and the products are formed by the
+ * out-of-core SSA (`detail::MultiplyOutOfCore()`), so only the outputs of the merge are in memory.
+ */
+template <HypergeometricSeries S>
+class SeriesDriver {
+ public:
+  SeriesDriver(const S& series,
+               ThreadPool& pool,
+               uint64_t memory_budget_bytes,
+               double cutoff_bits = kParallelCutoffBits)
+      : series_{series}, pool_{pool}, tracker_{memory_budget_bytes}, cutoff_bits_{cutoff_bits} {}
+
+  /// Compute Q(0, terms) and T(0, terms). P(0, terms) is not computed and is returned as zero.
+  std::tuple<BigInt, BigInt, BigInt> Compute(uint64_t terms) { return ComputeRange(0, terms, false); }
+
+  /// Compute P(n1, n2), Q(n1, n2) and T(n1, n2). P is returned as zero unless `need_p`.
+  std::tuple<BigInt, BigInt, BigInt> ComputeRange(uint64_t n1, uint64_t n2, bool need_p) {
+    auto pqt = Node(n1, n2, need_p);
+    Untrack(pqt);
+    return pqt;
+  }
+
+  /// The peak of the tracked bytes in `Compute()`
+  uint64_t PeakBytes() const noexcept { return tracker_.Peak(); }
+  /// The number of subtrees and products that were run in the current thread because of the budget
+  uint64_t DeferredTasks() const noexcept { return deferred_tasks_.load(std::memory_order_relaxed); }
+  /// The number of subtrees loaded from the checkpoint
+  uint64_t LoadedSubtrees() const noexcept { return loaded_subtrees_.load(std::memory_order_relaxed); }
+  /// The number of subtrees spilled to disk
+  uint64_t SpilledSubtrees() const noexcept { return spilled_subtrees_.load(std::memory_order_relaxed); }
+  /// The number of merges formed out of core
+  uint64_t OutOfCoreMerges() const noexcept { return out_of_core_merges_.load(std::memory_order_relaxed); }
+
+  /// Save and load the results of the subtrees with `checkpoint`. It must outlive `Compute()`.
+  void SetCheckpoint(const Checkpoint& checkpoint, double checkpoint_min_bits = kCheckpointMinBits) {
+    checkpoint_ = &checkpoint;
+    checkpoint_min_bits_ = checkpoint_min_bits;
+  }
+
+  /// Spill the results of the left subtrees and the merges over the budget to `scratch`. It must outlive `Compute()`.
+  void SetSpill(const ScratchDirectory& scratch, double spill_min_bits = kSpillMinBits) {
+    scratch_ = &scratch;
+    spill_min_bits_ = spill_min_bits;
+  }
+
+ private:
+  using PQT = std::tuple<BigInt, BigInt, BigInt>;
+  using SpilledPQT = std::tuple<DiskBigInt, DiskBigInt, DiskBigInt>;
+
+  double SubtreeBits(uint64_t n1, uint64_t n2) const { return series_.EstimateQBits(n2) - series_.EstimateQBits(n1); }
+
+  void Track(const PQT& pqt) {
+    tracker_.Add(BytesOf(std::get<0>(pqt)) + BytesOf(std::get<1>(pqt)) + BytesOf(std::get<2>(pqt)));
+  }
+
+  void Untrack(const PQT& pqt) {
+    tracker_.Release(BytesOf(std::get<0>(pqt)) + BytesOf(std::get<1>(pqt)) + BytesOf(std::get<2>(pqt)));
+  }
+
+  /// Whether the result of the subtree (n1, n2] is large enough to be spilled
+  bool ShouldSpill(uint64_t n1, uint64_t n2) const {
+    return scratch_ != nullptr && SubtreeBits(n1, n2) >= spill_min_bits_;
+  }
+
+  /// Move `pqt` to disk and release its memory
+  SpilledPQT Spill(PQT& pqt) {
+    SpilledPQT spilled{DiskBigInt{*scratch_, std::get<0>(pqt)},
+                       DiskBigInt{*scratch_, std::get<1>(pqt)},
+                       DiskBigInt{*scratch_, std::get<2>(pqt)}};
+    Untrack(pqt);
+    pqt = PQT{};
+    spilled_subtrees_.fetch_add(1, std::memory_order_relaxed);
+    return spilled;
+  }
+
+  PQT Restore(const SpilledPQT& spilled) {
+    PQT pqt{std::get<0>(spilled).ToBigInt(), std::get<1>(spilled).ToBigInt(), std::get<2>(spilled).ToBigInt()};
+    Track(pqt);
+    return pqt;
+  }
+
+  /// Release the memory of `x`
+  void Free(BigInt& x) {
+    tracker_.Release(BytesOf(x));
+    x = BigInt{};
+  }
+
+  /// Run `func` that returns a product of about `expected_bytes` bytes, counting the product while it is formed
+  template <typename F>
+  BigInt Produce(uint64_t expected_bytes, F func) {
+    tracker_.Add(expected_bytes);
+    auto ans = func();
+    tracker_.Add(BytesOf(ans));
+    tracker_.Release(expected_bytes);
+    return ans;
+  }
+
+  PQT Node(uint64_t n1, uint64_t n2, bool need_p) {
+    if (checkpoint_ == nullptr || SubtreeBits(n1, n2) < checkpoint_min_bits_) {
+      return ComputeNode(n1, n2, need_p);
+    }
+
+    const auto name = SubtreeCheckpointName(series_, n1, n2, need_p);
+    if (auto loaded = checkpoint_->Load<BigInt, BigInt, BigInt>(name)) {
+      loaded_subtrees_.fetch_add(1, std::memory_order_relaxed);
+      Track(*loaded);
+      return std::move(*loaded);
+    }
+
+    auto pqt = ComputeNode(n1, n2, need_p);
+    checkpoint_->Save(name, std::get<0>(pqt), std::get<1>(pqt), std::get<2>(pqt));
+    return pqt;
+  }
+
+  PQT ComputeNode(uint64_t n1, uint64_t n2, bool need_p) {
+    if (FitsInLeafBlock(series_, n1, n2)) {
+      auto pqt = ComputeLeafBlock(series_, n1, n2);
+      if (!need_p) {
+        std::get<0>(pqt) = BigInt{};
+      }
+      Track(pqt);
+      return pqt;
+    }
+
+    const auto parallel = pool_.Concurrency() > 1 && SubtreeBits(n1, n2) >= cutoff_bits_;
+    const auto m = parallel ? SplitByBitSize(series_, n1, n2) : (n1 + n2) / 2;
+
+    // The left result is spilled while the right subtree is computed, which is where the schedule peaks
+    PQT left;
+    PQT right;
+    std::optional<SpilledPQT> spilled_left;
+    const auto right_bytes = EstimateSubtreePeakBytes(series_, m, n2);
+    if (parallel && tracker_.TryReserve(right_bytes)) {
+      auto right_task = pool_.Submit([this, m, n2, need_p] { return Node(m, n2, need_p); });
+      left = Node(n1, m, true);
+      if (ShouldSpill(n1, m) && !right_task.IsReady()) {
+        spilled_left.emplace(Spill(left));
+      }
+      right = right_task.Get();
+      tracker_.Unreserve(right_bytes);
+    } else {
+      if (parallel) {
+        deferred_tasks_.fetch_add(1, std::memory_order_relaxed);
+      }
+      left = Node(n1, m, true);
+      if (ShouldSpill(n1, m)) {
+        spilled_left.emplace(Spill(left));
+      }
+      right = Node(m, n2, need_p);
+    }
+
+    if (spilled_left) {
+      if (!tracker_.Fits(MergeBytes(*spilled_left, right))) {
+        return MergeOutOfCore(*spilled_left, Spill(right), need_p);
+      }
+      left = Restore(*spilled_left);
+    }
+    return Merge(std::move(left), std::move(right), need_p, parallel);
+  }
+
+  /// An estimate of the bytes that a merge in memory adds: the restored left inputs and the outputs, which are about
+  /// as large as the inputs
+  static uint64_t MergeBytes(const SpilledPQT& left, const PQT& right) {
+    uint64_t left_bytes = 0;
+    for (const auto* x : {&std::get<0>(left), &std::get<1>(left), &std::get<2>(left)}) {
+      left_bytes += x->abs.size() * sizeof(uint64_t);
+    }
+    return 2 * left_bytes + BytesOf(std::get<0>(right)) + BytesOf(std::get<1>(right)) + BytesOf(std::get<2>(right));
+  }
+
+  /// Multiply integers on disk by the out-of-core SSA and load the product
+  static BigInt MultiplyOnDisk(const DiskBigInt& lhs, const DiskBigInt& rhs) {
+    if (lhs.abs.NumberOfBits() == 0 || rhs.abs.NumberOfBits() == 0) {
+      return BigInt{};
+    }
+    return BigInt{MultiplyOutOfCore(lhs.abs, rhs.abs).ToBigUint(), lhs.sign ^ rhs.sign};
+  }
+
+  /// Merge the results on disk. Only the outputs are in memory.
+  PQT MergeOutOfCore(const SpilledPQT& left, const SpilledPQT& right, bool need_p) {
+    const auto& [p1, q1, t1] = left;
+    const auto& [p2, q2, t2] = right;
+    out_of_core_merges_.fetch_add(1, std::memory_order_relaxed);
+
+    auto t = MultiplyOnDisk(t1, q2);
+    t += MultiplyOnDisk(t2, p1);
+    tracker_.Add(BytesOf(t));
+
+    BigInt p;
+    if (need_p) {
+      p = MultiplyOnDisk(p1, p2);
+      tracker_.Add(BytesOf(p));
+    }
+
+    auto q = MultiplyOnDisk(q1, q2);
+    tracker_.Add(BytesOf(q));
+    return {std::move(p), std::move(q), std::move(t)};
+  }
+
+  PQT Merge(PQT left, PQT right, bool need_p, bool parallel) {
+    auto& [p1, q1, t1] = left;
+    auto& [p2, q2, t2] = right;
+
+    // Q does not depend on T and P, so it may be formed in another task while T is formed
+    const auto q_bytes = BytesOf(q1) + BytesOf(q2);
+    std::optional<Task<BigInt>> q_task;
+    if (parallel && tracker_.TryReserve(q_bytes)) {
+      q_task.emplace(pool_.Submit([this, &q1, &q2, q_bytes] {
+        return Produce(q_bytes, [&] { return Multiply(q1, q2); });
+      }));
+    } else if (parallel) {
+      deferred_tasks_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    auto t = Produce(std::max(BytesOf(t1) + BytesOf(q2), BytesOf(t2) + BytesOf(p1)),
+                     [&] { return Evaluate(Lazy(t1) * Lazy(q2) + Lazy(t2) * Lazy(p1)); });
+    Free(t1);
+    Free(t2);
+
+    BigInt p;
+    if (need_p) {
+      p = Produce(BytesOf(p1) + BytesOf(p2), [&] { return Multiply(p1, p2); });
+    }
+    Free(p1);
+    Free(p2);
+
+    BigInt q;
+    if (q_task) {
+      q = q_task->Get();
+      tracker_.Unreserve(q_bytes);
+    } else {
+      q = Produce(q_bytes, [&] { return Multiply(q1, q2); });
+    }
+    Free(q1);
+    Free(q2);
+
+    return {std::move(p), std::move(q), std::move(t)};
+  }
+
+  const S& series_;
+  ThreadPool& pool_;
+  MemoryTracker tracker_;
+  const double cutoff_bits_;
+  std::atomic<uint64_t> deferred_tasks_{0};
+  const Checkpoint* checkpoint_{nullptr};
+  double checkpoint_min_bits_{kCheckpointMinBits};
+  std::atomic<uint64_t> loaded_subtrees_{0};
+  const ScratchDirectory* scratch_{nullptr};
+  double spill_min_bits_{kSpillMinBits};
+  std::atomic<uint64_t> spilled_subtrees_{0};
+  std::atomic<uint64_t> out_of_core_merges_{0};
+};
+
+/// The run-time part of `ComputeSeriesRange()`. `SeriesDriver` cannot be a variable of a constexpr function.
+template <HypergeometricSeries S>
+std::tuple<BigInt, BigInt, BigInt> ComputeSeriesRangeByDriver(const S& series,
+                                                              uint64_t n1,
+                                                              uint64_t n2,
+                                                              bool need_p,
+                                                              const SeriesOptions& options,
+                                                              SeriesReport* report,
+                                                              const Checkpoint* checkpoint) {
+  SeriesDriver driver{series, ThreadPool::Default(), options.memory_budget_bytes};
+  if (checkpoint != nullptr) {
+    driver.SetCheckpoint(*checkpoint);
+  }
+  std::optional<ScratchDirectory> scratch;
+  if (!options.spill_directory.empty()) {
+    scratch.emplace(options.spill_directory);
+    driver.SetSpill(*scratch);
+  }
+
+  auto pqt = driver.ComputeRange(n1, n2, need_p);
+  if (report != nullptr) {
+    report->peak_bytes = driver.PeakBytes();
+    report->deferred_tasks = driver.DeferredTasks();
+    report->loaded_subtrees = driver.LoadedSubtrees();
+    report->spilled_subtrees = driver.SpilledSubtrees();
+    report->out_of_core_merges = driver.OutOfCoreMerges();
+  }
+  return pqt;
+}
+}  // namespace detail
+
+/**
+ * @brief Compute P(n1, n2), Q(n1, n2) and T(n1, n2) of `series`
+ * @param need_p Whether P is needed. If not, P may be returned as zero.
+ * @param report If not null, the statistics of `SeriesDriver` are stored
+ * @param checkpoint If not null, the subtrees are saved to and loaded from it
+ *
+ * At run time, the tree is computed by `SeriesDriver`. In constant evaluation or without the default pool (see
+ * `ThreadPool::DisableDefault()`), the tree is computed by `ComputePQT()`.
+ * With `options.remove_common_factors`, the tree is computed serially by `ComputeFactoredPQT()`, and P, Q and T are
+ * divided by a common factor, which does not change the sum.
+ */
+template <HypergeometricSeries S>
+constexpr std::tuple<BigInt, BigInt, BigInt> ComputeSeriesRange(const S& series,
+                                                                uint64_t n1,
+                                                                uint64_t n2,
+                                                                bool need_p,
+                                                                const SeriesOptions& options = {},
+                                                                SeriesReport* report = nullptr,
+                                                                const Checkpoint* checkpoint = nullptr) {
+  if (options.remove_common_factors) {
+    const PrimeSieve sieve{series.SieveLimit(n2)};
+    auto pqt = detail::ComputeFactoredPQT(series, n1, n2, sieve);
+    return {std::move(pqt.p), std::move(pqt.q), std::move(pqt.t)};
+  }
+
+  if (!std::is_constant_evaluated() && !ThreadPool::IsDefaultDisabled()) {
+    return detail::ComputeSeriesRangeByDriver(series, n1, n2, need_p, options, report, checkpoint);
+  }
+
+  return detail::ComputePQT(series, n1, n2);
+}
+
+/**
+ * @brief Compute the sum a(0) + T(0, n) / Q(0, n) of `series` with `frac_bits` fractional bits
+ * @param scale_num The numerator of a small factor that the sum is multiplied by
+ * @param scale_den The denominator of the factor
+ *
+ * The number of terms is `series.TermsFor(frac_bits + 1)`, so the truncation error is below a half ulp. The error of
+ * the division is a few ulps.
+ */
+template <HypergeometricSeries S>
+constexpr BigFixed ComputeSeriesSum(const S& series,
+                                    uint64_t frac_bits,
+                                    uint64_t scale_num = 1,
+                                    uint64_t scale_den = 1,
+                                    const SeriesOptions& options = {}) {
+  const auto terms = series.TermsFor(frac_bits + 1);
+  const auto [p, q, t] = ComputeSeriesRange(series, 0, terms, false, options);
+
+  const auto first_term = series.Term(0);
+  BigInt a0{1};
+  for (const auto factor : first_term.a) {
+    a0 = Evaluate(Lazy(a0) * factor);
+  }
+  if (first_term.a_sign == Sign::kNegative) {
+    a0 = -a0;
+  }
+
+  const auto numerator = Evaluate((Lazy(q) * Lazy(a0) + Lazy(t)) * scale_num);
+  const auto denominator = Evaluate(Lazy(q) * scale_den);
+  return Divide(numerator, denominator, frac_bits);
+}
+
+// <Incremental Extension>
+/**
+ * @brief P(0, terms), Q(0, terms) and T(0, terms) of a computed series
+ *
+ * Binary splitting composes: (P, Q, T)(0, n2) is the merge of (P, Q, T)(0, n1) and (P, Q, T)(n1, n2). A prefix keeps P
+ * so that it can be merged with the next range. The default value is the empty series.
+ */
+struct SeriesPrefix {
+  uint64_t terms{0};
+  BigInt p{1};
+  BigInt q{1};
+  BigInt t{};
+};
+
+/**
+ * @brief Extend `prefix` of `series` to `terms` terms
+ *
+ * Only the terms in (prefix.terms, terms] are computed, and they are merged into the prefix. A prefix that already has
+ * `terms` terms or more is returned as is, because more terms only make the series more accurate.
+ */
+template <HypergeometricSeries S>
+constexpr SeriesPrefix ExtendSeries(const S& series,
+                                    SeriesPrefix prefix,
+                                    uint64_t terms,
+                                    const SeriesOptions& options = {}) {
+  if (terms <= prefix.terms) {
+    return prefix;
+  }
+
+  auto [p2, q2, t2] = ComputeSeriesRange(series, prefix.terms, terms, true, options);
+
+  SeriesPrefix ans;
+  ans.terms = terms;
+  ans.t = Evaluate(Lazy(prefix.t) * Lazy(q2) + Lazy(t2) * Lazy(prefix.p));
+  ans.p = Multiply(prefix.p, p2);
+  ans.q = Multiply(prefix.q, q2);
+  return ans;
+}
+
+/// Save `prefix` to the entry `name` of `checkpoint`
+inline void SaveSeriesPrefix(const Checkpoint& checkpoint, const std::string& name, const SeriesPrefix& prefix) {
+  checkpoint.Save(name, BigUint{prefix.terms}, prefix.p, prefix.q, prefix.t);
+}
+
+/// Load the prefix saved by `SaveSeriesPrefix()`. It returns `std::nullopt` if the entry is missing or broken.
+inline std::optional<SeriesPrefix> LoadSeriesPrefix(const Checkpoint& checkpoint, const std::string& name) {
+  auto loaded = checkpoint.Load<BigUint, BigInt, BigInt, BigInt>(name);
+  if (!loaded) {
+    return std::nullopt;
+  }
+
+  auto& [terms, p, q, t] = *loaded;
+  return SeriesPrefix{static_cast<uint64_t>(terms), std::move(p), std::move(q), std::move(t)};
+}
+// </Incremental Extension>
+}  // namespace komori
+
+#endif  // KOMORI_HYPERGEOMETRIC_HPP_
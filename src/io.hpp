@@ -1,13 +1,188 @@
 #ifndef KOMORI_IO_HPP_
 #define KOMORI_IO_HPP_
 
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
 #include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include "bigfloat.hpp"
 #include "biguint.hpp"
+#include "digit_sink.hpp"
+#include "planner.hpp"
+#include "ssa.hpp"
+#include "thread_pool.hpp"
 
 namespace komori {
+/**
+ * @brief Powers of ten shared by radix conversions
+ *
+ * 10^n = 5^n 2^n, so only 5^n, which has 30% fewer bits, is computed and 10^n is formed by a shift. 5^n is the square
+ * of 5^floor(n/2) (times 5 if n is odd), and every power is memoized. The lengths of a conversion tree are halved
+ * level by level, so the tree needs O(log n) powers, which reuse each other and the powers of earlier conversions.
+ *
+ * The powers are returned by reference and never move, so the largest ones are not copied. At run time, the mutex
+ * guards only the list of the entries. Each power is computed by the first thread that asks for it without the lock,
+ * and the other threads wait for that entry only.
+ */
+class PowerTable {
+ public:
+  /// The table shared by the conversions at run time. It keeps the powers until `Clear()`.
+  static PowerTable& Shared() {
+    static PowerTable table;
+    return table;
+  }
+
+  constexpr PowerTable() {
+    uint64_t value = 1;
+    for (auto& power : small_pow5_) {
+      power = BigUint{value};
+      value *= 5;
+    }
+  }
+
+  PowerTable(const PowerTable&) = delete;
+  PowerTable(PowerTable&&) = delete;
+  PowerTable& operator=(const PowerTable&) = delete;
+  PowerTable& operator=(PowerTable&&) = delete;
+  constexpr ~PowerTable() { DeleteEntries(); }
+
+  /// 5^n, which is valid until `Clear()` or the destruction of the table
+  constexpr const BigUint& Pow5(uint64_t n) {
+    if (n <= kMaxLimbIndex) {
+      return small_pow5_[n];
+    }
+    if (std::is_constant_evaluated()) {
+      auto* entry = Find(n);
+      if (entry == nullptr) {
+        entry = new Entry{n, ComputePow5(n)};
+        entries_.push_back(entry);
+      }
+      return entry->value;
+    }
+    return Pow5Concurrently(n);
+  }
+
+  /// 10^n
+  constexpr BigUint Pow10(uint64_t n) { return Pow5(n) << n; }
+
+  /// The number of memoized powers
+  constexpr std::size_t Size() const noexcept { return entries_.size(); }
+
+  /// Forget the memoized powers. No reference returned by `Pow5()` may be in use.
+  void Clear() {
+    const std::lock_guard lock{Mutex()};
+    DeleteEntries();
+  }
+
+ private:
+  /// The largest n such that 5^n fits in a limb
+  static constexpr uint64_t kMaxLimbIndex = 27;
+
+  /// A memoized power. `state` is used only at run time.
+  struct Entry {
+    static constexpr int kEmpty = 0;
+    static constexpr int kComputing = 1;
+    static constexpr int kReady = 2;
+
+    uint64_t n;
+    BigUint value;
+    std::atomic<int> state{kEmpty};
+  };
+
+  static std::mutex& Mutex() {
+    static std::mutex mutex;
+    return mutex;
+  }
+
+  /// The entry of 5^n, or null if it is not memoized
+  constexpr Entry* Find(uint64_t n) const noexcept {
+    for (auto* entry : entries_) {
+      if (entry->n == n) {
+        return entry;
+      }
+    }
+    return nullptr;
+  }
+
+  /// 5^n for n > `kMaxLimbIndex`, where 5^floor(n/2) is memoized
+  constexpr BigUint ComputePow5(uint64_t n) {
+    const auto& half = Pow5(n / 2);
+    auto ans = Multiply(half, half);
+    if (n % 2 == 1) {
+      ans *= BigUint{5};
+    }
+    return ans;
+  }
+
+  /**
+   * @brief `Pow5()` at run time
+   *
+   * The thread that moves the entry from empty to computing computes the power. If it throws, the entry becomes empty
+   * again, and one of the waiting threads retries.
+   */
+  const BigUint& Pow5Concurrently(uint64_t n) {
+    Entry* entry = nullptr;
+    {
+      const std::lock_guard lock{Mutex()};
+      entry = Find(n);
+      if (entry == nullptr) {
+        entry = new Entry{n, BigUint{}};
+        entries_.push_back(entry);
+      }
+    }
+
+    for (;;) {
+      auto state = entry->state.load(std::memory_order_acquire);
+      if (state == Entry::kReady) {
+        return entry->value;
+      }
+
+      if (state == Entry::kEmpty) {
+        if (!entry->state.compare_exchange_strong(state, Entry::kComputing, std::memory_order_acquire)) {
+          continue;
+        }
+
+        try {
+          entry->value = ComputePow5(n);
+        } catch (...) {
+          entry->state.store(Entry::kEmpty, std::memory_order_release);
+          entry->state.notify_all();
+          throw;
+        }
+        entry->state.store(Entry::kReady, std::memory_order_release);
+        entry->state.notify_all();
+        return entry->value;
+      }
+
+      entry->state.wait(Entry::kComputing, std::memory_order_acquire);
+    }
+  }
+
+  constexpr void DeleteEntries() noexcept {
+    for (auto* entry : entries_) {
+      delete entry;
+    }
+    entries_.clear();
+  }
+
+  std::array<BigUint, kMaxLimbIndex + 1> small_pow5_;
+  std::vector<Entry*> entries_;
+};
+
 namespace detail {
+/// The shared table at run time, or `local` in constant evaluation, which cannot use the shared one
+constexpr inline PowerTable& SelectPowerTable(PowerTable& local) {
+  if (std::is_constant_evaluated()) {
+    return local;
+  }
+  return PowerTable::Shared();
+}
+
 inline constexpr std::string MakePaddedString(uint64_t value, int64_t len) {
   std::string ans(len, '0');
 
@@ -20,53 +195,268 @@ inline constexpr std::string MakePaddedString(uint64_t value, int64_t len) {
   return ans;
 }
 
-inline constexpr BigUint Make10Pow(uint64_t n) {
-  return BigUint{10}.Pow(n);
+/// 10^n for n <= 19
+constexpr inline uint64_t Pow10Limb(uint64_t n) noexcept {
+  uint64_t ans = 1;
+  for (uint64_t i = 0; i < n; ++i) {
+    ans *= 10;
+  }
+  return ans;
 }
 
-inline constexpr int64_t Log10Int(const BigUint& num) {
+/**
+ * @brief floor(log10(num))
+ *
+ * num is in [2^(b-1), 2^b) for its bit length b, so the answer is floor((b - 1) log10(2)) or one more. The floor is
+ * computed with log10(2) in 64-bit fixed point, and one comparison with a power of ten decides between the two.
+ */
+inline constexpr int64_t Log10Int(const BigUint& num, PowerTable& table) {
   if (num.IsZero()) {
     throw std::out_of_range("The number must be greater than 0");
   }
 
-  int64_t r = 1;
-  while (Make10Pow(r) <= num) {
-    r *= 2;
+  // floor(log10(2) 2^64)
+  constexpr uint128_t kLog10Of2 = 0x4d10'4d42'7de7'fbccULL;
+  const auto estimate = static_cast<uint64_t>((uint128_t{num.NumberOfBits() - 1} * kLog10Of2) >> 64);
+  return static_cast<int64_t>(table.Pow10(estimate + 1) <= num ? estimate + 1 : estimate);
+}
+
+inline constexpr int64_t Log10Int(const BigUint& num) {
+  PowerTable local;
+  return Log10Int(num, SelectPowerTable(local));
+}
+
+/// The number of digits up to which a node of `ScaledRemainderTree` is converted directly
+inline constexpr uint64_t kConversionLeafDigits = 19;
+/// The number of guard bits of the fractions of `ScaledRemainderTree`
+inline constexpr uint64_t kConversionGuardBits = 56;
+/// The minimum number of digits of a node of `ScaledRemainderTree` to convert its halves in parallel
+inline constexpr uint64_t kParallelConversionDigits = uint64_t{1} << 16;
+
+/// The pool to convert `digit_len` digits in parallel, or null to convert them serially
+constexpr inline ThreadPool* ConversionThreadPool(uint64_t digit_len) {
+  return MultiplyThreadPool(digit_len, kParallelConversionDigits);
+}
+
+/// The number of fractional bits of a node of `digit_len` digits in `ScaledRemainderTree`
+constexpr inline uint64_t ConversionFracBits(uint64_t digit_len) {
+  return static_cast<uint64_t>(static_cast<double>(digit_len) * kLog2Of10) + 1 + kConversionGuardBits;
+}
+
+/// floor(2^(128 + shift) / divisor) for divisor in [2^127, 2^128). The quotient must fit in 128 bits.
+constexpr inline uint128_t InverseOf128(uint128_t divisor, uint64_t shift) noexcept {
+  uint128_t quotient = 0;
+  uint128_t remainder = 1;
+  for (uint64_t i = 0; i < 128 + shift; ++i) {
+    // The remainder is less than the divisor, so the doubled one may carry out only if it exceeds the divisor
+    const bool carry = (remainder >> 127) != 0;
+    remainder <<= 1;
+    quotient <<= 1;
+    if (carry || remainder >= divisor) {
+      remainder -= divisor;
+      quotient |= 1;
+    }
   }
+  return quotient;
+}
 
-  int64_t l = r / 2;
-  while (r - l > 1) {
-    const auto m = (l + r) / 2;
-    if (Make10Pow(m) <= num) {
-      l = m;
-    } else {
-      r = m;
+/**
+ * @brief Binary-to-decimal conversion by a scaled remainder tree
+ *
+ * A node of d digits holds a fraction y = Y / 2^q with q = `ConversionFracBits(d)`, which approximates (X + 1/2) / 10^d
+ * for the d-digit integer X of the node, so that floor(y 10^d) = X. The node splits y 10^h = U + f for its upper h
+ * digits U. The lower child takes f truncated to its own precision, and the upper child takes
+ * (U + 1/2) / 10^h = y + (1/2 - f) / 10^h, whose correction is below 10^(-h) / 2 and needs only a 128-bit
+ * approximation of 10^(-h). Thus each node works at the precision of its own digits with one short product, and the
+ * errors stay far below the margin of 1/2 in the last digit of every node.
+ *
+ * The halves of a node depend only on its split, so with a thread pool, the upper halves of the nodes of at least
+ * `kParallelConversionDigits` digits are converted in tasks of the pool at run time. Every node writes its digits
+ * directly to its own range of the output, so no partial strings are returned and concatenated.
+ */
+class ScaledRemainderTree {
+ public:
+  explicit constexpr ScaledRemainderTree(PowerTable& table, ThreadPool* pool = nullptr)
+      : table_{table}, pool_{pool} {}
+
+  /**
+   * @brief Write the first `digit_len` digits of frac / 2^frac_bits (< 1) to `out[offset...]` exactly
+   *
+   * frac / 2^frac_bits is exact, so the root is centered like an upper child: (X + 1/2) / 10^d = y + (1/2 - f) / 10^d
+   * for y 10^d = X + f. The digits are the exact truncation, as those of the exact radix conversion.
+   *
+   * @pre frac < 2^frac_bits and digit_len <= frac_bits
+   */
+  constexpr void ConvertFraction(const BigUint& frac,
+                                 uint64_t frac_bits,
+                                 uint64_t digit_len,
+                                 std::string& out,
+                                 std::size_t offset) {
+    if (digit_len == 0) {
+      return;
     }
+    Convert(CenterFraction(frac, frac_bits, digit_len), digit_len, out, offset);
   }
 
-  return l;
-}
+  /// Write the `digit_len` digits of floor(y 10^digit_len / 2^q) to `out[offset...]`, q = `ConversionFracBits()`
+  constexpr void Convert(const BigUint& y, uint64_t digit_len, std::string& out, std::size_t offset) {
+    const auto q = ConversionFracBits(digit_len);
+    if (digit_len <= kConversionLeafDigits) {
+      auto value = static_cast<uint64_t>((y * BigUint{Pow10Limb(digit_len)}) >> q);
+      for (auto i = digit_len; i > 0; --i) {
+        out[offset + i - 1] = static_cast<char>('0' + value % 10);
+        value /= 10;
+      }
+      return;
+    }
 
-constexpr inline std::string FractionalPartToString(BigFloat num, int64_t digit_len) {
-  const auto orig_precision = num.GetPrecision();
+    const auto upper_len = digit_len / 2;
+    const auto lower_len = digit_len - upper_len;
+    const auto [upper_y, lower_y] = Split(y, digit_len);
 
-  if (digit_len <= 0) {
-    return std::string{};
-  } else if (digit_len <= 19) {
-    num *= BigFloat(orig_precision, BigInt{Make10Pow(digit_len)});
-    const auto value = static_cast<uint64_t>(num.IntegerPart().Abs());
+    if (!std::is_constant_evaluated() && pool_ != nullptr && digit_len >= kParallelConversionDigits) {
+      ConvertInParallel(upper_y, upper_len, lower_y, lower_len, out, offset);
+      return;
+    }
+
+    Convert(upper_y, upper_len, out, offset);
+    Convert(lower_y, lower_len, out, offset + upper_len);
+  }
+
+  /**
+   * @brief Write the digits of `Convert(y, digit_len, ...)` to `sink` in order
+   *
+   * The nodes of more than `block_len` digits are split from the left in this thread. Each subtree of at most
+   * `block_len` digits is converted into `block` by `Convert()`, in parallel with the pool, and written as soon as it
+   * is finished. Thus only one block of digits is held at a time, and the leading digits are written before the
+   * trailing subtrees are converted.
+   */
+  template <DigitSink Sink>
+  void Stream(const BigUint& y, uint64_t digit_len, uint64_t block_len, Sink& sink, std::string& block) {
+    if (digit_len <= block_len) {
+      block.assign(digit_len, '0');
+      Convert(y, digit_len, block, 0);
+      sink.Write(block);
+      return;
+    }
+
+    const auto upper_len = digit_len / 2;
+    const auto [upper_y, lower_y] = Split(y, digit_len);
+    Stream(upper_y, upper_len, block_len, sink, block);
+    Stream(lower_y, digit_len - upper_len, block_len, sink, block);
+  }
 
-    return MakePaddedString(value, digit_len);
+  /// `Stream()` of the first `digit_len` digits of frac / 2^frac_bits. See `ConvertFraction()`.
+  template <DigitSink Sink>
+  void StreamFraction(const BigUint& frac,
+                      uint64_t frac_bits,
+                      uint64_t digit_len,
+                      uint64_t block_len,
+                      Sink& sink,
+                      std::string& block) {
+    if (digit_len == 0) {
+      return;
+    }
+    Stream(CenterFraction(frac, frac_bits, digit_len), digit_len, block_len, sink, block);
   }
 
-  const auto upper_part_len = digit_len / 2;
-  const auto lower_part_len = digit_len - upper_part_len;
+ private:
+  /// The run-time part of `Convert()`. The upper half runs in a task of the pool, and the lower one in this thread.
+  void ConvertInParallel(const BigUint& upper_y,
+                         uint64_t upper_len,
+                         const BigUint& lower_y,
+                         uint64_t lower_len,
+                         std::string& out,
+                         std::size_t offset) {
+    auto upper_task = pool_->Submit([&] { Convert(upper_y, upper_len, out, offset); });
+    Convert(lower_y, lower_len, out, offset + upper_len);
+    upper_task.Get();
+  }
+
+  /// The root of `ConvertFraction()`, (X + 1/2) / 10^d with `ConversionFracBits(d)` bits
+  constexpr BigUint CenterFraction(const BigUint& frac, uint64_t frac_bits, uint64_t digit_len) {
+    const auto q = ConversionFracBits(digit_len);
+    const auto& pow5 = table_.Pow5(digit_len);
+
+    // y 10^d = (frac 5^d) / 2^(frac_bits - d). The fraction has no bits if frac_bits == d.
+    const auto z_frac_bits = frac_bits - digit_len;
+    const auto z = Multiply(frac, pow5);
+    uint64_t f = 0;
+    if (z_frac_bits >= 64) {
+      f = static_cast<uint64_t>(z.ShiftMod2Pow(z_frac_bits - 64, 64));
+    } else if (z_frac_bits > 0) {
+      f = static_cast<uint64_t>(z.ShiftMod2Pow(0, z_frac_bits)) << (64 - z_frac_bits);
+    }
+
+    const auto y = q >= frac_bits ? frac << (q - frac_bits) : frac >> (frac_bits - q);
+    return UpperFraction(y, f, q, digit_len, pow5);
+  }
+
+  /// The fractions of the upper and the lower children of a node of `digit_len` digits
+  constexpr std::pair<BigUint, BigUint> Split(const BigUint& y, uint64_t digit_len) {
+    const auto q = ConversionFracBits(digit_len);
+    const auto upper_len = digit_len / 2;
+    const auto lower_q = ConversionFracBits(digit_len - upper_len);
+    const auto& pow5 = table_.Pow5(upper_len);
+
+    // y 10^h = (y 5^h) 2^h, so the fraction of y 10^h is read from the bits of z = y 5^h below 2^(q - h)
+    const auto z = Multiply(y, pow5);
+    auto lower_y = z.ShiftMod2Pow(q - upper_len - lower_q, lower_q);
+    const auto f = static_cast<uint64_t>(z.ShiftMod2Pow(q - upper_len - 64, 64));
+    return {UpperFraction(y, f, q, upper_len, pow5), std::move(lower_y)};
+  }
 
-  auto upper_part_str = FractionalPartToString(num, upper_part_len);
-  num *= BigFloat(orig_precision, BigInt{Make10Pow(upper_part_len)});
-  auto lower_part_str = FractionalPartToString(num.FractionalPart(), lower_part_len);
+  /**
+   * @brief (U + 1/2) / 10^h with `ConversionFracBits(h)` bits, where y 10^h = U + f
+   * @param f The leading 64 bits of the fraction f
+   * @param pow5 5^h
+   */
+  static constexpr BigUint UpperFraction(const BigUint& y, uint64_t f, uint64_t q, uint64_t h, const BigUint& pow5) {
+    const auto upper_q = ConversionFracBits(h);
+    auto ans = y >> (q - upper_q);
 
-  return std::move(upper_part_str) + std::move(lower_part_str);
+    // c = 2^upper_q / 10^h < 2^(kConversionGuardBits + 2) from the leading 128 bits of 10^h, which are those of 5^h
+    const auto bits = pow5.NumberOfBits();
+    const auto top = bits >= 128 ? pow5 >> (bits - 128) : pow5 << (128 - bits);
+    const auto c = static_cast<uint64_t>(InverseOf128((uint128_t{top[1]} << 64) | top[0], upper_q - bits - h));
+
+    // (1/2 - f) c
+    constexpr auto kHalf = uint64_t{1} << 63;
+    if (f < kHalf) {
+      const auto correction = (uint128_t{kHalf - f} * c) >> 64;
+      ans += BigUint{static_cast<uint64_t>(correction), static_cast<uint64_t>(correction >> 64)};
+    } else {
+      const auto correction = (uint128_t{f - kHalf} * c) >> 64;
+      ans -= BigUint{static_cast<uint64_t>(correction), static_cast<uint64_t>(correction >> 64)};
+    }
+    return ans;
+  }
+
+  PowerTable& table_;
+  ThreadPool* pool_;
+};
+
+/// The first `digit_len` digits after the decimal point of `num` in [0, 1)
+constexpr inline std::string FractionalPartToString(const BigFloat& num, int64_t digit_len) {
+  if (digit_len <= 0) {
+    return std::string{};
+  }
+
+  const auto len = static_cast<uint64_t>(digit_len);
+  const auto q = ConversionFracBits(len);
+  std::string ans(len, '0');
+  PowerTable local;
+  const auto frac = (num << static_cast<int64_t>(q)).IntegerPart().Abs();
+  ScaledRemainderTree{SelectPowerTable(local), ConversionThreadPool(len)}.ConvertFraction(frac, q, len, ans, 0);
+  return ans;
+}
+
+/// `ScaledRemainderTree::StreamFraction()` with blocks of the chunk size of `sink`
+template <DigitSink Sink>
+void StreamFractionDigits(ChunkedDigitSink<Sink>& sink, const BigUint& frac, uint64_t frac_bits, uint64_t digit_len) {
+  std::string block;
+  ScaledRemainderTree tree{PowerTable::Shared(), ConversionThreadPool(digit_len)};
+  tree.StreamFraction(frac, frac_bits, digit_len, sink.ChunkSize(), sink, block);
 }
 }  // namespace detail
 
@@ -75,16 +465,20 @@ inline constexpr std::string ToString(const BigUint& num) {
     return std::string{"0"};
   }
 
-  const auto digit_len = detail::Log10Int(num) + 1;
-  const auto number_of_bits = num.NumberOfBits();
+  PowerTable local;
+  auto& table = detail::SelectPowerTable(local);
+  const auto digit_len = static_cast<uint64_t>(detail::Log10Int(num, table) + 1);
+  const auto q = detail::ConversionFracBits(digit_len);
 
-  BigFloat b = BigFloat(number_of_bits + 10, BigInt{detail::Make10Pow(digit_len)});
-  BigFloat inv_b = Inverse(b);
-  BigFloat f = BigFloat(number_of_bits + 10, BigInt{num}) * inv_b;
-  // Add `inv_b / 2` to round the result
-  f = std::move(f) + (inv_b >> 2);
+  // The root holds (num + 1/2) / 10^digit_len. See `detail::ScaledRemainderTree`.
+  const auto precision = static_cast<int64_t>(q + 64);
+  const auto numerator = BigFloat(precision, BigInt{(num << 1) + BigUint{1}});
+  const auto pow10 = BigFloat(precision, BigInt{table.Pow5(digit_len)}) << static_cast<int64_t>(digit_len);
+  const auto y = ((numerator / pow10) << static_cast<int64_t>(q - 1)).IntegerPart().Abs();
 
-  return detail::FractionalPartToString(std::move(f), digit_len);
+  std::string ans(digit_len, '0');
+  detail::ScaledRemainderTree{table, detail::ConversionThreadPool(digit_len)}.Convert(y, digit_len, ans, 0);
+  return ans;
 }
 
 inline constexpr std::string ToString(const BigInt& num) {
@@ -106,6 +500,48 @@ inline constexpr std::string ToString(const BigFloat& num) {
 
   return std::move(integer_part_str) + "." + std::move(fractional_part_str);
 }
+
+// <Streaming Output>
+/**
+ * @brief Write the first `digit_len` digits of frac / 2^frac_bits (< 1) to `sink` in chunks of `chunk_size` digits
+ *
+ * The digits are those of `detail::ScaledRemainderTree::ConvertFraction()`. They are written in order as the leftmost
+ * subtrees are finished, and at most a block and a chunk of `chunk_size` digits are held at a time.
+ *
+ * @pre frac < 2^frac_bits and digit_len <= frac_bits
+ */
+template <DigitSink Sink>
+void WriteFractionDigits(Sink& sink,
+                         const BigUint& frac,
+                         uint64_t frac_bits,
+                         uint64_t digit_len,
+                         std::size_t chunk_size = kDigitChunkSize) {
+  ChunkedDigitSink chunked{sink, chunk_size};
+  detail::StreamFractionDigits(chunked, frac, frac_bits, digit_len);
+  chunked.Flush();
+}
+
+/// Write `ToString(num)` to `sink` in chunks of `chunk_size` characters without holding the whole string
+template <DigitSink Sink>
+void WriteString(Sink& sink, const BigFloat& num, std::size_t chunk_size = kDigitChunkSize) {
+  constexpr double log2_10 = 3.321928094887362;
+
+  const auto fractional_part = num.FractionalPart();
+  const auto frac_precision = fractional_part.GetFractionalPartPrecision();
+  const auto digit_len = static_cast<int64_t>(static_cast<double>(frac_precision) / log2_10);
+
+  ChunkedDigitSink chunked{sink, chunk_size};
+  chunked.Write(ToString(num.IntegerPart()));
+  chunked.Write(".");
+  if (digit_len > 0) {
+    const auto len = static_cast<uint64_t>(digit_len);
+    const auto q = detail::ConversionFracBits(len);
+    const auto frac = (fractional_part << static_cast<int64_t>(q)).IntegerPart().Abs();
+    detail::StreamFractionDigits(chunked, frac, q, len);
+  }
+  chunked.Flush();
+}
+// </Streaming Output>
 }  // namespace komori
 
 #endif  // KOMORI_IO_HPP_
\ No newline at end of file
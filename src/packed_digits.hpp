@@ -0,0 +1,295 @@
+#ifndef KOMORI_PACKED_DIGITS_HPP_
+#define KOMORI_PACKED_DIGITS_HPP_
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "io.hpp"
+#include "serialize.hpp"
+
+namespace komori {
+// <Packed Digit File>
+// A packed digit file stores a sequence of decimal digits in little-endian 64-bit words:
+//
+//   header: the magic "KOMORIPD", the version, the digits per word, the digits per block, the number of digits, the
+//           number of blocks, the offset of the index and the checksum of the index
+//   blocks: ceil(n / 19) words for each block of n digits. A word holds 19 digits, the first one in the most
+//           significant place, and the last word of the file is padded with zeros.
+//   index:  the offset, the number of digits and the checksum of each block
+//
+// 10^19 < 2^64, so a digit takes 64 / 19 = 3.37 bits instead of 8 bits of ASCII. Every block but the last has the
+// same number of digits, so the block of a position is found by a division and read without the others.
+
+namespace detail {
+/// "KOMORIPD" in little endian
+inline constexpr uint64_t kPackedDigitsMagic = 0x4450'4952'4f4d'4f4bULL;
+inline constexpr uint64_t kPackedDigitsVersion = 1;
+/// The number of digits in a word of a packed digit file
+inline constexpr uint64_t kPackedWordDigits = 19;
+/// The number of words of the header of a packed digit file
+inline constexpr std::size_t kPackedHeaderWords = 8;
+/// The number of words of an entry of the index of a packed digit file
+inline constexpr std::size_t kPackedIndexWords = 3;
+
+/// The checksum of a block, which covers its number and length so that a misplaced block is detected as well
+inline uint64_t PackedBlockChecksum(uint64_t block, uint64_t digits, const std::vector<uint64_t>& words) {
+  Checksum checksum;
+  checksum.Update(block);
+  checksum.Update(digits);
+  for (const auto word : words) {
+    checksum.Update(word);
+  }
+  return checksum.Get();
+}
+}  // namespace detail
+
+/// The default number of digits in a block of a packed digit file, ~1.2 million digits in 512 KiB
+inline constexpr uint64_t kPackedBlockDigits = detail::kPackedWordDigits << 16;
+
+/**
+ * @brief A sink that packs digits into a packed digit file
+ *
+ * Each block is packed as its digits arrive and written with its checksum, so the writer holds one block at a time.
+ * The index and the header are written by `Close()`, which must be called to complete the file. Only the characters
+ * '0' to '9' are accepted, e.g. from `WriteFractionDigits()`.
+ */
+class PackedDigitWriter {
+ public:
+  /// @pre `block_digits` is a positive multiple of 19
+  explicit PackedDigitWriter(const std::filesystem::path& path, uint64_t block_digits = kPackedBlockDigits)
+      : os_{path, std::ios::binary | std::ios::trunc}, block_digits_{block_digits} {
+    if (block_digits_ == 0 || block_digits_ % detail::kPackedWordDigits != 0) {
+      throw std::invalid_argument("The digits of a block must be a positive multiple of 19");
+    }
+    if (!os_) {
+      throw SerializeError("Failed to open " + path.string());
+    }
+
+    // A placeholder of the header, which is rewritten by `Close()`
+    const std::array<uint64_t, detail::kPackedHeaderWords> header{};
+    detail::WriteWords(os_, header.data(), header.size());
+    words_.reserve(block_digits_ / detail::kPackedWordDigits);
+  }
+
+  PackedDigitWriter(const PackedDigitWriter&) = delete;
+  PackedDigitWriter(PackedDigitWriter&&) = delete;
+  PackedDigitWriter& operator=(const PackedDigitWriter&) = delete;
+  PackedDigitWriter& operator=(PackedDigitWriter&&) = delete;
+
+  ~PackedDigitWriter() {
+    try {
+      Close();
+    } catch (...) {
+    }
+  }
+
+  /// Append `digits`. If any character is not a digit, nothing is appended.
+  void Write(std::string_view digits) {
+    if (std::any_of(digits.begin(), digits.end(), [](char c) { return c < '0' || c > '9'; })) {
+      throw SerializeError("A packed digit file holds only decimal digits");
+    }
+
+    for (const auto c : digits) {
+      word_ = word_ * 10 + static_cast<uint64_t>(c - '0');
+      ++block_digit_count_;
+      if (++word_digits_ == detail::kPackedWordDigits) {
+        words_.push_back(word_);
+        word_ = 0;
+        word_digits_ = 0;
+        if (block_digit_count_ == block_digits_) {
+          FlushBlock();
+        }
+      }
+    }
+  }
+
+  /// Write the last block, the index and the header, and close the file
+  void Close() {
+    if (!os_.is_open()) {
+      return;
+    }
+
+    if (word_digits_ > 0) {
+      words_.push_back(word_ * detail::Pow10Limb(detail::kPackedWordDigits - word_digits_));
+      word_ = 0;
+      word_digits_ = 0;
+    }
+    if (block_digit_count_ > 0) {
+      FlushBlock();
+    }
+
+    const auto index_offset = static_cast<uint64_t>(os_.tellp());
+    detail::WriteWords(os_, index_.data(), index_.size());
+    detail::Checksum checksum;
+    for (const auto word : index_) {
+      checksum.Update(word);
+    }
+
+    const auto num_blocks = index_.size() / detail::kPackedIndexWords;
+    const std::array<uint64_t, detail::kPackedHeaderWords> header{detail::kPackedDigitsMagic,
+                                                                  detail::kPackedDigitsVersion,
+                                                                  detail::kPackedWordDigits,
+                                                                  block_digits_,
+                                                                  total_digits_,
+                                                                  num_blocks,
+                                                                  index_offset,
+                                                                  checksum.Get()};
+    os_.seekp(0);
+    detail::WriteWords(os_, header.data(), header.size());
+    os_.close();
+    if (!os_) {
+      throw SerializeError("Failed to write a packed digit file");
+    }
+  }
+
+ private:
+  /// Write the words of the current block and its entry of the index
+  void FlushBlock() {
+    const auto block = index_.size() / detail::kPackedIndexWords;
+    index_.push_back(static_cast<uint64_t>(os_.tellp()));
+    index_.push_back(block_digit_count_);
+    index_.push_back(detail::PackedBlockChecksum(block, block_digit_count_, words_));
+    detail::WriteWords(os_, words_.data(), words_.size());
+    total_digits_ += block_digit_count_;
+    block_digit_count_ = 0;
+    words_.clear();
+  }
+
+  std::ofstream os_;
+  uint64_t block_digits_;
+  uint64_t total_digits_{0};
+  /// The words and the number of digits of the current block
+  std::vector<uint64_t> words_;
+  uint64_t block_digit_count_{0};
+  /// The current word and its number of digits
+  uint64_t word_{0};
+  uint64_t word_digits_{0};
+  std::vector<uint64_t> index_;
+};
+
+/**
+ * @brief A reader of a packed digit file, which decodes any block without reading the others
+ *
+ * The header and the index are read and verified on construction. A block is verified by its checksum each time it is
+ * read. A reader has its own stream, so it must not be shared by threads, but each thread can open its own reader.
+ */
+class PackedDigitReader {
+ public:
+  explicit PackedDigitReader(const std::filesystem::path& path) : is_{path, std::ios::binary} {
+    if (!is_) {
+      throw SerializeError("Failed to open " + path.string());
+    }
+
+    std::array<uint64_t, detail::kPackedHeaderWords> header{};
+    detail::ReadWords(is_, header.data(), header.size());
+    if (header[0] != detail::kPackedDigitsMagic) {
+      throw SerializeError("Bad magic");
+    }
+    if (header[1] != detail::kPackedDigitsVersion || header[2] != detail::kPackedWordDigits) {
+      throw SerializeError("Unsupported version");
+    }
+    block_digits_ = header[3];
+    total_digits_ = header[4];
+    const auto num_blocks = header[5];
+    const auto index_offset = header[6];
+    // The bounds are checked before the arithmetic, so that a broken header can neither overflow nor allocate a huge
+    // index
+    constexpr uint64_t kHeaderBytes = detail::kPackedHeaderWords * sizeof(uint64_t);
+    constexpr uint64_t kEntryBytes = detail::kPackedIndexWords * sizeof(uint64_t);
+    const auto file_size = static_cast<uint64_t>(std::filesystem::file_size(path));
+    if (block_digits_ == 0 || block_digits_ % detail::kPackedWordDigits != 0 || index_offset < kHeaderBytes ||
+        index_offset > file_size || num_blocks > (file_size - index_offset) / kEntryBytes ||
+        index_offset + num_blocks * kEntryBytes != file_size ||
+        num_blocks != total_digits_ / block_digits_ + (total_digits_ % block_digits_ != 0 ? 1 : 0)) {
+      throw SerializeError("Bad header");
+    }
+
+    is_.seekg(static_cast<std::streamoff>(index_offset));
+    index_.resize(num_blocks * detail::kPackedIndexWords);
+    detail::ReadWords(is_, index_.data(), index_.size());
+    detail::Checksum checksum;
+    for (const auto word : index_) {
+      checksum.Update(word);
+    }
+    if (checksum.Get() != header[7]) {
+      throw SerializeError("Checksum mismatch in the index");
+    }
+  }
+
+  uint64_t TotalDigits() const noexcept { return total_digits_; }
+  uint64_t BlockDigits() const noexcept { return block_digits_; }
+  uint64_t NumBlocks() const noexcept { return index_.size() / detail::kPackedIndexWords; }
+
+  /// Read and decode the `block`-th block
+  std::string ReadBlock(uint64_t block) {
+    if (block >= NumBlocks()) {
+      throw std::out_of_range("The block is out of range");
+    }
+
+    const auto* entry = index_.data() + block * detail::kPackedIndexWords;
+    const auto digits = entry[1];
+    if (digits != std::min(block_digits_, total_digits_ - block * block_digits_)) {
+      throw SerializeError("Bad index");
+    }
+
+    std::vector<uint64_t> words((digits + detail::kPackedWordDigits - 1) / detail::kPackedWordDigits);
+    is_.clear();
+    is_.seekg(static_cast<std::streamoff>(entry[0]));
+    detail::ReadWords(is_, words.data(), words.size());
+    if (detail::PackedBlockChecksum(block, digits, words) != entry[2]) {
+      throw SerializeError("Checksum mismatch in block " + std::to_string(block));
+    }
+
+    std::string ans(words.size() * detail::kPackedWordDigits, '0');
+    for (std::size_t i = 0; i < words.size(); ++i) {
+      if (words[i] >= detail::Pow10Limb(detail::kPackedWordDigits)) {
+        throw SerializeError("Bad word in block " + std::to_string(block));
+      }
+      auto value = words[i];
+      for (auto j = detail::kPackedWordDigits; j > 0; --j) {
+        ans[i * detail::kPackedWordDigits + j - 1] = static_cast<char>('0' + value % 10);
+        value /= 10;
+      }
+    }
+    ans.resize(digits);
+    return ans;
+  }
+
+  /// Read `len` digits from the `pos`-th digit, decoding only the blocks that contain them
+  std::string ReadDigits(uint64_t pos, uint64_t len) {
+    if (pos > total_digits_ || len > total_digits_ - pos) {
+      throw std::out_of_range("The digits are out of range");
+    }
+
+    std::string ans;
+    ans.reserve(len);
+    while (len > 0) {
+      const auto block = pos / block_digits_;
+      const auto offset = pos % block_digits_;
+      const auto digits = ReadBlock(block);
+      const auto count = std::min<uint64_t>(len, digits.size() - offset);
+      ans.append(digits, offset, count);
+      pos += count;
+      len -= count;
+    }
+    return ans;
+  }
+
+ private:
+  std::ifstream is_;
+  uint64_t block_digits_{0};
+  uint64_t total_digits_{0};
+  std::vector<uint64_t> index_;
+};
+// </Packed Digit File>
+}  // namespace komori
+
+#endif  // KOMORI_PACKED_DIGITS_HPP_
@@ -0,0 +1,264 @@
+#ifndef KOMORI_PI_HPP_
+#define KOMORI_PI_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numbers>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+
+#include "bigfixed.hpp"
+#include "bigint.hpp"
+#include "checkpoint.hpp"
+#include "distributed.hpp"
+#include "expr.hpp"
+#include "hypergeometric.hpp"
+#include "planner.hpp"
+
+namespace komori {
+/**
+ * @brief The series of Chudnovsky's formula as a hypergeometric series
+ *
+ * p(k) = (2k - 1)(6k - 5)(6k - 1), q(k) = k^3 C^3 / 24 and a(k) = (-1)^k (A + Bk), so that
+ * pi = C^(3/2) Q / (12 (A Q + T)).
+ *
+ * @pre A + Bk fits in a limb, i.e. k < 2^33
+ */
+struct ChudnovskySeries {
+  constexpr HypergeometricTerm Term(uint64_t k) const {
+    using chudnovsky::kA;
+    using chudnovsky::kB;
+    using chudnovsky::kC3Over24;
+
+    if (k == 0) {
+      return {{}, {}, {kA}, Sign::kPositive};
+    }
+    return {{2 * k - 1, 6 * k - 5, 6 * k - 1},
+            {k, k, k, kC3Over24},
+            {kA + kB * k},
+            (k % 2 == 0) ? Sign::kPositive : Sign::kNegative};
+  }
+
+  /// An estimate of the bit width of Q(0, n) = sum_{k<=n} log2(k^3 C^3 / 24)
+  double EstimateQBits(uint64_t n) const {
+    if (n == 0) {
+      return 0;
+    }
+
+    // sum_{k<=n} log2(k) ~ n log2(n) - n / ln(2)
+    const auto x = static_cast<double>(n);
+    return 3 * (x * std::log2(x) - x / std::numbers::ln2) + x * std::log2(static_cast<double>(chudnovsky::kC3 / 24));
+  }
+
+  /// The prime factors of p(k) and k are at most 6n, and those of C^3 / 24 = 2^15 3^2 5^3 23^3 29^3 at most 29
+  constexpr uint64_t SieveLimit(uint64_t n) const noexcept { return std::max<uint64_t>(6 * n, 29); }
+
+  constexpr uint64_t TermsFor(uint64_t bits) const { return chudnovsky::TermsFor(bits); }
+
+  constexpr std::string_view Name() const noexcept { return "chudnovsky"; }
+};
+
+/**
+ * @brief The worker processes of Chudnovsky's formula
+ *
+ * They are forked by the constructor, so create them before any thread starts, e.g. at the beginning of `main()`, and
+ * pass them to `ComputePi()`. See `DistributedSeries`.
+ */
+using PiWorkers = DistributedSeries<ChudnovskySeries>;
+
+namespace detail {
+/**
+ * @brief The run-time part of `ComputeSeries()` with worker processes
+ * @throw `std::invalid_argument` if `plan` removes common factors, spills or has a memory budget, which the workers
+ *        do not support
+ *
+ * The ranges of the workers are saved to and loaded from `checkpoint`. In `report`, the subtrees loaded from the
+ * checkpoint and the products computed by the workers are counted.
+ */
+inline std::tuple<BigInt, BigInt, BigInt> ComputeSeriesByWorkers(const PiPlan& plan,
+                                                                 PiWorkers& workers,
+                                                                 SeriesReport* report,
+                                                                 const Checkpoint* checkpoint) {
+  if (plan.remove_common_factors || !plan.spill_directory.empty() ||
+      plan.memory_budget_bytes != std::numeric_limits<uint64_t>::max()) {
+    throw std::invalid_argument("Worker processes support neither common-factor removal, spilling nor a memory budget");
+  }
+
+  const auto loaded_ranges = workers.LoadedRanges();
+  const auto remote_products = workers.RemoteProducts();
+  auto pqt = workers.ComputeRange(0, plan.terms, false, checkpoint);
+  if (report != nullptr) {
+    report->loaded_subtrees = workers.LoadedRanges() - loaded_ranges;
+    report->remote_products = workers.RemoteProducts() - remote_products;
+  }
+  return pqt;
+}
+
+/**
+ * @brief Compute Q(0, terms) and T(0, terms) of Chudnovsky's formula
+ * @param plan The number of terms, the memory budget and the mode
+ * @param report If not null, the statistics of `SeriesDriver` are stored
+ * @param workers If not null, the series is computed by them. See `ComputeSeriesByWorkers()`.
+ *
+ * P(0, terms) is not needed and may be returned as zero. Without `workers`, see `ComputeSeriesRange()`.
+ */
+constexpr inline std::tuple<BigInt, BigInt, BigInt> ComputeSeries(const PiPlan& plan,
+                                                                  SeriesReport* report = nullptr,
+                                                                  const Checkpoint* checkpoint = nullptr,
+                                                                  PiWorkers* workers = nullptr) {
+  if (!std::is_constant_evaluated() && workers != nullptr) {
+    return ComputeSeriesByWorkers(plan, *workers, report, checkpoint);
+  }
+
+  const SeriesOptions options{plan.remove_common_factors, plan.memory_budget_bytes, plan.spill_directory};
+  return ComputeSeriesRange(ChudnovskySeries{}, 0, plan.terms, false, options, report, checkpoint);
+}
+
+/// 1 / sqrt(C) with `frac_bits` fractional bits
+constexpr inline BigFixed ComputeInverseSqrtC(uint64_t frac_bits) {
+  return InverseSqrt(BigFixed(frac_bits, BigInt{chudnovsky::kC}));
+}
+
+/// C^(3/2) Q / (12 (A Q + T)) / sqrt(C) = C Q / (12 (A Q + T)) with `frac_bits` fractional bits
+constexpr inline BigFixed ComputePiQuotient(const BigInt& q, const BigInt& t, uint64_t frac_bits) {
+  using chudnovsky::kA;
+  using chudnovsky::kC;
+
+  const auto numerator = Evaluate(Lazy(q) * (kC * kC));
+  const auto denominator = Evaluate((Lazy(q) * kA + Lazy(t)) * 12);
+  return Divide(numerator, denominator, frac_bits);
+}
+
+/**
+ * @brief `ComputePi()` with the checkpoint in `plan.checkpoint_directory`
+ *
+ * The subtrees of the series, the quotient and 1 / sqrt(C) are saved as they are completed, and the saved ones are
+ * loaded instead of being computed again. The names of the entries contain the numbers of terms and bits, so a
+ * directory can be shared by runs with different plans.
+ */
+inline BigFixed ComputePiWithCheckpoint(const PiPlan& plan, SeriesReport* report, PiWorkers* workers) {
+  const Checkpoint checkpoint{plan.checkpoint_directory};
+  const auto suffix = "_" + std::to_string(plan.terms) + "_" + std::to_string(plan.frac_bits);
+
+  const auto quotient_name = "quotient" + suffix;
+  auto quotient = checkpoint.Load<BigFixed>(quotient_name);
+  if (!quotient) {
+    const auto [p, q, t] = ComputeSeries(plan, report, &checkpoint, workers);
+    quotient.emplace(ComputePiQuotient(q, t, plan.frac_bits));
+    checkpoint.Save(quotient_name, std::get<0>(*quotient));
+  }
+
+  const auto inverse_sqrt_c_name = "inverse_sqrt_c_" + std::to_string(plan.frac_bits);
+  auto inverse_sqrt_c = checkpoint.Load<BigFixed>(inverse_sqrt_c_name);
+  if (!inverse_sqrt_c) {
+    inverse_sqrt_c.emplace(ComputeInverseSqrtC(plan.frac_bits));
+    checkpoint.Save(inverse_sqrt_c_name, std::get<0>(*inverse_sqrt_c));
+  }
+
+  return std::get<0>(*quotient) * std::get<0>(*inverse_sqrt_c);
+}
+
+/// `ComputePi()` with or without worker processes
+constexpr inline BigFixed ComputePiBy(const PiPlan& plan, SeriesReport* report, PiWorkers* workers) {
+  if (!std::is_constant_evaluated() && !plan.checkpoint_directory.empty()) {
+    return ComputePiWithCheckpoint(plan, report, workers);
+  }
+
+  auto [p, q, t] = ComputeSeries(plan, report, nullptr, workers);
+  return ComputePiQuotient(q, t, plan.frac_bits) * ComputeInverseSqrtC(plan.frac_bits);
+}
+}  // namespace detail
+
+/**
+ * @brief Compute pi by Chudnovsky's formula
+ * @param plan The numbers of terms and bits. See `MakePiPlan()`.
+ * @param report If not null, the statistics of the series are stored
+ * @return pi with `plan.frac_bits` fractional bits, which is within 2^(-plan.output_bits) of pi
+ */
+constexpr inline BigFixed ComputePi(const PiPlan& plan, SeriesReport* report = nullptr) {
+  return detail::ComputePiBy(plan, report, nullptr);
+}
+
+/**
+ * @brief Compute pi by Chudnovsky's formula with the series computed by `workers`
+ * @throw `std::invalid_argument` if `plan` removes common factors, spills or has a memory budget
+ */
+inline BigFixed ComputePi(const PiPlan& plan, PiWorkers& workers, SeriesReport* report = nullptr) {
+  return detail::ComputePiBy(plan, report, &workers);
+}
+
+/**
+ * @brief Compute pi with `digits` decimal digits after the decimal point
+ *
+ * The result is within a quarter of 10^(-digits) of pi, but its first `digits` digits may be off by one in the last
+ * digit when pi is close to a multiple of 10^(-digits). See `ComputePiForDigits()`.
+ */
+constexpr inline BigFixed ComputePi(uint64_t digits) {
+  return ComputePi(MakePiPlan(digits));
+}
+
+namespace detail {
+/// The number of digits added to the plan when the truncation of pi is ambiguous. It doubles on each retry.
+inline constexpr uint64_t kRetryDigits = 8;
+}  // namespace detail
+
+/**
+ * @brief Compute pi whose first `digits` decimal digits after the decimal point are exactly those of pi
+ *
+ * Pi is computed again with more digits while its truncation is ambiguous within the error bound of the plan. See
+ * `IsTruncationExact()`.
+ */
+constexpr inline BigFixed ComputePiForDigits(uint64_t digits) {
+  for (uint64_t extra = 0;; extra = std::max(2 * extra, detail::kRetryDigits)) {
+    const auto plan = MakePiPlan(digits + extra);
+    auto pi = ComputePi(plan);
+    if (IsTruncationExact(pi, digits, plan.output_bits)) {
+      return pi;
+    }
+  }
+}
+
+// <Incremental Extension>
+/// Extend `prefix` of Chudnovsky's formula to `plan.terms` terms. See `ExtendSeries()`.
+constexpr inline SeriesPrefix ExtendSeries(SeriesPrefix prefix, const PiPlan& plan) {
+  const SeriesOptions options{plan.remove_common_factors, plan.memory_budget_bytes, plan.spill_directory};
+  return ExtendSeries(ChudnovskySeries{}, std::move(prefix), plan.terms, options);
+}
+
+/**
+ * @brief Compute pi from `prefix` extended to `plan.terms` terms
+ * @param prefix The series computed by a previous call. It is extended in place for later calls.
+ *
+ * The series work done for the prefix is reused, and only the final division and the square root are computed again
+ * at the new precision.
+ */
+constexpr inline BigFixed ExtendPi(SeriesPrefix& prefix, const PiPlan& plan) {
+  prefix = ExtendSeries(std::move(prefix), plan);
+  return detail::ComputePiQuotient(prefix.q, prefix.t, plan.frac_bits) * detail::ComputeInverseSqrtC(plan.frac_bits);
+}
+
+/// Compute pi with `digits` decimal digits after the decimal point from `prefix`, which is extended in place
+constexpr inline BigFixed ExtendPi(SeriesPrefix& prefix, uint64_t digits) {
+  return ExtendPi(prefix, MakePiPlan(digits));
+}
+// </Incremental Extension>
+
+/// Get the decimal representation of pi with exactly `digits` digits after the decimal point (e.g. "3.14")
+constexpr inline std::string GetPiString(uint64_t digits) {
+  auto str = ToDecimalString(ComputePiForDigits(digits));
+  str.resize(digits + 2);
+  return str;
+}
+
+/// Write `GetPiString(digits)` to `sink` in chunks of `chunk_size` characters. See `WriteDecimalString()`.
+template <DigitSink Sink>
+void WritePiString(Sink& sink, uint64_t digits, std::size_t chunk_size = kDigitChunkSize) {
+  WriteDecimalString(sink, ComputePiForDigits(digits), digits, chunk_size);
+}
+}  // namespace komori
+
+#endif  // KOMORI_PI_HPP_
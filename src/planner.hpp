@@ -0,0 +1,124 @@
+#ifndef KOMORI_PLANNER_HPP_
+#define KOMORI_PLANNER_HPP_
+
+#include <algorithm>
+#include <bit>
+#include <limits>
+#include <string>
+
+#include "common.hpp"
+
+namespace komori {
+namespace chudnovsky {
+/// 1/pi = 12 * sum_k (-1)^k (6k)! (A + Bk) / ((3k)! (k!)^3 C^(3k + 3/2))
+inline constexpr uint64_t kA = 13591409;
+inline constexpr uint64_t kB = 545140134;
+inline constexpr uint64_t kC = 640320;
+inline constexpr uint64_t kC3 = kC * kC * kC;
+/// q(k) = k^3 * C^3 / 24
+inline constexpr uint64_t kC3Over24 = kC3 / 24;
+
+/// A lower bound of log2(C^3 / 1728) = 47.1104..., the number of bits that each term adds
+inline constexpr double kBitsPerTerm = 47.1104;
+
+/// The truncation error of `n` terms of the series is less than 2^(-SeriesErrorBits(n)). See `PiPlan`.
+constexpr inline int64_t SeriesErrorBits(uint64_t n) {
+  // floor(kBitsPerTerm * n) - log2(4 * (1 + B n / A))
+  const auto poly_bits = static_cast<int64_t>(std::bit_width(1 + (kB / kA + 1) * n)) + 2;
+  return static_cast<int64_t>(kBitsPerTerm * static_cast<double>(n)) - poly_bits;
+}
+
+/// The minimum number of terms whose truncation error is less than 2^(-bits)
+constexpr inline uint64_t TermsFor(uint64_t bits) {
+  auto terms = std::max<uint64_t>(1, static_cast<uint64_t>(static_cast<double>(bits) / kBitsPerTerm));
+  while (SeriesErrorBits(terms) < static_cast<int64_t>(bits)) {
+    ++terms;
+  }
+  return terms;
+}
+}  // namespace chudnovsky
+
+namespace detail {
+/// log2(10)
+inline constexpr double kLog2Of10 = 3.321928094887362;
+/// An upper bound of log2(pi * sqrt(C)) = 11.29..., the magnitude of the quotient computed in the final stage
+inline constexpr uint64_t kPiQuotientBits = 12;
+/// An upper bound of log2 of the error of `Divide` and `InverseSqrt` in units in the last place
+inline constexpr uint64_t kFinalStageErrorBits = 4;
+}  // namespace detail
+
+/**
+ * @brief The numbers of terms and bits needed to compute pi
+ *
+ * pi = C^(3/2) Q / (12 (A Q + T)) is computed in two stages: the series is summed exactly in integers (`terms` terms),
+ * and the quotient and the square root are computed in `BigFixed` with `frac_bits` fractional bits.
+ *
+ * The error is bounded as follows. The series is alternating and its terms decrease by a factor of at least
+ * 2^kBitsPerTerm (the ratio (6k+1)(6k+3)(6k+5) / (k+1)^3 is below 216), so the truncation error of pi is at most
+ * 4 * (1 + B n / A) * 2^(-kBitsPerTerm * n) < 2^(-series_error_bits). In the final stage, `Divide` and `InverseSqrt`
+ * are off by at most 2^kFinalStageErrorBits ulps, and the quotient is less than 2^kPiQuotientBits, so the product is
+ * off by less than 2^(kPiQuotientBits + kFinalStageErrorBits + 1) ulps. These errors are absorbed by `guard_bits`.
+ */
+struct PiPlan {
+  /// The number of decimal digits after the decimal point
+  uint64_t digits;
+  /// The result is within 2^(-output_bits) of pi, which is less than a quarter of 10^(-digits). Its truncation to
+  /// `digits` digits may still be off by one in the last digit. See `IsTruncationExact()`.
+  uint64_t output_bits;
+  /// The number of terms of the series
+  uint64_t terms;
+  /// The truncation error of the series is less than 2^(-series_error_bits)
+  uint64_t series_error_bits;
+  /// The number of extra fractional bits to absorb the rounding errors of the final stage
+  uint64_t guard_bits;
+  /// The number of fractional bits of the final stage
+  uint64_t frac_bits;
+  /// Whether to remove the common prime factors of P and Q in binary splitting. It does not change the result.
+  bool remove_common_factors{false};
+  /// The budget of the bytes of the live integers in binary splitting. Concurrency is limited to fit in it.
+  uint64_t memory_budget_bytes{std::numeric_limits<uint64_t>::max()};
+  /// The directory to save and load intermediate results. Checkpointing is disabled if empty.
+  std::string checkpoint_directory{};
+  /// The directory to spill large intermediate results of binary splitting to. Spilling is disabled if empty.
+  std::string spill_directory{};
+
+  std::string DebugString() const {
+    std::string s;
+    s += "digits=" + std::to_string(digits);
+    s += " output_bits=" + std::to_string(output_bits);
+    s += " terms=" + std::to_string(terms);
+    s += " series_error=2^(-" + std::to_string(series_error_bits) + ")";
+    s += " guard_bits=" + std::to_string(guard_bits);
+    s += " frac_bits=" + std::to_string(frac_bits);
+    s += " remove_common_factors=" + std::string{remove_common_factors ? "true" : "false"};
+    s += " memory_budget_bytes=" + std::to_string(memory_budget_bytes);
+    if (!checkpoint_directory.empty()) {
+      s += " checkpoint_directory=" + checkpoint_directory;
+    }
+    if (!spill_directory.empty()) {
+      s += " spill_directory=" + spill_directory;
+    }
+    return s;
+  }
+};
+
+/**
+ * @brief Plan the computation of `digits` decimal digits of pi
+ * @param digits The number of decimal digits after the decimal point
+ */
+constexpr inline PiPlan MakePiPlan(uint64_t digits) {
+  PiPlan plan{};
+  plan.digits = digits;
+  // Two more bits so that the error is below a quarter of the last digit's weight
+  plan.output_bits = static_cast<uint64_t>(static_cast<double>(digits) * detail::kLog2Of10) + 2;
+
+  plan.terms = chudnovsky::TermsFor(plan.output_bits + 1);
+  plan.series_error_bits = static_cast<uint64_t>(chudnovsky::SeriesErrorBits(plan.terms));
+
+  plan.guard_bits = detail::kPiQuotientBits + detail::kFinalStageErrorBits + 2;
+  plan.frac_bits = plan.output_bits + plan.guard_bits;
+  return plan;
+}
+}  // namespace komori
+
+#endif  // KOMORI_PLANNER_HPP_
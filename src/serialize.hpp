@@ -0,0 +1,268 @@
+#ifndef KOMORI_SERIALIZE_HPP_
+#define KOMORI_SERIALIZE_HPP_
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "bigfixed.hpp"
+#include "bigfloat.hpp"
+#include "bigint.hpp"
+#include "biguint.hpp"
+
+namespace komori {
+/**
+ * @brief An error in reading serialized numbers
+ *
+ * It is thrown if the stream ends early, or if the magic, the version, the type or the checksum does not match.
+ */
+class SerializeError : public std::runtime_error {
+ public:
+  using std::runtime_error::runtime_error;
+};
+
+namespace detail {
+/// "KOMORIBN" in little endian
+inline constexpr uint64_t kSerializeMagic = 0x4e4249524f4d4f4bULL;
+/// Version 2 covers the fields of the type by the checksum
+inline constexpr uint64_t kSerializeVersion = 2;
+/// The number of limbs converted at a time on big-endian hosts
+inline constexpr std::size_t kSerializeChunkLimbs = std::size_t{1} << 16;
+
+/// The tag of the serialized type
+enum class SerializeType : uint64_t {
+  kBigUint = 1,
+  kBigInt = 2,
+  kBigFloat = 3,
+  kBigFixed = 4,
+};
+
+/// FNV-1a over 64-bit words. It detects truncated and corrupted files, not malicious ones.
+class Checksum {
+ public:
+  constexpr void Update(uint64_t word) noexcept { hash_ = (hash_ ^ word) * 0x100000001b3ULL; }
+  constexpr uint64_t Get() const noexcept { return hash_; }
+
+ private:
+  uint64_t hash_{0xcbf29ce484222325ULL};
+};
+
+constexpr inline uint64_t ByteSwap(uint64_t word) noexcept {
+  uint64_t ans = 0;
+  for (int i = 0; i < 8; ++i) {
+    ans = (ans << 8) | (word & 0xff);
+    word >>= 8;
+  }
+  return ans;
+}
+
+inline void WriteWords(std::ostream& os, const uint64_t* words, std::size_t size) {
+  if constexpr (std::endian::native == std::endian::little) {
+    os.write(reinterpret_cast<const char*>(words), static_cast<std::streamsize>(size * sizeof(uint64_t)));
+  } else {
+    std::vector<uint64_t> buffer;
+    for (std::size_t i = 0; i < size; i += kSerializeChunkLimbs) {
+      const auto len = std::min(size - i, kSerializeChunkLimbs);
+      buffer.assign(words + i, words + i + len);
+      for (auto& word : buffer) {
+        word = ByteSwap(word);
+      }
+      os.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(len * sizeof(uint64_t)));
+    }
+  }
+
+  if (!os) {
+    throw SerializeError("Failed to write");
+  }
+}
+
+inline void ReadWords(std::istream& is, uint64_t* words, std::size_t size) {
+  is.read(reinterpret_cast<char*>(words), static_cast<std::streamsize>(size * sizeof(uint64_t)));
+  if (!is) {
+    throw SerializeError("Unexpected end of stream");
+  }
+
+  if constexpr (std::endian::native != std::endian::little) {
+    for (std::size_t i = 0; i < size; ++i) {
+      words[i] = ByteSwap(words[i]);
+    }
+  }
+}
+
+inline void WriteWord(std::ostream& os, uint64_t word) {
+  WriteWords(os, &word, 1);
+}
+
+inline uint64_t ReadWord(std::istream& is) {
+  uint64_t word = 0;
+  ReadWords(is, &word, 1);
+  return word;
+}
+
+/// Write a field of a number and feed it into `checksum`
+inline void WriteWord(std::ostream& os, uint64_t word, Checksum& checksum) {
+  WriteWord(os, word);
+  checksum.Update(word);
+}
+
+/// Read a field of a number and feed it into `checksum`
+inline uint64_t ReadWord(std::istream& is, Checksum& checksum) {
+  const auto word = ReadWord(is);
+  checksum.Update(word);
+  return word;
+}
+
+/// Write the header: the magic, the version and the type
+inline void WriteHeader(std::ostream& os, SerializeType type) {
+  const std::array<uint64_t, 3> header{kSerializeMagic, kSerializeVersion, static_cast<uint64_t>(type)};
+  WriteWords(os, header.data(), header.size());
+}
+
+inline void ReadHeader(std::istream& is, SerializeType type) {
+  std::array<uint64_t, 3> header{};
+  ReadWords(is, header.data(), header.size());
+  if (header[0] != kSerializeMagic) {
+    throw SerializeError("Bad magic");
+  }
+  if (header[1] != kSerializeVersion) {
+    throw SerializeError("Unsupported version");
+  }
+  if (header[2] != static_cast<uint64_t>(type)) {
+    throw SerializeError("Unexpected type");
+  }
+}
+
+/**
+ * @brief Write the number of limbs, the limbs and `checksum`, which covers the fields written before them
+ *
+ * The limbs are written in place.
+ */
+inline void WriteLimbs(std::ostream& os, const BigUint& value, Checksum& checksum) {
+  WriteWord(os, value.size(), checksum);
+  WriteWords(os, value.data(), value.size());
+
+  for (const auto limb : value) {
+    checksum.Update(limb);
+  }
+  WriteWord(os, checksum.Get());
+}
+
+/// Read the limbs written by `WriteLimbs()` directly into the storage of the result, and verify `checksum`
+inline BigUint ReadLimbs(std::istream& is, Checksum& checksum) {
+  const auto size = ReadWord(is, checksum);
+
+  // Reading chunk by chunk avoids allocating a huge buffer for a corrupted size
+  BigUint value;
+  while (value.size() < size) {
+    const auto offset = value.size();
+    const auto len = std::min<uint64_t>(size - offset, kSerializeChunkLimbs);
+    value.resize(offset + len);
+    ReadWords(is, value.data() + offset, len);
+  }
+
+  for (const auto limb : value) {
+    checksum.Update(limb);
+  }
+  if (ReadWord(is) != checksum.Get()) {
+    throw SerializeError("Checksum mismatch");
+  }
+  if (!value.empty() && value.back() == 0) {
+    throw SerializeError("Leading zero limb");
+  }
+
+  return value;
+}
+
+inline void WriteSign(std::ostream& os, Sign sign, Checksum& checksum) {
+  WriteWord(os, sign == Sign::kPositive ? 0 : 1, checksum);
+}
+
+inline Sign ReadSign(std::istream& is, Checksum& checksum) {
+  switch (ReadWord(is, checksum)) {
+    case 0:
+      return Sign::kPositive;
+    case 1:
+      return Sign::kNegative;
+    default:
+      throw SerializeError("Bad sign");
+  }
+}
+}  // namespace detail
+
+// <Serialization>
+// A serialized number is a sequence of little-endian 64-bit words: the magic "KOMORIBN", the version, the type, the
+// fields of the type, the number of limbs, the limbs, and the checksum of every word after the header. The limbs are
+// streamed from and to the storage of the number, so no second copy of a large operand is made.
+
+inline void Serialize(std::ostream& os, const BigUint& value) {
+  detail::WriteHeader(os, detail::SerializeType::kBigUint);
+  detail::Checksum checksum;
+  detail::WriteLimbs(os, value, checksum);
+}
+
+inline void Serialize(std::ostream& os, const BigInt& value) {
+  detail::WriteHeader(os, detail::SerializeType::kBigInt);
+  detail::Checksum checksum;
+  detail::WriteSign(os, value.GetSign(), checksum);
+  detail::WriteLimbs(os, value.Abs(), checksum);
+}
+
+inline void Serialize(std::ostream& os, const BigFloat& value) {
+  detail::WriteHeader(os, detail::SerializeType::kBigFloat);
+  detail::Checksum checksum;
+  detail::WriteWord(os, static_cast<uint64_t>(value.GetPrecision()), checksum);
+  detail::WriteWord(os, static_cast<uint64_t>(value.GetExponent()), checksum);
+  detail::WriteSign(os, value.GetSignificand().GetSign(), checksum);
+  detail::WriteLimbs(os, value.GetSignificand().Abs(), checksum);
+}
+
+inline void Serialize(std::ostream& os, const BigFixed& value) {
+  detail::WriteHeader(os, detail::SerializeType::kBigFixed);
+  detail::Checksum checksum;
+  detail::WriteWord(os, value.GetFracBits(), checksum);
+  detail::WriteSign(os, value.Raw().GetSign(), checksum);
+  detail::WriteLimbs(os, value.Raw().Abs(), checksum);
+}
+
+/**
+ * @brief Read a number written by `Serialize()`
+ * @tparam T One of `BigUint`, `BigInt`, `BigFloat` and `BigFixed`
+ * @throw `SerializeError` if the stream does not contain a valid `T`
+ */
+template <typename T>
+T Deserialize(std::istream& is) {
+  detail::Checksum checksum;
+  if constexpr (std::is_same_v<T, BigUint>) {
+    detail::ReadHeader(is, detail::SerializeType::kBigUint);
+    return detail::ReadLimbs(is, checksum);
+  } else if constexpr (std::is_same_v<T, BigInt>) {
+    detail::ReadHeader(is, detail::SerializeType::kBigInt);
+    const auto sign = detail::ReadSign(is, checksum);
+    return BigInt{detail::ReadLimbs(is, checksum), sign};
+  } else if constexpr (std::is_same_v<T, BigFloat>) {
+    detail::ReadHeader(is, detail::SerializeType::kBigFloat);
+    const auto precision = static_cast<int64_t>(detail::ReadWord(is, checksum));
+    const auto exponent = static_cast<int64_t>(detail::ReadWord(is, checksum));
+    const auto sign = detail::ReadSign(is, checksum);
+    auto significand = detail::ReadLimbs(is, checksum);
+    return BigFloat(precision, BigInt{std::move(significand), sign}) << exponent;
+  } else {
+    static_assert(std::is_same_v<T, BigFixed>, "Unsupported type");
+    detail::ReadHeader(is, detail::SerializeType::kBigFixed);
+    const auto frac_bits = detail::ReadWord(is, checksum);
+    const auto sign = detail::ReadSign(is, checksum);
+    return BigFixed::FromRaw(frac_bits, BigInt{detail::ReadLimbs(is, checksum), sign});
+  }
+}
+// </Serialization>
+}  // namespace komori
+
+#endif  // KOMORI_SERIALIZE_HPP_
@@ -1,14 +1,26 @@
 #ifndef KOMORI_SSA_HPP_
 #define KOMORI_SSA_HPP_
 
+#include <bit>
 #include <iostream>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
 
 #include "bigint.hpp"
 #include "biguint.hpp"
 #include "gf2n1.hpp"
+#include "thread_pool.hpp"
 
 namespace komori {
 namespace detail {
+/// The minimum bit length of operands to use SSA in `Multiply()`
+inline constexpr uint64_t kSSAThresholdBits = 266'843;
+/// The minimum bit length of operands to run SSA in parallel in `Multiply()`
+inline constexpr uint64_t kParallelSSAThresholdBits = uint64_t{1} << 20;
+/// The minimum bit length of operands to run the subproducts of Karatsuba in parallel in `Multiply()`
+inline constexpr uint64_t kParallelKaratsubaThresholdBits = uint64_t{1} << 15;
+
 constexpr inline uint64_t Calc_n(uint64_t k) noexcept {
   return (1 << (k - 1));
 }
@@ -33,20 +45,28 @@ constexpr inline uint64_t Best_k(uint64_t bit_len) noexcept {
   return r;
 }
 
-class SplittedInteger {
+/**
+ * @brief An integer split into 2^k pieces of elements of Z/(2^n+1)Z for SSA
+ * @tparam UInt `BasicBigUint` of the integer
+ *
+ * With a thread pool, the splitting, the butterflies of the transforms and the pointwise operations run in tasks of the
+ * pool at run time. The pool is ignored in constant evaluation.
+ */
+template <typename UInt>
+class BasicSplittedInteger {
+  using Element = BasicGF2PowNPlus1<UInt>;
+
  public:
-  explicit constexpr SplittedInteger(const BigUint& num, uint64_t k) : k_{k}, n_{Calc_n(k)}, m_{Calc_M(k)} {
+  explicit constexpr BasicSplittedInteger(const UInt& num, uint64_t k, ThreadPool* pool = nullptr)
+      : k_{k}, n_{Calc_n(k)}, m_{Calc_M(k)}, pool_{pool} {
     const auto N = uint64_t{1} << k;
-    values_.reserve(N);
-    for (uint64_t i = 0; i < N; ++i) {
-      BigUint x = num.ShiftMod2Pow(i * m_, m_);
-      values_.emplace_back(n_, std::move(x));
-    }
+    values_.assign(N, Element{n_});
+    ForEach(N, [&](uint64_t i) { values_[i] = Element{n_, num.ShiftMod2Pow(i * m_, m_)}; });
   }
 
-  constexpr BigUint Get() const noexcept {
+  constexpr UInt Get() const noexcept {
     const auto N = uint64_t{1} << k_;
-    BigUint ans{};
+    UInt ans{};
     for (uint64_t i = 0; i < N; ++i) {
       const auto& x = values_[i].Get();
       ans.ShlAddAssign(x, i * m_);
@@ -55,20 +75,20 @@ class SplittedInteger {
     return ans;
   }
 
-  constexpr void NTT() noexcept {
+  constexpr void NTT() {
     const uint64_t len = values_.size();
-    for (uint64_t q = len / 2; q > 0; q /= 2) {
-      const auto p = len / q / 2;
-      for (uint64_t i = 0; i < q; ++i) {
-        const auto w = GF2PowNPlus1::Make2Pow(i * p, n_);
-        for (uint64_t j = i; j < len; j += 2 * q) {
-          const auto k = j + q;
-          auto tmp = values_[j] - values_[k];
-          values_[j] += values_[k];
-          tmp *= w;
-          values_[k] = std::move(tmp);
-        }
+    uint64_t q = len / 2;
+    if (!std::is_constant_evaluated() && pool_ != nullptr) {
+      // While the independent blocks are fewer than the chunks of `ParallelFor()`, split each stage by the twiddle
+      // factors. Then the remaining stages transform the blocks of 2q elements independently.
+      for (; q > 0 && len / (2 * q) < 4 * pool_->Concurrency(); q /= 2) {
+        ParallelFor(*pool_, 0, q, [this, len, q](uint64_t i) { Butterflies(0, len, q, i); });
       }
+      if (q > 0) {
+        ParallelFor(*pool_, 0, len / (2 * q), [this, q](uint64_t block) { Stages(block * 2 * q, 2 * q, q); });
+      }
+    } else {
+      Stages(0, len, q);
     }
 
     uint64_t i = 0;
@@ -85,54 +105,177 @@ class SplittedInteger {
     }
   }
 
-  constexpr void INTT() noexcept {
+  constexpr void INTT() {
     NTT();
     for (std::size_t i = 1; i < values_.size() / 2; ++i) {
       std::swap(values_[i], values_[values_.size() - i]);
     }
 
-    const auto w = GF2PowNPlus1::Make2Pow(2 * n_ - k_, n_);
-    for (auto& value : values_) {
-      value *= w;
-    }
+    const auto w = Element::Make2Pow(2 * n_ - k_, n_);
+    ForEach(values_.size(), [&](uint64_t i) { values_[i] *= w; });
   }
 
-  constexpr SplittedInteger& operator*=(const SplittedInteger& rhs) {
-    for (uint64_t i = 0; i < values_.size(); ++i) {
-      values_[i] *= rhs.values_[i];
-    }
+  constexpr BasicSplittedInteger& operator*=(const BasicSplittedInteger& rhs) {
+    ForEach(values_.size(), [&](uint64_t i) { values_[i] *= rhs.values_[i]; });
+
+    return *this;
+  }
+
+  /// Add `rhs` pointwise. Because NTT is linear, this can be used to accumulate products in the transformed domain.
+  constexpr BasicSplittedInteger& operator+=(const BasicSplittedInteger& rhs) {
+    ForEach(values_.size(), [&](uint64_t i) { values_[i] += rhs.values_[i]; });
 
     return *this;
   }
 
  private:
-  std::vector<GF2PowNPlus1> values_;
+  /// Run `func(i)` for i in [0, size), in parallel if a pool is given
+  template <typename F>
+  constexpr void ForEach(uint64_t size, F func) {
+    if (!std::is_constant_evaluated() && pool_ != nullptr) {
+      ParallelFor(*pool_, 0, size, func);
+    } else {
+      for (uint64_t i = 0; i < size; ++i) {
+        func(i);
+      }
+    }
+  }
+
+  /// The butterflies of distance `q` with the i-th twiddle factor in [offset, offset + size)
+  constexpr void Butterflies(uint64_t offset, uint64_t size, uint64_t q, uint64_t i) {
+    const auto p = values_.size() / q / 2;
+    const auto w = Element::Make2Pow(i * p, n_);
+    for (uint64_t j = offset + i; j < offset + size; j += 2 * q) {
+      const auto k = j + q;
+      auto tmp = values_[j] - values_[k];
+      values_[j] += values_[k];
+      tmp *= w;
+      values_[k] = std::move(tmp);
+    }
+  }
+
+  /// The stages of distance `q`, q/2, ..., 1 in [offset, offset + size), which are independent of the other blocks
+  constexpr void Stages(uint64_t offset, uint64_t size, uint64_t q) {
+    for (; q > 0; q /= 2) {
+      for (uint64_t i = 0; i < q; ++i) {
+        Butterflies(offset, size, q, i);
+      }
+    }
+  }
+
+  std::vector<Element> values_;
   uint64_t k_;
   uint64_t n_;
   uint64_t m_;
+  ThreadPool* pool_;
 };
 
-constexpr inline BigUint MultiplySSA(const BigUint& lhs, const BigUint& rhs) {
+using SplittedInteger = BasicSplittedInteger<BigUint>;
+
+/// The run-time part of `MultiplySSA()` with a pool. The two forward transforms run concurrently.
+template <typename Limb, typename DoubleLimb>
+BasicBigUint<Limb, DoubleLimb> MultiplySSAParallel(const BasicBigUint<Limb, DoubleLimb>& lhs,
+                                                   const BasicBigUint<Limb, DoubleLimb>& rhs,
+                                                   uint64_t k,
+                                                   ThreadPool& pool) {
+  using Splitted = BasicSplittedInteger<BasicBigUint<Limb, DoubleLimb>>;
+
+  auto r_task = pool.Submit([&rhs, k, &pool] {
+    Splitted r(rhs, k, &pool);
+    r.NTT();
+    return r;
+  });
+  Splitted l(lhs, k, &pool);
+  l.NTT();
+  l *= r_task.Get();
+  l.INTT();
+  return l.Get();
+}
+
+/**
+ * @brief Multiply by Schönhage--Strassen algorithm
+ * @param pool If not null, the transforms and the pointwise products run in tasks of `pool` at run time
+ */
+template <typename Limb, typename DoubleLimb>
+constexpr BasicBigUint<Limb, DoubleLimb> MultiplySSA(const BasicBigUint<Limb, DoubleLimb>& lhs,
+                                                     const BasicBigUint<Limb, DoubleLimb>& rhs,
+                                                     ThreadPool* pool = nullptr) {
   const auto bit_len = std::max(lhs.NumberOfBits(), rhs.NumberOfBits());
   const auto best_k = Best_k(bit_len);
+  if (!std::is_constant_evaluated() && pool != nullptr) {
+    return MultiplySSAParallel(lhs, rhs, best_k, *pool);
+  }
 
-  SplittedInteger l(lhs, best_k);
-  SplittedInteger r(rhs, best_k);
+  BasicSplittedInteger<BasicBigUint<Limb, DoubleLimb>> l(lhs, best_k);
+  BasicSplittedInteger<BasicBigUint<Limb, DoubleLimb>> r(rhs, best_k);
   l.NTT();
   r.NTT();
   l *= r;
   l.INTT();
   return l.Get();
 }
+
+/// The pool to multiply `bits`-bit operands in parallel, or null to multiply them serially
+constexpr inline ThreadPool* MultiplyThreadPool(uint64_t bits, uint64_t threshold_bits) {
+  if (std::is_constant_evaluated() || bits < threshold_bits || ThreadPool::IsDefaultDisabled()) {
+    return nullptr;
+  }
+
+  auto& pool = ThreadPool::Default();
+  return pool.Concurrency() > 1 ? &pool : nullptr;
+}
+
+/**
+ * @brief Multiply by Karatsuba's method with the three subproducts in tasks of `pool`
+ *
+ * The subproducts of operands shorter than `kParallelKaratsubaThresholdBits` are computed serially by
+ * `MultiplyKaratsuba()`, so the tasks are large enough to hide the cost of scheduling.
+ */
+template <typename Limb, typename DoubleLimb>
+BasicBigUint<Limb, DoubleLimb> MultiplyKaratsubaParallel(const BasicBigUint<Limb, DoubleLimb>& lhs,
+                                                         const BasicBigUint<Limb, DoubleLimb>& rhs,
+                                                         ThreadPool& pool) {
+  if (std::min(lhs.NumberOfBits(), rhs.NumberOfBits()) < kParallelKaratsubaThresholdBits) {
+    return MultiplyKaratsuba(lhs, rhs);
+  }
+
+  const auto shift_bits = (std::max(lhs.size(), rhs.size()) + 1) / 2 * kLimbBits<Limb>;
+  const auto lhs_high = lhs >> shift_bits;
+  const auto rhs_high = rhs >> shift_bits;
+  const auto lhs_low = lhs.ShiftMod2Pow(0, shift_bits);
+  const auto rhs_low = rhs.ShiftMod2Pow(0, shift_bits);
+
+  auto k2_task = pool.Submit([&] { return MultiplyKaratsubaParallel(lhs_high, rhs_high, pool); });
+  auto k3_task =
+      pool.Submit([&] { return MultiplyKaratsubaParallel(lhs_high + lhs_low, rhs_high + rhs_low, pool); });
+  const auto k1 = MultiplyKaratsubaParallel(lhs_low, rhs_low, pool);
+  const auto k2 = k2_task.Get();
+  const auto k3 = k3_task.Get();
+
+  auto result = k1;
+  result.ShlAddAssign(k2, 2 * shift_bits);
+  result.ShlAddAssign(k3 - k1 - k2, shift_bits);
+  return result;
+}
 }  // namespace detail
 
-constexpr inline BigUint Multiply(const BigUint& lhs, const BigUint& rhs) {
+/**
+ * @brief Multiply by the fastest method for the sizes of the operands
+ *
+ * At run time, large products are computed in parallel by the default pool: the subproducts of Karatsuba's method, or
+ * the transforms and the pointwise products of SSA.
+ */
+template <typename Limb, typename DoubleLimb>
+constexpr BasicBigUint<Limb, DoubleLimb> Multiply(const BasicBigUint<Limb, DoubleLimb>& lhs,
+                                                  const BasicBigUint<Limb, DoubleLimb>& rhs) {
   const auto number_of_bits = std::min(lhs.NumberOfBits(), rhs.NumberOfBits());
-  if (number_of_bits < 266'843) {
+  if (number_of_bits < detail::kSSAThresholdBits) {
+    if (auto* pool = detail::MultiplyThreadPool(number_of_bits, detail::kParallelKaratsubaThresholdBits)) {
+      return detail::MultiplyKaratsubaParallel(lhs, rhs, *pool);
+    }
     return lhs * rhs;
   } else {
-    // Multiplication by SSA is disabled because it requires tremendous time
-    return detail::MultiplySSA(lhs, rhs);
+    return detail::MultiplySSA(lhs, rhs, detail::MultiplyThreadPool(number_of_bits, detail::kParallelSSAThresholdBits));
   }
 }
 
@@ -141,6 +284,98 @@ constexpr inline BigInt Multiply(const BigInt& lhs, const BigInt& rhs) {
   auto ans_sign = lhs.GetSign() ^ rhs.GetSign();
   return {std::move(ans_value), ans_sign};
 }
+
+/**
+ * @brief Start `Multiply(lhs, rhs)` in a task of `pool`
+ *
+ * The operands are owned by the task, so pass them with `std::move()` to avoid copies. Independent products can be
+ * overlapped by starting them before getting any of the results.
+ */
+template <typename T>
+Task<T> MultiplyAsync(T lhs, T rhs, ThreadPool& pool = ThreadPool::Default()) {
+  return pool.Submit([lhs = std::move(lhs), rhs = std::move(rhs)] { return Multiply(lhs, rhs); });
+}
+
+namespace detail {
+/**
+ * @brief Compute x such that `num * x = 1 (mod 2^bits)` by Newton's method in the 2-adic numbers
+ * @pre `num` is odd
+ *
+ * Each step x' = x (2 - num x) doubles the number of correct low bits. The precisions are chosen from the top so that
+ * the last step lands exactly on `bits`.
+ */
+template <typename Limb, typename DoubleLimb>
+constexpr BasicBigUint<Limb, DoubleLimb> InverseMod2Pow(const BasicBigUint<Limb, DoubleLimb>& num, std::size_t bits) {
+  using UInt = BasicBigUint<Limb, DoubleLimb>;
+
+  std::vector<std::size_t> ladder;
+  for (auto precision = bits; precision > 64; precision = (precision + 1) / 2) {
+    ladder.push_back(precision);
+  }
+
+  // The inverse of the lowest 64 bits. x = num is correct in 3 bits, and each step doubles it.
+  const auto low = static_cast<uint64_t>(num.ShiftMod2Pow(0, 64));
+  uint64_t low_inverse = low;
+  for (int i = 0; i < 5; ++i) {
+    low_inverse *= 2 - low * low_inverse;
+  }
+  auto x = UInt{low_inverse};
+  x.ModAssign2Pow(std::min<std::size_t>(bits, 64));
+
+  std::size_t precision = 64;
+  for (auto itr = ladder.rbegin(); itr != ladder.rend(); ++itr) {
+    const auto next_precision = *itr;
+    const auto extra_bits = next_precision - precision;
+
+    // num x = 1 + 2^precision h, so x (2 - num x) = x - 2^precision (x h)
+    const auto h = Multiply(num.ShiftMod2Pow(0, next_precision), x).ShiftMod2Pow(precision, extra_bits);
+    auto correction = Multiply(x.ShiftMod2Pow(0, extra_bits), h);
+    correction.ModAssign2Pow(extra_bits);
+    if (!correction.IsZero()) {
+      correction = (UInt{1} << extra_bits) - correction;
+      x += correction << precision;
+    }
+    precision = next_precision;
+  }
+
+  return x;
+}
+}  // namespace detail
+
+/**
+ * @brief Compute `lhs / rhs` when `rhs` divides `lhs`
+ * @pre `rhs` is nonzero and divides `lhs`
+ *
+ * The quotient is `lhs * rhs^(-1) mod 2^m` for any m above its bit width, and the 2-adic inverse costs a few
+ * multiplications. Unlike a general division, no remainder is computed.
+ */
+template <typename Limb, typename DoubleLimb>
+constexpr BasicBigUint<Limb, DoubleLimb> ExactDivide(BasicBigUint<Limb, DoubleLimb> lhs,
+                                                     BasicBigUint<Limb, DoubleLimb> rhs) {
+  if (rhs.IsZero()) {
+    throw std::range_error("Division by zero");
+  }
+
+  // Make `rhs` odd so that it is invertible modulo powers of 2
+  constexpr auto kBits = detail::kLimbBits<Limb>;
+  std::size_t trailing_zeros = 0;
+  while (rhs[trailing_zeros / kBits] == 0) {
+    trailing_zeros += kBits;
+  }
+  trailing_zeros += static_cast<std::size_t>(std::countr_zero(rhs[trailing_zeros / kBits]));
+  lhs >>= trailing_zeros;
+  rhs >>= trailing_zeros;
+
+  if (lhs < rhs) {
+    return {};
+  }
+
+  const auto bits = lhs.NumberOfBits() - rhs.NumberOfBits() + 1;
+  const auto inverse = detail::InverseMod2Pow(rhs, bits);
+  auto quotient = Multiply(lhs.ModAssign2Pow(bits), inverse);
+  quotient.ModAssign2Pow(bits);
+  return quotient;
+}
 }  // namespace komori
 
 #endif  // KOMORI_SSA_HPP_
\ No newline at end of file
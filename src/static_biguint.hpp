@@ -0,0 +1,206 @@
+#ifndef KOMORI_STATIC_BIGUINT_HPP_
+#define KOMORI_STATIC_BIGUINT_HPP_
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <initializer_list>
+#include <stdexcept>
+#include <vector>
+
+#include "biguint.hpp"
+
+namespace komori {
+/**
+ * @brief A vector-like container with fixed capacity
+ * @tparam T The type of elements
+ * @tparam Capacity The maximum number of elements
+ *
+ * Unlike `std::vector`, this class never allocates memory, so it is cheap for the constant evaluator to create and
+ * destroy.
+ */
+template <typename T, std::size_t Capacity>
+class StaticVector {
+ public:
+  using value_type = T;
+  using iterator = typename std::array<T, Capacity>::iterator;
+  using const_iterator = typename std::array<T, Capacity>::const_iterator;
+
+  constexpr StaticVector() = default;
+
+  /**
+   * @brief Construct from `values`
+   * @throw `std::length_error` if `values` exceeds the capacity
+   */
+  constexpr StaticVector(std::initializer_list<T> values) {
+    for (const auto& value : values) {
+      push_back(value);
+    }
+  }
+
+  constexpr std::size_t size() const noexcept { return size_; }
+  constexpr bool empty() const noexcept { return size_ == 0; }
+  static constexpr std::size_t capacity() noexcept { return Capacity; }
+
+  constexpr T& operator[](std::size_t i) noexcept { return values_[i]; }
+  constexpr const T& operator[](std::size_t i) const noexcept { return values_[i]; }
+  constexpr T& back() noexcept { return values_[size_ - 1]; }
+  constexpr const T& back() const noexcept { return values_[size_ - 1]; }
+
+  constexpr iterator begin() noexcept { return values_.begin(); }
+  constexpr iterator end() noexcept { return values_.begin() + size_; }
+  constexpr const_iterator begin() const noexcept { return values_.begin(); }
+  constexpr const_iterator end() const noexcept { return values_.begin() + size_; }
+
+  /**
+   * @brief Change the number of elements. New elements are value-initialized.
+   * @throw `std::length_error` if `new_size` exceeds the capacity
+   */
+  constexpr void resize(std::size_t new_size) {
+    if (new_size > Capacity) {
+      throw std::length_error("StaticVector capacity exceeded");
+    }
+
+    if (new_size > size_) {
+      std::fill(values_.begin() + size_, values_.begin() + new_size, T{});
+    }
+    size_ = new_size;
+  }
+
+  constexpr void push_back(T value) {
+    if (size_ >= Capacity) {
+      throw std::length_error("StaticVector capacity exceeded");
+    }
+    values_[size_++] = value;
+  }
+
+  constexpr void pop_back() noexcept { --size_; }
+
+  friend constexpr bool operator==(const StaticVector& lhs, const StaticVector& rhs) noexcept {
+    return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+  }
+
+ private:
+  std::array<T, Capacity> values_{};
+  std::size_t size_{0};
+};
+
+/**
+ * @brief An unsigned integer with at most `MaxLimbs` 64-bit limbs
+ * @tparam MaxLimbs The maximum number of limbs
+ *
+ * This class shares the limb algorithms with `BigUint`, but it keeps the limbs in a fixed-size array. It is intended
+ * for small intermediate values whose sizes are bounded in advance (e.g. the terms of the series), which would
+ * otherwise cost a heap allocation in every operation. Operations that would exceed the capacity throw
+ * `std::length_error`.
+ */
+template <std::size_t MaxLimbs>
+class StaticBigUint : public StaticVector<uint64_t, MaxLimbs> {
+ public:
+  // <Constructors>
+  /// Construct from a uint64 value
+  constexpr explicit StaticBigUint(uint64_t value) {
+    if (value > 0) {
+      this->push_back(value);
+    }
+  }
+  /// Construct from a uint128 value
+  constexpr explicit StaticBigUint(uint128_t value) {
+    while (value > 0) {
+      this->push_back(static_cast<uint64_t>(value));
+      value >>= 64;
+    }
+  }
+  /// Construct from a `BigUint`
+  constexpr explicit StaticBigUint(const BigUint& value) {
+    for (const auto& limb : value) {
+      this->push_back(limb);
+    }
+  }
+
+  constexpr StaticBigUint() = default;
+  // </Constructors>
+
+  // <Basic Methods>
+  constexpr bool IsZero() const noexcept { return this->empty(); }
+  constexpr uint64_t NumberOfBits() const { return detail::NumberOfBits(*this); }
+
+  /// Convert to `BigUint`
+  constexpr BigUint ToBigUint() const { return BigUint(std::vector<uint64_t>(this->begin(), this->end())); }
+  // </Basic Methods>
+
+  // <Operators>
+  template <std::size_t RhsLimbs>
+  constexpr StaticBigUint& operator+=(const StaticBigUint<RhsLimbs>& rhs) {
+    detail::AddAssign<uint128_t>(*this, rhs);
+    return *this;
+  }
+
+  /// @pre *this >= rhs
+  template <std::size_t RhsLimbs>
+  constexpr StaticBigUint& operator-=(const StaticBigUint<RhsLimbs>& rhs) {
+    detail::SubAssign(*this, rhs);
+    return *this;
+  }
+
+  template <std::size_t RhsLimbs>
+  constexpr StaticBigUint& operator*=(const StaticBigUint<RhsLimbs>& rhs) {
+    *this = *this * rhs;
+    return *this;
+  }
+
+  /// Multiply by a one-limb value in place. This is cheaper than multiplying by a `StaticBigUint`.
+  constexpr StaticBigUint& operator*=(uint64_t rhs) {
+    detail::MultiplyAssignLimb<uint128_t>(*this, rhs);
+    return *this;
+  }
+
+  constexpr StaticBigUint& operator>>=(std::size_t rhs) {
+    detail::ShiftRightAssign(*this, rhs);
+    return *this;
+  }
+
+  constexpr StaticBigUint& operator<<=(std::size_t rhs) {
+    detail::ShiftLeftAssign(*this, rhs);
+    return *this;
+  }
+
+  friend constexpr StaticBigUint operator+(StaticBigUint lhs, const StaticBigUint& rhs) {
+    lhs += rhs;
+    return lhs;
+  }
+
+  friend constexpr StaticBigUint operator-(StaticBigUint lhs, const StaticBigUint& rhs) {
+    lhs -= rhs;
+    return lhs;
+  }
+
+  /**
+   * @brief Multiply two numbers
+   * @throw `std::length_error` if the bit widths of the operands sum up to more than `MaxLimbs * 64`
+   */
+  template <std::size_t RhsLimbs>
+  friend constexpr StaticBigUint operator*(const StaticBigUint& lhs, const StaticBigUint<RhsLimbs>& rhs) {
+    if (lhs.NumberOfBits() + rhs.NumberOfBits() > MaxLimbs * 64) {
+      throw std::length_error("StaticVector capacity exceeded");
+    }
+
+    // The partial sums never exceed the product, so no carry reaches beyond `MaxLimbs` limbs
+    StaticBigUint ans;
+    ans.resize(std::min(lhs.size() + rhs.size(), MaxLimbs));
+    detail::MultiplyNaive<uint128_t>(ans, lhs, rhs);
+    return ans;
+  }
+
+  template <std::size_t RhsLimbs>
+  friend constexpr std::strong_ordering operator<=>(const StaticBigUint& lhs,
+                                                    const StaticBigUint<RhsLimbs>& rhs) noexcept {
+    return detail::Compare(lhs, rhs);
+  }
+
+  friend constexpr bool operator==(const StaticBigUint& lhs, const StaticBigUint& rhs) noexcept = default;
+  // </Operators>
+};
+}  // namespace komori
+
+#endif  // KOMORI_STATIC_BIGUINT_HPP_
@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include "bigfixed.hpp"
+
+using komori::BigFixed;
+using komori::BigInt;
+using komori::BigUint;
+using komori::Sign;
+
+namespace {
+/// |lhs - rhs| <= ulps * 2^(-frac_bits)
+bool IsNear(const BigFixed& lhs, const BigFixed& rhs, uint64_t ulps) {
+  const auto diff = lhs - rhs;
+  return diff.Raw().Abs() <= BigUint{ulps};
+}
+}  // namespace
+
+TEST(BigFixed, Arithmetic) {
+  const auto x = BigFixed(64, BigInt{3}) >> 1;  // 1.5
+  const auto y = BigFixed(64, BigInt{5}) >> 2;  // 1.25
+
+  EXPECT_EQ(x + y, BigFixed(64, BigInt{11}) >> 2);
+  EXPECT_EQ(x - y, BigFixed(64, BigInt{1}) >> 2);
+  EXPECT_EQ(y - x, -(BigFixed(64, BigInt{1}) >> 2));
+  EXPECT_EQ(x * y, BigFixed(64, BigInt{15}) >> 3);
+  EXPECT_EQ((x * y).IntegerPart(), BigInt{1});
+  EXPECT_EQ((x * y).FractionalPartRaw(), BigUint{7} << 61);
+  EXPECT_TRUE(y < x);
+  EXPECT_THROW(x + BigFixed(32, BigInt{1}), std::invalid_argument);
+}
+
+TEST(BigFixed, Reciprocal) {
+  const uint64_t frac_bits = 5000;
+  const BigFixed one{frac_bits, BigInt{1}};
+  const BigFixed x = BigFixed(frac_bits, BigInt{334}) / BigFixed(frac_bits, BigInt{264});
+
+  EXPECT_TRUE(IsNear(Reciprocal(BigFixed(frac_bits, BigInt{4})), one >> 2, 0));
+  EXPECT_TRUE(IsNear(x * Reciprocal(x), one, 4));
+  EXPECT_TRUE(IsNear(Reciprocal(-x), -Reciprocal(x), 0));
+  EXPECT_TRUE(IsNear(Reciprocal(one >> 1000) >> 1000, one, 1));
+  EXPECT_THROW(Reciprocal(BigFixed(frac_bits, BigInt{})), std::range_error);
+}
+
+TEST(BigFixed, InverseSqrt) {
+  const uint64_t frac_bits = 5000;
+  const BigFixed one{frac_bits, BigInt{1}};
+  const BigFixed x{frac_bits, BigInt{640320}};
+  const BigFixed y = BigFixed(frac_bits, BigInt{3}) >> 1001;
+
+  EXPECT_TRUE(IsNear(InverseSqrt(BigFixed(frac_bits, BigInt{4})), one >> 1, 0));
+  EXPECT_EQ(ToDecimalString(InverseSqrt(x)).substr(0, 60), "0.0012496876171386932276960543212938253123637559266453812425");
+  EXPECT_EQ(ToDecimalString(Sqrt(BigFixed(200, BigInt{2}))).substr(0, 52),
+            "1.41421356237309504880168872420969807856967187537694");
+  EXPECT_TRUE(IsNear(InverseSqrt(y) * InverseSqrt(y) * y, one, 1ULL << 12));
+  EXPECT_THROW(InverseSqrt(-x), std::out_of_range);
+}
+
+TEST(BigFixed, SqrtOfLargeAndTinyNumbers) {
+  const BigFixed one{64, BigInt{1}};
+  const BigFixed million{64, BigInt{1000000}};
+  const auto x = BigFixed(256, BigInt{1} << 400);
+  const auto y = BigFixed(256, BigInt{1}) >> 200;
+
+  EXPECT_TRUE(IsNear(Sqrt(million), BigFixed(64, BigInt{1000}), 2));
+  EXPECT_TRUE(IsNear(InverseSqrt(million), one / BigFixed(64, BigInt{1000}), 2));
+  EXPECT_TRUE(IsNear(Sqrt(x), BigFixed(256, BigInt{1} << 200), 2));
+  EXPECT_TRUE(IsNear(InverseSqrt(x), BigFixed(256, BigInt{1}) >> 200, 2));
+  EXPECT_TRUE(IsNear(Sqrt(y), BigFixed(256, BigInt{1}) >> 100, 2));
+  EXPECT_TRUE(IsNear(InverseSqrt(y), BigFixed(256, BigInt{1} << 100), 2));
+  EXPECT_EQ(ToDecimalString(Sqrt(BigFixed(200, BigInt{2}) << 300)).substr(0, 52),
+            ToDecimalString(Sqrt(BigFixed(200, BigInt{2})) << 150).substr(0, 52));
+}
+
+TEST(BigFixed, Divide) {
+  const uint64_t frac_bits = 3000;
+  const BigInt x = BigInt{0x334, 0x264, 0x1} << 5000;
+  const BigInt y = BigInt{0x264, 0x334, 0x2} << 5000;
+  const auto q = komori::Divide(x, y, frac_bits);
+
+  EXPECT_TRUE(IsNear(q * komori::Divide(y, x, frac_bits), BigFixed(frac_bits, BigInt{1}), 8));
+  EXPECT_TRUE(IsNear(komori::Divide(BigInt{1}, BigInt{3}, 64) * BigFixed(64, BigInt{3}), BigFixed(64, BigInt{1}), 4));
+  EXPECT_THROW(komori::Divide(BigInt{1}, BigInt{}, 64), std::range_error);
+}
+
+TEST(BigFixed, DivideLargeQuotient) {
+  const auto x = BigInt{BigUint{3}.Pow(300)};
+  const auto y = BigInt{BigUint{7}.Pow(100)};
+  const auto q = komori::Divide(x, y, 64);
+
+  // |q * y - x * 2^64| <= 4 * y
+  const auto residual = q.Raw() * y - (x << 64);
+  EXPECT_LE(residual.Abs(), (y << 2).Abs());
+  EXPECT_GT(q.IntegerPart(), BigInt{1} << 190);
+}
+
+TEST(BigFixed, DivideByFarFromOne) {
+  const uint64_t frac_bits = 179;
+  const auto x = BigFixed(frac_bits, BigInt{1} << 123);
+  const auto y = BigFixed(frac_bits, BigInt{3} << 222);
+  const auto q = x / y;
+
+  // x / y = 2^(-99) / 3
+  EXPECT_TRUE(IsNear(q * BigFixed(frac_bits, BigInt{3}), BigFixed(frac_bits, BigInt{1}) >> 99, 4));
+  EXPECT_TRUE(IsNear(y / x, BigFixed(frac_bits, BigInt{3} << 99), 0));
+  EXPECT_TRUE(IsNear(-x / y, -q, 0));
+  EXPECT_THROW(x / BigFixed(64, BigInt{1}), std::invalid_argument);
+}
+
+TEST(BigFixed, ToDecimalString) {
+  EXPECT_EQ(ToDecimalString(BigFixed(64, BigInt{5}) >> 1), "2.5000000000000000000");
+  EXPECT_EQ(ToDecimalString(-(BigFixed(64, BigInt{1}) >> 1)), "-0.5000000000000000000");
+  EXPECT_EQ(ToDecimalString(komori::Divide(BigInt{1}, BigInt{3}, 64)), "0.3333333333333333333");
+}
+
+TEST(BigFixed, WriteDecimalString) {
+  komori::StringDigitSink sink;
+  WriteDecimalString(sink, -(BigFixed(64, BigInt{1}) >> 1), 3);
+  EXPECT_EQ(sink.Str(), "-0.500");
+
+  const auto third = komori::Divide(BigInt{1}, BigInt{3}, 640);
+  komori::StringDigitSink third_sink;
+  WriteDecimalString(third_sink, third, 192, 16);
+  EXPECT_EQ(third_sink.Str(), "0." + std::string(192, '3'));
+}
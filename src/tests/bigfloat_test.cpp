@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 
 #include "bigfloat.hpp"
+#include "io.hpp"
 
 using komori::BigFloat;
 using komori::BigInt;
@@ -42,6 +43,17 @@ TEST(BigFloat, Add) {
   }
 }
 
+TEST(BigFloat, AddFarApart) {
+  // The bits of `y` below the precision of `x` are dropped
+  const BigFloat x = BigFloat(128, BigInt{1}) << 1000;
+  const BigFloat y = BigFloat(128, BigInt{0x334}) >> 1000;
+
+  EXPECT_EQ(((x + y) >> 1000).IntegerPart(), BigInt{1});
+  EXPECT_EQ((x + y).GetPrecision(), 128);
+  EXPECT_EQ(((y - x) >> 1000).IntegerPart(), BigInt(1, Sign::kNegative));
+  EXPECT_EQ(((y + (y << 5)) << 1000).IntegerPart(), BigInt{0x334 * 33});
+}
+
 TEST(BigFloat, Multiply) {
   const BigFloat x = BigFloat(128, BigInt{0x334ULL, 0x264ULL}) << 33;
   const BigFloat y = BigFloat(16, BigInt{0x44ULL, 0x5ULL}) >> 4;
@@ -123,4 +135,13 @@ TEST(BigFloat, Sqrt) {
   EXPECT_TRUE(y == (BigInt{0x123456789ABCDEF0ULL, 0xFEDCBA0987654321ULL}) ||
               y == (BigInt{0x123456789ABCDEEFULL, 0xFEDCBA0987654321ULL}))
       << y.DebugString();
-}
\ No newline at end of file
+}
+TEST(BigFloat, Divide) {
+  const BigFloat x = BigFloat(4000, BigInt{334}) / BigFloat(4000, BigInt{264});
+  const BigFloat y = BigFloat(4000, BigInt{0x123456789ABCDEF0ULL, 0xFEDCBA0987654321ULL}) >> 334;
+
+  // (x / y) * y == x within the precision
+  const BigFloat diff = Divide(x, y) * y - x;
+  EXPECT_TRUE(diff.IsZero() || (diff << 3990).IntegerPart() == BigInt{}) << diff.DebugString();
+  EXPECT_EQ(ToString(Sqrt(BigFloat(4000, BigInt{2}))).substr(0, 52), "1.41421356237309504880168872420969807856967187537694");
+}
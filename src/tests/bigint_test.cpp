@@ -84,6 +84,16 @@ TEST(BigInt, Shr) {
   EXPECT_EQ((-x) >> 4, -expected);
 }
 
+TEST(BigInt, ShlAddAssign) {
+  const BigInt x(0x334ULL);
+  const BigInt y(0x264ULL);
+
+  EXPECT_EQ(BigInt{x}.ShlAddAssign(y, 70), x + (y << 70));
+  EXPECT_EQ(BigInt{x}.ShlAddAssign(-y, 70), x - (y << 70));
+  EXPECT_EQ(BigInt{-x}.ShlAddAssign(y, 1), (y << 1) - x);
+  EXPECT_EQ(BigInt{x << 1}.ShlAddAssign(-x, 1), BigInt{});
+}
+
 TEST(BigInt, Comparison) {
   const BigInt x(0x334ULL);
   const BigInt y(0x264ULL);
@@ -181,6 +181,28 @@ TEST(BigUint, ShlAddAssign) {
   EXPECT_EQ(z5, (BigUint{0x334ULL, 0x0ULL, 0x264ULL}));
 }
 
+TEST(BigUint, ShlSubAssign) {
+  const BigUint x{0x1234567890abcdefULL, 0xfedcba0987654321ULL, 0x334000ULL};
+  const BigUint y{0x8000000000000001ULL, 0x264ULL};
+
+  for (const std::size_t shift : {0, 1, 63, 64, 65}) {
+    auto z = x;
+    z.ShlSubAssign(y, shift);
+    EXPECT_EQ(z, x - (y << shift)) << shift;
+    EXPECT_EQ(x.CompareShl(y, shift), std::strong_ordering::greater);
+    EXPECT_EQ((y << shift).CompareShl(y, shift), std::strong_ordering::equal);
+
+    auto w = y;
+    w.ShlReverseSubAssign(x, shift);
+    EXPECT_EQ(w, (x << shift) - y) << shift;
+  }
+
+  auto z = y;
+  EXPECT_THROW(z.ShlSubAssign(x, 0), std::out_of_range);
+  z = x;
+  EXPECT_THROW(z.ShlReverseSubAssign(y, 1), std::out_of_range);
+}
+
 TEST(BigUint, ShiftMod2Pow) {
   const BigUint x{0x1234567890abcdefULL, 0xfedcba0987654321ULL};
 
@@ -193,3 +215,28 @@ TEST(BigUint, ShiftMod2Pow) {
     }
   }
 }
+
+TEST(BigUint32, Arithmetic) {
+  using komori::BigUint32;
+  using komori::LimbCast;
+
+  const BigUint x{0x8000000000000000ULL, 0xFFFFFFFFFFFFFFFEULL, 0x334ULL};
+  const BigUint y{0x1234567890ABCDEFULL, 0x264ULL};
+  const auto x32 = LimbCast<BigUint32>(x);
+  const auto y32 = LimbCast<BigUint32>(y);
+
+  EXPECT_EQ(x32, (BigUint32{0x0, 0x80000000, 0xFFFFFFFE, 0xFFFFFFFF, 0x334}));
+  EXPECT_EQ(LimbCast<BigUint>(x32), x);
+  EXPECT_EQ(LimbCast<BigUint32>(BigUint{}), BigUint32{});
+  EXPECT_EQ(x32.NumberOfBits(), x.NumberOfBits());
+  EXPECT_EQ(static_cast<uint64_t>(BigUint32(0x1234567890ABCDEFULL)), 0x1234567890ABCDEFULL);
+  EXPECT_EQ(BigUint32(0x1234567890ABCDEFULL).DebugString(), "0x1234567890abcdef");
+
+  EXPECT_EQ(LimbCast<BigUint>(x32 + y32), x + y);
+  EXPECT_EQ(LimbCast<BigUint>(x32 - y32), x - y);
+  EXPECT_EQ(LimbCast<BigUint>(x32 * y32), x * y);
+  EXPECT_EQ(LimbCast<BigUint>(x32 << 77), x << 77);
+  EXPECT_EQ(LimbCast<BigUint>(x32 >> 77), x >> 77);
+  EXPECT_EQ(LimbCast<BigUint>(x32.ShiftMod2Pow(33, 100)), x.ShiftMod2Pow(33, 100));
+  EXPECT_EQ(LimbCast<BigUint>(BigUint32{3}.Pow(100)), BigUint{3}.Pow(100));
+}
@@ -0,0 +1,35 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include "checkpoint.hpp"
+
+using komori::BigFixed;
+using komori::BigInt;
+using komori::Checkpoint;
+
+TEST(Checkpoint, SaveLoad) {
+  const auto directory = std::filesystem::temp_directory_path() / "komori_checkpoint_test";
+  std::filesystem::remove_all(directory);
+
+  const Checkpoint checkpoint{directory};
+  const BigInt x{0x334, 0x264};
+  const auto y = BigFixed(100, BigInt{5}) >> 3;
+
+  EXPECT_FALSE(checkpoint.Exists("xy"));
+  EXPECT_FALSE((checkpoint.Load<BigInt, BigFixed>("xy")));
+
+  checkpoint.Save("xy", x, y);
+  EXPECT_TRUE(checkpoint.Exists("xy"));
+  EXPECT_EQ((checkpoint.Load<BigInt, BigFixed>("xy")), std::make_tuple(x, y));
+  // Another instance sees the saved entries
+  EXPECT_TRUE(Checkpoint{directory}.Exists("xy"));
+
+  // A broken entry is treated as missing
+  std::ofstream(directory / "xy.bin", std::ios::binary | std::ios::app) << "garbage";
+  EXPECT_TRUE((checkpoint.Load<BigInt, BigFixed>("xy")));
+  std::ofstream(directory / "xy.bin", std::ios::binary | std::ios::trunc) << "garbage";
+  EXPECT_FALSE((checkpoint.Load<BigInt, BigFixed>("xy")));
+
+  std::filesystem::remove_all(directory);
+}
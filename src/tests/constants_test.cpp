@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+
+#include <limits>
+#include "constants.hpp"
+
+using komori::GetConstantString;
+
+namespace {
+const auto kE = [](uint64_t digits) { return komori::ComputeE(digits); };
+const auto kLn2 = [](uint64_t digits) { return komori::ComputeLn2(digits); };
+const auto kZeta3 = [](uint64_t digits) { return komori::ComputeZeta3(digits); };
+const auto kCatalan = [](uint64_t digits) { return komori::ComputeCatalan(digits); };
+const auto kGoldenRatio = [](uint64_t digits) { return komori::ComputeGoldenRatio(digits); };
+}  // namespace
+
+TEST(Constants, Compute) {
+  EXPECT_EQ(GetConstantString(kE, 50), "2.71828182845904523536028747135266249775724709369995");
+  EXPECT_EQ(GetConstantString(kLn2, 50), "0.69314718055994530941723212145817656807550013436025");
+  EXPECT_EQ(GetConstantString(kZeta3, 50), "1.20205690315959428539973816151144999076498629234049");
+  EXPECT_EQ(GetConstantString(kCatalan, 50), "0.91596559417721901505460351493238411077414937428167");
+  EXPECT_EQ(GetConstantString(kGoldenRatio, 50), "1.61803398874989484820458683436563811772030917980576");
+
+  // The same digits with the parallel driver, the leaf blocks and the common-factor removal
+  const komori::SeriesOptions factored{.remove_common_factors = true};
+  const auto e = GetConstantString(kE, 2000);
+  EXPECT_EQ(e.substr(0, 12), "2.7182818284");
+  EXPECT_EQ(GetConstantString([&](uint64_t digits) { return komori::ComputeE(digits, factored); }, 2000), e);
+  const auto zeta3 = GetConstantString(kZeta3, 2000);
+  EXPECT_EQ(GetConstantString([&](uint64_t digits) { return komori::ComputeZeta3(digits, factored); }, 2000), zeta3);
+  EXPECT_EQ(GetConstantString(kZeta3, 3000).substr(0, 2002), zeta3);
+  const auto catalan = GetConstantString(kCatalan, 2000);
+  EXPECT_EQ(GetConstantString([&](uint64_t digits) { return komori::ComputeCatalan(digits, factored); }, 2000),
+            catalan);
+  EXPECT_EQ(GetConstantString(kCatalan, 3000).substr(0, 2002), catalan);
+}
+
+TEST(Constants, ComputeNearDigitBoundary) {
+  // The digits after the last ones are 00..., so approximations slightly below the constants are off by one
+  EXPECT_EQ(GetConstantString(kLn2, 40).substr(37), "80755");
+  EXPECT_EQ(GetConstantString(kE, 327).substr(324), "84583");
+}
+
+TEST(Constants, Series) {
+  // Each series is summed to the bits it promises
+  const komori::Ln2Series ln2;
+  const auto [p, q, t] = komori::ComputeSeriesRange(ln2, 0, ln2.TermsFor(300), false);
+  EXPECT_EQ(ToDecimalString(komori::Divide(komori::Evaluate((komori::Lazy(q) * 3 + komori::Lazy(t) * 3)),
+                                           komori::Evaluate(komori::Lazy(q) * 4), 100))
+                .substr(0, 22),
+            "0.69314718055994530941");
+
+  // The driver agrees with the serial binary splitting
+  const komori::CatalanSeries catalan;
+  komori::ThreadPool pool(4);
+  komori::detail::SeriesDriver driver{catalan, pool, std::numeric_limits<uint64_t>::max(), 100};
+  const auto [p2, q2, t2] = komori::detail::ComputePQT(catalan, 0, 400);
+  EXPECT_EQ(driver.Compute(400), std::make_tuple(komori::BigInt{}, q2, t2));
+  EXPECT_EQ(komori::detail::ComputePQTParallel(catalan, 0, 400, pool, 100), std::make_tuple(p2, q2, t2));
+}
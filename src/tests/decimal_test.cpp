@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+#include "decimal.hpp"
+
+using komori::BigFloat;
+using komori::BigInt;
+using komori::BigUint;
+using komori::DecimalBigUint;
+
+namespace {
+DecimalBigUint MakeRandomDecimalBigUint(std::size_t len, std::mt19937_64& mt) {
+  std::uniform_int_distribution<std::uint64_t> dist(0, komori::kDecimalBase - 1);
+  std::vector<uint64_t> values;
+  for (std::size_t i = 0; i < len; ++i) {
+    values.push_back(dist(mt));
+  }
+  return DecimalBigUint{std::move(values)};
+}
+}  // namespace
+
+TEST(DecimalBigUint, Basic) {
+  EXPECT_TRUE(DecimalBigUint{}.IsZero());
+  EXPECT_EQ(DecimalBigUint{}.ToString(), "0");
+  EXPECT_EQ(DecimalBigUint(18446744073709551615ULL), (DecimalBigUint{8446744073709551615ULL, 1}));
+  EXPECT_EQ(DecimalBigUint(18446744073709551615ULL).ToString(), "18446744073709551615");
+  EXPECT_EQ((DecimalBigUint{334, 264}).ToString(), "2640000000000000000334");
+  EXPECT_EQ((DecimalBigUint{334, 264}).NumberOfDigits(), 22ULL);
+  EXPECT_EQ(DecimalBigUint{2}.Pow(64).ToString(), "18446744073709551616");
+  static_assert((DecimalBigUint{334, 264}).ToString() == "2640000000000000000334");
+  static_assert(DecimalBigUint{2}.Pow(64).ToString() == "18446744073709551616");
+}
+
+TEST(DecimalBigUint, AddSub) {
+  const DecimalBigUint x{9999999999999999999ULL, 9999999999999999999ULL};
+  const DecimalBigUint y{1};
+
+  EXPECT_EQ(x + y, (DecimalBigUint{0, 0, 1}));
+  EXPECT_EQ((x + y) - y, x);
+  EXPECT_EQ(x - x, DecimalBigUint{});
+  EXPECT_THROW(y - x, std::out_of_range);
+}
+
+TEST(DecimalBigUint, Multiply) {
+  std::mt19937_64 mt(334);
+  const auto x = MakeRandomDecimalBigUint(200, mt);
+  const auto y = MakeRandomDecimalBigUint(150, mt);
+
+  const auto naive = MultiplyNaive(x, y);
+  EXPECT_EQ(MultiplyKaratsuba(x, y), naive);
+  EXPECT_EQ(MultiplyNTT(x, y), naive);
+  EXPECT_EQ(x * y, naive);
+  EXPECT_EQ(MultiplyNTT(x, DecimalBigUint{}), DecimalBigUint{});
+}
+
+TEST(DecimalBigUint, Conversion) {
+  std::mt19937_64 mt(264);
+  std::uniform_int_distribution<std::uint64_t> dist;
+  std::vector<uint64_t> values;
+  for (std::size_t i = 0; i < 300; ++i) {
+    values.push_back(dist(mt));
+  }
+  const BigUint x{std::move(values)};
+
+  const auto decimal = ToDecimal(x);
+  EXPECT_EQ(decimal.ToString(), ToString(x));
+  EXPECT_EQ(ToBinary(decimal), x);
+  EXPECT_EQ(ToDecimal(BigUint{}), DecimalBigUint{});
+  EXPECT_EQ(ToBinary(DecimalBigUint{}), BigUint{});
+  static_assert(ToDecimal(BigUint{0, 1}).ToString() == "18446744073709551616");
+}
+
+TEST(DecimalBigUint, ToDecimalString) {
+  const BigFloat x = BigFloat(256, BigInt{334334334334ULL}) / BigFloat(256, BigInt{1000000000ULL});
+  const auto s = ToDecimalString(x);
+  EXPECT_EQ(s.substr(0, 60), ToString(x).substr(0, 60));
+  EXPECT_EQ(ToDecimalString(BigFloat(64, BigInt{5}) >> 1), "2.500000000000000000");
+}
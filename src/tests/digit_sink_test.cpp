@@ -0,0 +1,52 @@
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "digit_sink.hpp"
+
+using komori::CallbackDigitSink;
+using komori::ChunkedDigitSink;
+
+TEST(DigitSink, Chunked) {
+  std::vector<std::string> chunks;
+  CallbackDigitSink sink{[&](std::string_view digits) { chunks.emplace_back(digits); }};
+  ChunkedDigitSink chunked{sink, 4};
+
+  chunked.Write("3.");
+  chunked.Write("1415926535");
+  chunked.Write("");
+  chunked.Write("8");
+  EXPECT_EQ(chunks, (std::vector<std::string>{"3.14", "1592", "6535"}));
+
+  chunked.Flush();
+  chunked.Flush();
+  EXPECT_EQ(chunks, (std::vector<std::string>{"3.14", "1592", "6535", "8"}));
+}
+
+TEST(DigitSink, Stream) {
+  std::ostringstream os;
+  komori::OstreamDigitSink sink{os};
+  sink.Write("3.14");
+  sink.Write("159");
+  EXPECT_EQ(os.str(), "3.14159");
+}
+
+TEST(DigitSink, Fd) {
+  int fds[2];
+  ASSERT_EQ(::pipe(fds), 0);
+
+  komori::FdDigitSink sink{fds[1]};
+  sink.Write("2.71828");
+  ::close(fds[1]);
+
+  char buf[16]{};
+  EXPECT_EQ(::read(fds[0], buf, sizeof(buf)), 7);
+  EXPECT_EQ(std::string_view(buf), "2.71828");
+  ::close(fds[0]);
+
+  EXPECT_THROW(komori::FdDigitSink{-1}.Write("1"), komori::DigitSinkError);
+}
@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <random>
+#include <string>
+#include "digit_writer.hpp"
+#include "io.hpp"
+
+using komori::DigitFileWriter;
+using komori::DigitWriterOptions;
+
+namespace {
+std::string ReadFile(const std::filesystem::path& path) {
+  std::ifstream is(path, std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+}
+
+/// A path in the temporary directory that no other test or process uses
+std::filesystem::path UniquePath(const std::string& name) {
+  static std::atomic<uint64_t> counter{0};
+  return std::filesystem::temp_directory_path() /
+         ("komori_" + name + "_" + std::to_string(::getpid()) + "_" + std::to_string(counter++) + ".txt");
+}
+
+std::string MakeRandomDigits(std::size_t len, std::mt19937_64& mt) {
+  std::uniform_int_distribution<int> dist(0, 9);
+  std::string digits(len, '0');
+  for (auto& c : digits) {
+    c = static_cast<char>('0' + dist(mt));
+  }
+  return digits;
+}
+}  // namespace
+
+TEST(DigitFileWriter, Write) {
+  const auto path = UniquePath("digit_writer_test");
+  std::mt19937_64 mt(334);
+  const auto digits = MakeRandomDigits(50000, mt);
+
+  // Every backend writes the same file, including a partial last buffer that is padded for O_DIRECT
+  for (const bool use_io_uring : {true, false}) {
+    for (const bool use_direct_io : {true, false}) {
+      DigitWriterOptions options;
+      options.buffer_size = 5000;
+      options.use_io_uring = use_io_uring;
+      options.use_direct_io = use_direct_io;
+
+      DigitFileWriter writer{path, options};
+      for (std::size_t i = 0; i < digits.size(); i += 777) {
+        writer.Write(std::string_view(digits).substr(i, 777));
+      }
+      writer.Close();
+
+      EXPECT_EQ(ReadFile(path), digits);
+      const auto& stats = writer.Stats();
+      EXPECT_EQ(stats.bytes, digits.size());
+      // 5000 is rounded up to 8192, so there are six full buffers and a partial one
+      EXPECT_EQ(stats.writes, 7ULL);
+      EXPECT_GT(stats.BytesPerSecond(), 0);
+      if (!use_io_uring) {
+        EXPECT_FALSE(stats.io_uring);
+      }
+      if (!use_direct_io) {
+        EXPECT_FALSE(stats.direct_io);
+      }
+    }
+  }
+  std::filesystem::remove(path);
+}
+
+TEST(DigitFileWriter, WriteString) {
+  const auto path = UniquePath("digit_writer_string_test");
+  const auto x = komori::BigFloat(20000, komori::BigInt{1}) / komori::BigFloat(20000, komori::BigInt{7});
+  {
+    DigitFileWriter writer{path};
+    WriteString(writer, x, 1000);
+  }
+  EXPECT_EQ(ReadFile(path), ToString(x));
+  std::filesystem::remove(path);
+
+  EXPECT_THROW(DigitFileWriter(path / "missing" / "file.txt"), komori::DigitSinkError);
+}
+
+TEST(DigitFileWriter, WriteError) {
+  const auto count_fds = [] {
+    const std::filesystem::directory_iterator fds{"/proc/self/fd"};
+    return std::distance(begin(fds), end(fds));
+  };
+  std::mt19937_64 mt(264);
+  const auto digits = MakeRandomDigits(5 * 4096, mt);
+
+  // Every write to /dev/full fails with ENOSPC. The file is closed when the error is thrown.
+  for (const bool use_io_uring : {true, false}) {
+    const auto num_fds = count_fds();
+    DigitWriterOptions options;
+    options.buffer_size = 4096;
+    options.use_io_uring = use_io_uring;
+    options.use_direct_io = false;
+
+    DigitFileWriter writer{"/dev/full", options};
+    EXPECT_THROW(writer.Write(digits), komori::DigitSinkError);
+    EXPECT_EQ(count_fds(), num_fds);
+    EXPECT_THROW(writer.Write(digits), komori::DigitSinkError);
+    EXPECT_NO_THROW(writer.Close());
+  }
+
+  // A buffer size whose length does not fit in a write request is clamped
+  DigitWriterOptions options;
+  options.buffer_size = std::numeric_limits<std::size_t>::max();
+  options.use_direct_io = false;
+  EXPECT_NO_THROW(DigitFileWriter("/dev/null", options));
+}
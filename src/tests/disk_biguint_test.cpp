@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <random>
+#include <vector>
+#include "disk_biguint.hpp"
+
+using komori::BigUint;
+using komori::DiskBigUint;
+using komori::ScratchDirectory;
+
+namespace {
+BigUint MakeRandomBigUint(std::size_t len, std::mt19937_64& mt) {
+  std::uniform_int_distribution<std::uint64_t> dist;
+  std::vector<uint64_t> values;
+  for (std::size_t i = 0; i < len; ++i) {
+    values.push_back(dist(mt));
+  }
+  return BigUint{std::move(values)};
+}
+}  // namespace
+
+TEST(DiskBigUint, Storage) {
+  const auto directory = std::filesystem::temp_directory_path() / "komori_disk_biguint_test";
+  std::filesystem::remove_all(directory);
+  const ScratchDirectory scratch{directory};
+
+  std::mt19937_64 mt(334);
+  const auto x = MakeRandomBigUint(100, mt);
+  {
+    DiskBigUint disk_x{scratch, x};
+    EXPECT_EQ(disk_x.ToBigUint(), x);
+    EXPECT_EQ(disk_x.NumberOfBits(), x.NumberOfBits());
+
+    disk_x.Resize(150);
+    EXPECT_EQ(disk_x.ToBigUint(), x);
+    disk_x.ShrinkToFit();
+    EXPECT_EQ(disk_x.size(), x.size());
+
+    const DiskBigUint moved{std::move(disk_x)};
+    EXPECT_EQ(moved.ToBigUint(), x);
+    EXPECT_EQ(DiskBigUint(scratch, 10).NumberOfBits(), 0ULL);
+  }
+
+  // The files are unlinked as soon as they are created
+  EXPECT_TRUE(std::filesystem::is_empty(directory));
+  std::filesystem::remove_all(directory);
+}
+
+TEST(DiskBigUint, Arithmetic) {
+  const auto directory = std::filesystem::temp_directory_path() / "komori_disk_biguint_arithmetic_test";
+  const ScratchDirectory scratch{directory};
+
+  std::mt19937_64 mt(264);
+  const auto x = MakeRandomBigUint(300, mt);
+  const auto y = MakeRandomBigUint(200, mt);
+  const DiskBigUint disk_x{scratch, x};
+  const DiskBigUint disk_y{scratch, y};
+
+  EXPECT_EQ((disk_x + disk_y).ToBigUint(), x + y);
+  EXPECT_EQ((disk_y + disk_x).ToBigUint(), x + y);
+  for (const uint64_t shift : {0, 1, 63, 64, 65, 1000}) {
+    EXPECT_EQ((disk_x << shift).ToBigUint(), x << shift);
+    EXPECT_EQ((disk_x >> shift).ToBigUint(), x >> shift);
+  }
+  EXPECT_EQ((disk_x >> 300 * 64).NumberOfBits(), 0ULL);
+
+  EXPECT_EQ(Multiply(disk_x, disk_y).ToBigUint(), x * y);
+  EXPECT_EQ(komori::detail::MultiplyOutOfCore(disk_x, disk_y).ToBigUint(), x * y);
+  EXPECT_EQ(komori::detail::MultiplyOutOfCore(disk_y, disk_y).ToBigUint(), y * y);
+
+  const auto z = MakeRandomBigUint(5000, mt);
+  const DiskBigUint disk_z{scratch, z};
+  EXPECT_EQ(komori::detail::MultiplyOutOfCore(disk_z, disk_x).ToBigUint(), z * x);
+
+  std::filesystem::remove_all(directory);
+}
@@ -0,0 +1,52 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include "distributed.hpp"
+#include "pi.hpp"
+
+TEST(DistributedSeries, ComputeRange) {
+  const komori::ChudnovskySeries series;
+  const auto [p, q, t] = komori::detail::ComputePQT(series, 0, 300);
+
+  // Every merge is sent to the workers
+  komori::DistributedSeries distributed{series, 3, 0};
+  EXPECT_EQ(distributed.NumWorkers(), 3ULL);
+  EXPECT_EQ(distributed.ComputeRange(0, 300, true), std::make_tuple(p, q, t));
+  EXPECT_GT(distributed.RemoteProducts(), 0ULL);
+  // P of the rightmost range is not needed
+  EXPECT_EQ(distributed.ComputeRange(0, 300, false), std::make_tuple(komori::BigInt{}, q, t));
+  // Fewer terms than workers
+  EXPECT_EQ(distributed.ComputeRange(10, 12, true), komori::detail::ComputePQT(series, 10, 12));
+
+  komori::DistributedSeries local{series, 0};
+  EXPECT_EQ(local.ComputeRange(0, 300, true), std::make_tuple(p, q, t));
+
+  komori::PiWorkers workers{series, 2};
+  auto plan = komori::MakePiPlan(1000);
+  EXPECT_EQ(ToDecimalString(komori::ComputePi(plan, workers)).substr(0, 1002), komori::GetPiString(1000));
+  // The workers compute neither the factored series nor spilled subtrees
+  plan.remove_common_factors = true;
+  EXPECT_THROW(komori::ComputePi(plan, workers), std::invalid_argument);
+}
+
+TEST(DistributedSeries, Checkpoint) {
+  const auto directory = std::filesystem::temp_directory_path() / "komori_distributed_checkpoint_test";
+  std::filesystem::remove_all(directory);
+
+  komori::PiWorkers workers{komori::ChudnovskySeries{}, 2};
+  auto plan = komori::MakePiPlan(1000);
+  plan.checkpoint_directory = directory.string();
+
+  komori::SeriesReport first;
+  EXPECT_EQ(ToDecimalString(komori::ComputePi(plan, workers, &first)).substr(0, 1002), komori::GetPiString(1000));
+  EXPECT_EQ(first.loaded_subtrees, 0ULL);
+
+  // The ranges of the workers are loaded
+  const komori::Checkpoint checkpoint{directory};
+  const auto [p, q, t] = komori::detail::ComputeSeriesByWorkers(plan, workers, nullptr, nullptr);
+  komori::SeriesReport second;
+  EXPECT_EQ(komori::detail::ComputeSeriesByWorkers(plan, workers, &second, &checkpoint), std::make_tuple(p, q, t));
+  EXPECT_EQ(second.loaded_subtrees, 2ULL);
+
+  std::filesystem::remove_all(directory);
+}
@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+#include "expr.hpp"
+
+using komori::BigInt;
+using komori::BigUint;
+using komori::Lazy;
+using komori::Sign;
+
+namespace {
+BigUint MakeRandomBigUint(std::size_t len, std::mt19937_64& mt) {
+  std::uniform_int_distribution<std::uint64_t> dist;
+  std::vector<uint64_t> values;
+  for (std::size_t i = 0; i < len; ++i) {
+    values.push_back(dist(mt));
+  }
+  return BigUint{std::move(values)};
+}
+}  // namespace
+
+TEST(Expr, BigUint) {
+  std::mt19937_64 mt(334);
+  const auto x = MakeRandomBigUint(3, mt);
+  const auto y = MakeRandomBigUint(100, mt);
+  const auto z = MakeRandomBigUint(70, mt);
+  const auto w = MakeRandomBigUint(80, mt);
+
+  EXPECT_EQ(Evaluate(Lazy(x) * Lazy(y)), x * y);
+  EXPECT_EQ(Evaluate(Lazy(x) * Lazy(y) + Lazy(z) * Lazy(w)), x * y + z * w);
+  EXPECT_EQ(Evaluate(Lazy(z) * Lazy(w) + Lazy(x)), z * w + x);
+  EXPECT_EQ(Evaluate((Lazy(x) * Lazy(y) + Lazy(z)) * 334), (x * y + z) * BigUint{334});
+  EXPECT_EQ(Evaluate(Lazy(z) * Lazy(w) * 264 + Lazy(y) * 334), z * w * BigUint{264} + y * BigUint{334});
+  EXPECT_EQ(Evaluate(Lazy(BigUint{}) * Lazy(x)), BigUint{});
+}
+
+TEST(Expr, BigInt) {
+  const auto x = BigInt{0x334ULL, 0x264ULL};
+  const auto y = BigInt{0x264ULL, 0x334ULL};
+  const auto z = BigInt{0x1ULL};
+
+  EXPECT_EQ(Evaluate(Lazy(x) * Lazy(y) + Lazy(z)), x * y + z);
+  EXPECT_EQ(Evaluate(Lazy(x) * Lazy(-y) + Lazy(z)), x * (-y) + z);
+  EXPECT_EQ(Evaluate(Lazy(-x) * Lazy(-y) + Lazy(-z) * 3), x * y - BigInt{3});
+  EXPECT_EQ(Evaluate(Lazy(-z) * Lazy(z) + Lazy(z)), BigInt{});
+  EXPECT_EQ(Evaluate(Lazy(-x) * 12), BigInt(x.Abs() * BigUint{12}, Sign::kNegative));
+}
+
+TEST(Expr, FusedSSA) {
+  std::mt19937_64 mt(264);
+  const auto x = MakeRandomBigUint(4200, mt);
+  const auto y = MakeRandomBigUint(4300, mt);
+  const auto z = MakeRandomBigUint(4250, mt);
+
+  EXPECT_EQ(Evaluate(Lazy(x) * Lazy(y) + Lazy(z) * Lazy(y)), MultiplyKaratsuba(x + z, y));
+  EXPECT_EQ(Evaluate(Lazy(x) * Lazy(x) + Lazy(z) * Lazy(y) + Lazy(x)),
+            MultiplyKaratsuba(x, x) + MultiplyKaratsuba(z, y) + x);
+}
@@ -0,0 +1,40 @@
+#include <gtest/gtest.h>
+
+#include "factorization.hpp"
+
+using komori::BigUint;
+using komori::Factorization;
+using komori::PrimeSieve;
+
+TEST(Factorization, Arithmetic) {
+  const Factorization x{{{2, 3}, {5, 1}, {7, 2}}};  // 1960
+  const Factorization y{{{2, 1}, {3, 4}, {7, 5}}};  // 2 * 3^4 * 7^5
+
+  EXPECT_EQ(x.ToBigUint(), BigUint{1960});
+  EXPECT_EQ(Factorization{}.ToBigUint(), BigUint{1});
+  EXPECT_EQ(x * y, Factorization({{2, 4}, {3, 4}, {5, 1}, {7, 7}}));
+  EXPECT_EQ(x * y / y, x);
+  EXPECT_EQ(Gcd(x, y), Factorization({{2, 1}, {7, 2}}));
+  EXPECT_EQ(x.Pow(3).ToBigUint(), BigUint{1960ULL * 1960 * 1960});
+  EXPECT_TRUE((x / x).IsOne());
+  EXPECT_THROW(x / y, std::invalid_argument);
+}
+
+TEST(Factorization, ToBigUint) {
+  const Factorization x{{{2, 100}, {3, 200}, {65537, 30}}};
+  EXPECT_EQ(x.ToBigUint(), (BigUint{1} << 100) * BigUint{3}.Pow(200) * BigUint{65537}.Pow(30));
+}
+
+TEST(PrimeSieve, Factorize) {
+  const PrimeSieve sieve{1000};
+
+  EXPECT_EQ(sieve.Limit(), 1000ULL);
+  EXPECT_TRUE(sieve.Factorize(1).IsOne());
+  EXPECT_EQ(sieve.Factorize(997), Factorization({{997, 1}}));
+  EXPECT_EQ(sieve.Factorize(360), Factorization({{2, 3}, {3, 2}, {5, 1}}));
+  EXPECT_EQ(sieve.Factorize(640320ULL * 640320 * 640320 / 24),
+            Factorization({{2, 15}, {3, 2}, {5, 3}, {23, 3}, {29, 3}}));
+  EXPECT_EQ(sieve.Factorize(2 * 1000003ULL), Factorization({{2, 1}, {1000003, 1}}));
+  EXPECT_THROW(sieve.Factorize(1009ULL * 1013), std::out_of_range);
+  EXPECT_THROW(sieve.Factorize(0), std::out_of_range);
+}
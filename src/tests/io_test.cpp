@@ -1,11 +1,28 @@
 #include <gtest/gtest.h>
 
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "decimal.hpp"
 #include "io.hpp"
 
 using komori::BigFloat;
 using komori::BigInt;
 using komori::BigUint;
 
+namespace {
+BigUint MakeRandomBigUint(std::size_t len, std::mt19937_64& mt) {
+  std::uniform_int_distribution<std::uint64_t> dist;
+  std::vector<uint64_t> values;
+  for (std::size_t i = 0; i < len; ++i) {
+    values.push_back(dist(mt));
+  }
+  return BigUint{std::move(values)};
+}
+}  // namespace
+
 TEST(OutputOperator, BigUint) {
   const auto x = BigUint{0x38c497e5596ef57eULL, 0x4da120763f11e267ULL, 0xefdf8ULL};
   const auto y = BigUint{0xb6d5a4843a6d2a48ULL, 0xdfd9cd030565836eULL, 0xbd99aULL};
@@ -20,6 +37,108 @@ TEST(OutputOperator, BigUint) {
             "264264264264264264264264264264264264264264264");
 }
 
+TEST(OutputOperator, ScaledRemainderTree) {
+  // Long numbers with many digits at the boundaries of the nodes, compared with the exact radix conversion
+  const auto pow10 = BigUint{10}.Pow(1000);
+  EXPECT_EQ(ToString(pow10), "1" + std::string(1000, '0'));
+  EXPECT_EQ(ToString(pow10 - BigUint{1}), std::string(1000, '9'));
+  EXPECT_EQ(ToString(pow10 + BigUint{1}), "1" + std::string(999, '0') + "1");
+
+  BigUint x{1};
+  for (int i = 0; i < 40; ++i) {
+    x = x * BigUint{0x9e3779b97f4a7c15ULL} + BigUint{static_cast<uint64_t>(i)};
+    EXPECT_EQ(ToString(x), komori::ToDecimal(x).ToString());
+    EXPECT_EQ(ToString(x * pow10), komori::ToDecimal(x).ToString() + std::string(1000, '0'));
+  }
+}
+
+TEST(ScaledRemainderTree, ConvertFraction) {
+  komori::PowerTable table;
+  komori::detail::ScaledRemainderTree tree{table};
+
+  // 1/2^k has exactly k digits, so the truncations of the exact values end with the boundaries of the digits
+  for (const uint64_t frac_bits : {1, 10, 64, 200, 1000}) {
+    const auto digit_len = frac_bits;
+    const auto frac = BigUint{1};
+    const auto expected = (komori::ToDecimal(frac) * komori::DecimalBigUint{5}.Pow(frac_bits)).ToString();
+
+    std::string ans(digit_len, '0');
+    tree.ConvertFraction(frac, frac_bits, digit_len, ans, 0);
+    EXPECT_EQ(ans, std::string(digit_len - expected.size(), '0') + expected);
+  }
+
+  // 1 - 2^(-1000) = 0.999...9 followed by the digits of 10^1000 - 5^1000, with 1000 digits in total
+  const auto frac = (BigUint{1} << 1000) - BigUint{1};
+  std::string ans(301, '0');
+  tree.ConvertFraction(frac, 1000, 301, ans, 0);
+  EXPECT_EQ(ans, std::string(301, '9'));
+}
+
+TEST(ScaledRemainderTree, Parallel) {
+  std::mt19937_64 mt(334);
+  const auto frac = MakeRandomBigUint(4000, mt);
+  const uint64_t frac_bits = 64 * 4000;
+  const uint64_t digit_len = 77000;
+
+  komori::PowerTable table;
+  std::string serial(digit_len, '0');
+  komori::detail::ScaledRemainderTree{table}.ConvertFraction(frac, frac_bits, digit_len, serial, 0);
+
+  komori::ThreadPool pool(4);
+  std::string parallel(digit_len + 2, '-');
+  komori::detail::ScaledRemainderTree{table, &pool}.ConvertFraction(frac, frac_bits, digit_len, parallel, 1);
+  EXPECT_EQ(parallel, "-" + serial + "-");
+  EXPECT_EQ(komori::detail::FractionToDecimalString(frac, frac_bits, digit_len), serial);
+}
+
+TEST(ScaledRemainderTree, Stream) {
+  std::mt19937_64 mt(264);
+  const auto frac = MakeRandomBigUint(1000, mt);
+  const uint64_t frac_bits = 64 * 1000;
+  const uint64_t digit_len = 19000;
+
+  komori::PowerTable table;
+  std::string expected(digit_len, '0');
+  komori::detail::ScaledRemainderTree{table}.ConvertFraction(frac, frac_bits, digit_len, expected, 0);
+
+  // The blocks of 1000 digits are written from the left, and regrouped into chunks of exactly 1000 digits
+  std::vector<std::string> chunks;
+  komori::CallbackDigitSink sink{[&](std::string_view digits) { chunks.emplace_back(digits); }};
+  komori::WriteFractionDigits(sink, frac, frac_bits, digit_len, 1000);
+  ASSERT_EQ(chunks.size(), 19ULL);
+  std::string ans;
+  for (const auto& chunk : chunks) {
+    EXPECT_EQ(chunk.size(), 1000ULL);
+    ans += chunk;
+  }
+  EXPECT_EQ(ans, expected);
+
+  komori::StringDigitSink string_sink;
+  komori::WriteFractionDigits(string_sink, frac, frac_bits, 333, 7);
+  EXPECT_EQ(string_sink.Str(), expected.substr(0, 333));
+}
+
+TEST(PowerTable, Pow10) {
+  komori::PowerTable table;
+  for (const uint64_t n : {0, 1, 27, 28, 100, 777, 1000}) {
+    EXPECT_EQ(table.Pow10(n), BigUint{10}.Pow(n));
+  }
+  static_assert([] {
+    komori::PowerTable local;
+    return local.Pow10(100) == BigUint{10}.Pow(100) && local.Size() == 2;
+  }());
+  // Only the powers on the halving chains of 28, 100, 777 and 1000 are memoized
+  EXPECT_LT(table.Size(), 16ULL);
+
+  const auto pow10 = BigUint{10}.Pow(300);
+  EXPECT_EQ(komori::detail::Log10Int(pow10, table), 300);
+  EXPECT_EQ(komori::detail::Log10Int(pow10 - BigUint{1}, table), 299);
+  for (uint64_t i = 1; i < 200; ++i) {
+    const auto x = BigUint{1} << i;
+    EXPECT_EQ(komori::detail::Log10Int(x, table), static_cast<int64_t>(ToString(x).size()) - 1);
+  }
+}
+
 TEST(OutputOperator, BigInt) {
   const auto x = BigInt{0x38c497e5596ef57eULL, 0x4da120763f11e267ULL, 0xefdf8ULL};
 
@@ -33,4 +152,29 @@ TEST(OutputOperator, BigFloat) {
 
   const auto s = ToString(x).substr(0, 20);
   EXPECT_TRUE(s == "334.3343343340000000" || s == "334.3343343339999999");
-}
\ No newline at end of file
+
+  komori::StringDigitSink sink;
+  WriteString(sink, x, 5);
+  EXPECT_EQ(sink.Str(), ToString(x));
+}
+TEST(PowerTable, Concurrent) {
+  komori::PowerTable table;
+  komori::ThreadPool pool(4);
+  const auto expected = BigUint{5}.Pow(100000);
+
+  // Every task gets the same entry, whichever of them computes it
+  std::vector<komori::Task<const BigUint*>> tasks;
+  for (int i = 0; i < 8; ++i) {
+    tasks.push_back(pool.Submit([&table] { return &table.Pow5(100000); }));
+  }
+  const auto* pow5 = &table.Pow5(100000);
+  for (auto& task : tasks) {
+    EXPECT_EQ(task.Get(), pow5);
+  }
+  EXPECT_EQ(*pow5, expected);
+
+  // The references stay valid while other powers are memoized
+  table.Pow5(123456);
+  EXPECT_EQ(&table.Pow5(100000), pow5);
+  EXPECT_EQ(&table.Pow5(3), &table.Pow5(3));
+}
@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include "packed_digits.hpp"
+#include "pi.hpp"
+
+using komori::PackedDigitReader;
+using komori::PackedDigitWriter;
+
+TEST(PackedDigits, WriteAndRead) {
+  const auto path = std::filesystem::temp_directory_path() / "komori_packed_digits_test.bin";
+  const auto pi = komori::ComputePi(5000);
+  const auto expected = komori::GetPiString(5000).substr(2);
+
+  // Blocks of 38 * 19 digits, fed by the streaming conversion in chunks that do not match the words
+  {
+    PackedDigitWriter writer{path, 38 * 19};
+    komori::WriteFractionDigits(writer, pi.FractionalPartRaw(), pi.GetFracBits(), 5000, 333);
+  }
+  // 5000 digits in 264 words of 19 digits, 7 index entries of 3 words and the header of 8 words
+  EXPECT_EQ(std::filesystem::file_size(path), (264 + 7 * 3 + 8) * 8ULL);
+
+  PackedDigitReader reader{path};
+  EXPECT_EQ(reader.TotalDigits(), 5000ULL);
+  EXPECT_EQ(reader.NumBlocks(), 7ULL);
+  EXPECT_EQ(reader.ReadBlock(6), expected.substr(6 * 722));
+  EXPECT_EQ(reader.ReadBlock(0), expected.substr(0, 722));
+  EXPECT_EQ(reader.ReadDigits(0, 5000), expected);
+  EXPECT_EQ(reader.ReadDigits(700, 800), expected.substr(700, 800));
+  EXPECT_EQ(reader.ReadDigits(5000, 0), "");
+  EXPECT_THROW(reader.ReadDigits(4990, 11), std::out_of_range);
+  EXPECT_THROW(reader.ReadBlock(7), std::out_of_range);
+}
+
+TEST(PackedDigits, Corrupted) {
+  const auto path = std::filesystem::temp_directory_path() / "komori_packed_digits_corrupted_test.bin";
+  {
+    PackedDigitWriter writer{path, 19};
+    writer.Write("14159265358979323846264338327950288419716939937510");
+    EXPECT_THROW(writer.Write("."), komori::SerializeError);
+    // A piece with an invalid character is not written at all
+    EXPECT_THROW(writer.Write("12.3"), komori::SerializeError);
+  }
+  EXPECT_EQ(PackedDigitReader{path}.TotalDigits(), 50ULL);
+  EXPECT_EQ(PackedDigitReader{path}.ReadDigits(0, 50), "14159265358979323846264338327950288419716939937510");
+
+  // A flipped bit in the second block is detected when the block is read, and the other blocks are still readable
+  {
+    std::fstream fs(path, std::ios::binary | std::ios::in | std::ios::out);
+    fs.seekp(8 * 8 + 8 + 3);
+    fs.put('\x7f');
+  }
+  PackedDigitReader reader{path};
+  EXPECT_EQ(reader.ReadBlock(0), "1415926535897932384");
+  EXPECT_THROW(reader.ReadBlock(1), komori::SerializeError);
+  EXPECT_EQ(reader.ReadBlock(2), "716939937510");
+
+  EXPECT_THROW(PackedDigitWriter(path, 20), std::invalid_argument);
+  std::filesystem::remove(path);
+}
+
+TEST(PackedDigits, BrokenHeader) {
+  const auto path = std::filesystem::temp_directory_path() / "komori_packed_digits_header_test.bin";
+  {
+    PackedDigitWriter writer{path, 19};
+    writer.Write("14159265358979323846264338327950288419716939937510");
+  }
+
+  // The number of blocks and the offset of the index are the 6th and 7th words of the header
+  const auto overwrite = [&](std::size_t word, uint64_t value) {
+    std::fstream fs(path, std::ios::binary | std::ios::in | std::ios::out);
+    fs.seekp(static_cast<std::streamoff>(word * 8));
+    fs.write(reinterpret_cast<const char*>(&value), sizeof(value));
+  };
+
+  // num_blocks * 24 wraps around to the size of the index
+  overwrite(5, 3 + (uint64_t{1} << 61));
+  EXPECT_THROW(PackedDigitReader{path}, komori::SerializeError);
+  overwrite(5, 3);
+  EXPECT_EQ(PackedDigitReader{path}.ReadDigits(0, 50), "14159265358979323846264338327950288419716939937510");
+
+  // The index must not overlap the header
+  overwrite(6, 0);
+  EXPECT_THROW(PackedDigitReader{path}, komori::SerializeError);
+  std::filesystem::remove(path);
+}
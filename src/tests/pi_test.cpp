@@ -0,0 +1,241 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <limits>
+#include "pi.hpp"
+
+TEST(Pi, GetPiString) {
+  EXPECT_EQ(komori::GetPiString(1), "3.1");
+  EXPECT_EQ(komori::GetPiString(50), "3.14159265358979323846264338327950288419716939937510");
+  EXPECT_EQ(komori::GetPiString(1000).substr(990), "092164201989");
+}
+
+TEST(Pi, GetPiStringNearDigitBoundary) {
+  // The digits after the 359th one are 001..., so an approximation slightly below pi ends in 5 instead of 6
+  EXPECT_EQ(komori::GetPiString(359).substr(356), "59036");
+  EXPECT_EQ(komori::GetPiString(362).substr(356), "59036001");
+
+  const auto pi = komori::ComputePi(komori::MakePiPlan(359));
+  EXPECT_FALSE(komori::IsTruncationExact(pi, 359, komori::MakePiPlan(359).output_bits));
+  EXPECT_TRUE(komori::IsTruncationExact(pi, 355, komori::MakePiPlan(359).output_bits));
+}
+
+TEST(Pi, WritePiString) {
+  komori::StringDigitSink sink;
+  komori::WritePiString(sink, 1000, 64);
+  EXPECT_EQ(sink.Str(), komori::GetPiString(1000));
+}
+
+TEST(Pi, ComputePQTParallel) {
+  const komori::ChudnovskySeries series;
+  komori::ThreadPool pool(4);
+  const auto expected = komori::detail::ComputePQT(series, 0, 300);
+
+  EXPECT_EQ(komori::detail::ComputePQTParallel(series, 0, 300, pool, 1000), expected);
+  EXPECT_EQ(komori::detail::ComputePQTParallel(series, 0, 300, pool), expected);
+  EXPECT_EQ(komori::detail::SplitByBitSize(series, 1, 3), 2ULL);
+  // The later terms are larger, so the left half has more terms
+  EXPECT_GT(komori::detail::SplitByBitSize(series, 0, 1000), 500ULL);
+}
+
+TEST(Pi, ComputeLeafBlock) {
+  const komori::ChudnovskySeries series;
+  // Merge single terms by the usual binary splitting step
+  auto [p, q, t] = komori::detail::ComputeLeafBlock(series, 10, 11);
+  for (uint64_t k = 12; k <= 16; ++k) {
+    const auto [pk, qk, tk] = komori::detail::ComputeLeafBlock(series, k - 1, k);
+    t = t * qk + tk * p;
+    p = p * pk;
+    q = q * qk;
+  }
+
+  EXPECT_TRUE(komori::detail::FitsInLeafBlock(series, 10, 16));
+  EXPECT_EQ(komori::detail::ComputeLeafBlock(series, 10, 16), std::make_tuple(p, q, t));
+  EXPECT_FALSE(komori::detail::FitsInLeafBlock(series, 0, 1000));
+}
+
+namespace {
+/// A series whose terms have the maximum number of factors of almost 64 bits, and a(1) = 0
+struct WideSeries {
+  constexpr komori::HypergeometricTerm Term(uint64_t k) const {
+    komori::HypergeometricTerm term;
+    term.a.push_back(k == 0 ? 1 : k - 1);
+    for (std::size_t i = 0; i < komori::kMaxTermFactors; ++i) {
+      term.p.push_back(~0ULL - 200 + k);
+      term.q.push_back(~0ULL - 100 + k);
+      if (i > 0) {
+        term.a.push_back(~0ULL - 300 + k);
+      }
+    }
+    return term;
+  }
+  double EstimateQBits(uint64_t n) const { return 64.0 * komori::kMaxTermFactors * static_cast<double>(n); }
+  uint64_t SieveLimit(uint64_t /* n */) const { return 2; }
+  uint64_t TermsFor(uint64_t bits) const { return bits / 64 + 1; }
+  std::string_view Name() const { return "wide"; }
+};
+}  // namespace
+
+TEST(Pi, ComputeWideTerms) {
+  const WideSeries series;
+  komori::BigInt p{1};
+  komori::BigInt q{1};
+  komori::BigInt t;
+  for (uint64_t k = 1; k <= 3; ++k) {
+    const auto term = series.Term(k);
+    komori::BigInt pk{1};
+    komori::BigInt qk{1};
+    komori::BigInt ak{1};
+    for (std::size_t i = 0; i < komori::kMaxTermFactors; ++i) {
+      pk = pk * komori::BigInt{term.p[i]};
+      qk = qk * komori::BigInt{term.q[i]};
+      ak = ak * komori::BigInt{term.a[i]};
+    }
+    p = p * pk;
+    q = q * qk;
+    t = t * qk + ak * p;
+  }
+
+  // A single term is always a leaf block, so the binary splitting terminates
+  EXPECT_TRUE(komori::detail::FitsInLeafBlock(series, 2, 3));
+  // a(1) = 0
+  EXPECT_EQ(std::get<2>(komori::detail::ComputeLeafBlock(series, 0, 1)), komori::BigInt{});
+  EXPECT_EQ(komori::detail::ComputePQT(series, 0, 3), std::make_tuple(p, q, t));
+  EXPECT_EQ(komori::ComputeSeriesRange(series, 0, 3, true), std::make_tuple(p, q, t));
+}
+
+TEST(Pi, ComputeFactoredPQT) {
+  const komori::ChudnovskySeries series;
+  const komori::PrimeSieve sieve{6 * 300};
+  const auto [p, q, t] = komori::detail::ComputePQT(series, 0, 300);
+  const auto factored = komori::detail::ComputeFactoredPQT(series, 0, 300, sieve);
+
+  // The common factors are removed without changing the ratios
+  EXPECT_LT(factored.q.Abs().NumberOfBits(), q.Abs().NumberOfBits());
+  EXPECT_EQ(factored.q * t, factored.t * q);
+  EXPECT_EQ(factored.q * p, factored.p * q);
+  EXPECT_EQ(factored.p_factors.ToBigUint(), factored.p.Abs());
+  EXPECT_EQ(factored.q_factors.ToBigUint(), factored.q.Abs());
+
+  auto plan = komori::MakePiPlan(1000);
+  plan.remove_common_factors = true;
+  EXPECT_EQ(ToDecimalString(komori::ComputePi(plan)).substr(0, 1002), komori::GetPiString(1000));
+
+  // A few terms, whose sieve must still cover the prime factors of C^3 / 24
+  for (const uint64_t digits : {1, 5, 10, 20, 50}) {
+    auto small_plan = komori::MakePiPlan(digits);
+    small_plan.remove_common_factors = true;
+    EXPECT_EQ(ToDecimalString(komori::ComputePi(small_plan)).substr(0, digits + 2), komori::GetPiString(digits));
+  }
+}
+
+TEST(Pi, SeriesDriver) {
+  const komori::ChudnovskySeries series;
+  komori::ThreadPool pool(4);
+  const auto [p, q, t] = komori::detail::ComputePQT(series, 0, 300);
+
+  komori::detail::SeriesDriver unlimited{series, pool, std::numeric_limits<uint64_t>::max(), 1000};
+  // P of the root is not computed
+  EXPECT_EQ(unlimited.Compute(300), std::make_tuple(komori::BigInt{}, q, t));
+  EXPECT_EQ(unlimited.DeferredTasks(), 0ULL);
+  EXPECT_GT(unlimited.PeakBytes(), komori::detail::BytesOf(q) + komori::detail::BytesOf(t));
+
+  komori::detail::SeriesDriver limited{series, pool, 0, 1000};
+  EXPECT_EQ(limited.Compute(300), std::make_tuple(komori::BigInt{}, q, t));
+  EXPECT_GT(limited.DeferredTasks(), 0ULL);
+
+  komori::SeriesReport report;
+  EXPECT_EQ(ToDecimalString(komori::ComputePi(komori::MakePiPlan(1000), &report)).substr(0, 1002),
+            komori::GetPiString(1000));
+  EXPECT_GT(report.peak_bytes, 0ULL);
+}
+
+TEST(Pi, Checkpoint) {
+  const komori::ChudnovskySeries series;
+  const auto directory = std::filesystem::temp_directory_path() / "komori_pi_checkpoint_test";
+  std::filesystem::remove_all(directory);
+
+  komori::ThreadPool pool(2);
+  const komori::Checkpoint checkpoint{directory};
+  const auto [p, q, t] = komori::detail::ComputePQT(series, 0, 300);
+
+  komori::detail::SeriesDriver first{series, pool, std::numeric_limits<uint64_t>::max(), 1000};
+  first.SetCheckpoint(checkpoint, 1000);
+  EXPECT_EQ(first.Compute(300), std::make_tuple(komori::BigInt{}, q, t));
+  EXPECT_EQ(first.LoadedSubtrees(), 0ULL);
+
+  // The root is loaded
+  komori::detail::SeriesDriver second{series, pool, std::numeric_limits<uint64_t>::max(), 1000};
+  second.SetCheckpoint(checkpoint, 1000);
+  EXPECT_EQ(second.Compute(300), std::make_tuple(komori::BigInt{}, q, t));
+  EXPECT_EQ(second.LoadedSubtrees(), 1ULL);
+
+  auto plan = komori::MakePiPlan(1000);
+  plan.checkpoint_directory = directory.string();
+  EXPECT_EQ(ToDecimalString(komori::ComputePi(plan)).substr(0, 1002), komori::GetPiString(1000));
+  EXPECT_TRUE(checkpoint.Exists("inverse_sqrt_c_" + std::to_string(plan.frac_bits)));
+  EXPECT_EQ(ToDecimalString(komori::ComputePi(plan)).substr(0, 1002), komori::GetPiString(1000));
+
+  std::filesystem::remove_all(directory);
+}
+
+TEST(Pi, Spill) {
+  const komori::ChudnovskySeries series;
+  const auto directory = std::filesystem::temp_directory_path() / "komori_pi_spill_test";
+  const komori::ScratchDirectory scratch{directory};
+
+  komori::ThreadPool pool(1);
+  const auto [p, q, t] = komori::detail::ComputePQT(series, 0, 300);
+
+  komori::detail::SeriesDriver driver{series, pool, std::numeric_limits<uint64_t>::max()};
+  driver.SetSpill(scratch, 1000);
+  EXPECT_EQ(driver.ComputeRange(0, 300, true), std::make_tuple(p, q, t));
+  EXPECT_GT(driver.SpilledSubtrees(), 0ULL);
+  EXPECT_EQ(driver.OutOfCoreMerges(), 0ULL);
+
+  // Under a small budget, the merges of the spilled subtrees are formed out of core, also with parallel subtrees
+  for (const std::size_t concurrency : {1, 4}) {
+    komori::ThreadPool small_pool(concurrency);
+    komori::detail::SeriesDriver small_driver{series, small_pool, 4096, 100};
+    small_driver.SetSpill(scratch, 1000);
+    EXPECT_EQ(small_driver.ComputeRange(0, 300, true), std::make_tuple(p, q, t));
+    EXPECT_GT(small_driver.SpilledSubtrees(), 0ULL);
+    EXPECT_GT(small_driver.OutOfCoreMerges(), 0ULL);
+  }
+
+  auto plan = komori::MakePiPlan(1000);
+  plan.spill_directory = directory.string();
+  EXPECT_EQ(ToDecimalString(komori::ComputePi(plan)).substr(0, 1002), komori::GetPiString(1000));
+
+  std::filesystem::remove_all(directory);
+}
+
+TEST(Pi, ExtendPi) {
+  const komori::ChudnovskySeries series;
+  auto plan = komori::MakePiPlan(1000);
+  const auto [p, q, t] = komori::detail::ComputePQT(series, 0, plan.terms);
+
+  komori::SeriesPrefix prefix;
+  EXPECT_EQ(ToDecimalString(komori::ExtendPi(prefix, 500)).substr(0, 502), komori::GetPiString(500));
+  EXPECT_EQ(prefix.terms, komori::MakePiPlan(500).terms);
+  EXPECT_EQ(ToDecimalString(komori::ExtendPi(prefix, plan)).substr(0, 1002), komori::GetPiString(1000));
+  EXPECT_EQ(std::make_tuple(prefix.p, prefix.q, prefix.t), std::make_tuple(p, q, t));
+
+  // A shorter request reuses the longer series
+  EXPECT_EQ(ToDecimalString(komori::ExtendPi(prefix, 100)).substr(0, 102), komori::GetPiString(100));
+  EXPECT_EQ(prefix.terms, plan.terms);
+
+  const auto directory = std::filesystem::temp_directory_path() / "komori_extend_pi_test";
+  const komori::Checkpoint checkpoint{directory};
+  komori::SaveSeriesPrefix(checkpoint, "prefix", prefix);
+  auto loaded = komori::LoadSeriesPrefix(checkpoint, "prefix");
+  ASSERT_TRUE(loaded);
+  EXPECT_EQ(loaded->terms, plan.terms);
+  EXPECT_EQ(ToDecimalString(komori::ExtendPi(*loaded, 1500)).substr(0, 1502), komori::GetPiString(1500));
+  EXPECT_FALSE(komori::LoadSeriesPrefix(checkpoint, "missing"));
+  std::filesystem::remove_all(directory);
+
+  plan.remove_common_factors = true;
+  komori::SeriesPrefix factored = komori::ExtendSeries({}, komori::MakePiPlan(300));
+  EXPECT_EQ(ToDecimalString(komori::ExtendPi(factored, plan)).substr(0, 1002), komori::GetPiString(1000));
+}
@@ -0,0 +1,20 @@
+#include <gtest/gtest.h>
+
+#include "planner.hpp"
+
+using komori::MakePiPlan;
+
+TEST(Planner, MakePiPlan) {
+  const auto plan = MakePiPlan(100000);
+
+  EXPECT_EQ(plan.digits, 100000ULL);
+  EXPECT_GE(static_cast<double>(plan.output_bits), 100000 * 3.3219280948873623);
+  EXPECT_GT(plan.series_error_bits, plan.output_bits);
+  EXPECT_EQ(plan.frac_bits, plan.output_bits + plan.guard_bits);
+  // Each term adds about 14.18 digits
+  EXPECT_GE(plan.terms, 100000ULL / 15);
+  EXPECT_LE(plan.terms, 100000ULL / 14);
+  // A fewer terms would not be enough
+  EXPECT_LT(MakePiPlan(100000 - 15).terms, plan.terms);
+  EXPECT_NE(plan.DebugString().find("terms="), std::string::npos);
+}
@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+#include "serialize.hpp"
+
+using komori::BigFixed;
+using komori::BigFloat;
+using komori::BigInt;
+using komori::BigUint;
+using komori::Deserialize;
+using komori::SerializeError;
+using komori::Sign;
+
+namespace {
+template <typename T>
+T RoundTrip(const T& value) {
+  std::stringstream ss;
+  Serialize(ss, value);
+  return Deserialize<T>(ss);
+}
+}  // namespace
+
+TEST(Serialize, RoundTrip) {
+  const BigUint x = BigUint{0x334, 0x264, 0x1} << 1000;
+  const BigFloat y = BigFloat(500, BigInt{x, Sign::kNegative}) >> 2000;
+  const BigFixed z = BigFixed(300, BigInt{3}) >> 7;
+
+  EXPECT_EQ(RoundTrip(x), x);
+  EXPECT_EQ(RoundTrip(BigUint{}), BigUint{});
+  EXPECT_EQ(RoundTrip(BigInt{x, Sign::kNegative}), (BigInt{x, Sign::kNegative}));
+  EXPECT_EQ(RoundTrip(y).GetSignificand(), y.GetSignificand());
+  EXPECT_EQ(RoundTrip(y).GetExponent(), y.GetExponent());
+  EXPECT_EQ(RoundTrip(y).GetPrecision(), 500);
+  EXPECT_EQ(RoundTrip(z), z);
+}
+
+TEST(Serialize, Stream) {
+  std::stringstream ss;
+  Serialize(ss, BigInt{1, 2, 3});
+  Serialize(ss, BigUint{4});
+
+  EXPECT_EQ(Deserialize<BigInt>(ss), (BigInt{1, 2, 3}));
+  EXPECT_EQ(Deserialize<BigUint>(ss), BigUint{4});
+  EXPECT_THROW(Deserialize<BigUint>(ss), SerializeError);
+}
+
+TEST(Serialize, BrokenInput) {
+  std::stringstream ss;
+  Serialize(ss, BigUint{0x334, 0x264});
+  const auto data = ss.str();
+
+  auto read = [](const std::string& str) {
+    std::stringstream is(str);
+    return Deserialize<BigUint>(is);
+  };
+  auto flipped = data;
+  flipped[flipped.size() - 9] ^= 1;
+
+  EXPECT_EQ(read(data), (BigUint{0x334, 0x264}));
+  EXPECT_THROW(read(data.substr(0, data.size() - 1)), SerializeError);
+  EXPECT_THROW(read(flipped), SerializeError);
+  EXPECT_THROW(read("KOMORIBX" + data.substr(8)), SerializeError);
+
+  std::stringstream is(data);
+  EXPECT_THROW(Deserialize<BigInt>(is), SerializeError);
+}
+
+TEST(Serialize, BrokenField) {
+  // The fields before the limbs are covered by the checksum, e.g. frac_bits 64 -> 65 and the sign
+  std::stringstream fixed_ss;
+  Serialize(fixed_ss, BigFixed(64, BigInt{3}) >> 1);
+  auto fixed_data = fixed_ss.str();
+  fixed_data[24] ^= 1;
+  std::stringstream fixed_is(fixed_data);
+  EXPECT_THROW(Deserialize<BigFixed>(fixed_is), SerializeError);
+
+  std::stringstream int_ss;
+  Serialize(int_ss, BigInt{0x334, Sign::kNegative});
+  auto int_data = int_ss.str();
+  int_data[24] ^= 1;
+  std::stringstream int_is(int_data);
+  EXPECT_THROW(Deserialize<BigInt>(int_is), SerializeError);
+}
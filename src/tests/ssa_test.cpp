@@ -50,4 +50,86 @@ TEST(SplittedInteger, Multiply) {
 
   EXPECT_EQ(naive_ans, karatsuba_ans);
   EXPECT_EQ(naive_ans, ssa_ans);
-}
\ No newline at end of file
+
+  // The parallel transforms give the same product with any number of threads
+  for (const std::size_t concurrency : {1, 2, 5}) {
+    komori::ThreadPool pool(concurrency);
+    EXPECT_EQ(MultiplySSA(x, y, &pool), naive_ans);
+  }
+}
+
+TEST(SplittedInteger, Multiply32) {
+  using komori::BigUint32;
+  using komori::LimbCast;
+  using komori::detail::MultiplySSA;
+
+  std::vector<uint64_t> x_vec;
+  std::vector<uint64_t> y_vec;
+
+  std::mt19937_64 mt(264);
+  std::uniform_int_distribution<std::uint64_t> dist;
+  for (std::size_t i = 0; i < 100; ++i) {
+    x_vec.push_back(dist(mt));
+    y_vec.push_back(dist(mt));
+  }
+
+  const BigUint x{std::move(x_vec)};
+  const BigUint y{std::move(y_vec)};
+  const auto x32 = LimbCast<BigUint32>(x);
+  const auto y32 = LimbCast<BigUint32>(y);
+
+  EXPECT_EQ(LimbCast<BigUint>(MultiplySSA(x32, y32)), MultiplyNaive(x, y));
+  EXPECT_EQ(LimbCast<BigUint>(MultiplyKaratsuba(x32, y32)), MultiplyNaive(x, y));
+}
+
+TEST(Multiply, Parallel) {
+  std::vector<uint64_t> x_vec;
+  std::vector<uint64_t> y_vec;
+
+  std::mt19937_64 mt(42);
+  std::uniform_int_distribution<std::uint64_t> dist;
+  for (std::size_t i = 0; i < 2000; ++i) {
+    x_vec.push_back(dist(mt));
+  }
+  for (std::size_t i = 0; i < 1500; ++i) {
+    y_vec.push_back(dist(mt));
+  }
+
+  const BigUint x{std::move(x_vec)};
+  const BigUint y{std::move(y_vec)};
+  const auto expected = MultiplyKaratsuba(x, y);
+
+  komori::ThreadPool pool(4);
+  EXPECT_EQ(komori::detail::MultiplyKaratsubaParallel(x, y, pool), expected);
+
+  // Independent products overlap
+  auto xy = komori::MultiplyAsync(x, y, pool);
+  auto yy = komori::MultiplyAsync(y, y, pool);
+  EXPECT_EQ(xy.Get(), expected);
+  EXPECT_EQ(yy.Get(), MultiplyKaratsuba(y, y));
+  EXPECT_EQ(komori::MultiplyAsync(komori::BigInt{x}, -komori::BigInt{y}, pool).Get(), -komori::BigInt{expected});
+}
+
+TEST(ExactDivide, Basic) {
+  std::vector<uint64_t> x_vec;
+  std::vector<uint64_t> y_vec;
+
+  std::mt19937_64 mt(4);
+  std::uniform_int_distribution<std::uint64_t> dist;
+  for (std::size_t i = 0; i < 100; ++i) {
+    x_vec.push_back(dist(mt));
+  }
+  for (std::size_t i = 0; i < 30; ++i) {
+    y_vec.push_back(dist(mt));
+  }
+
+  const BigUint x{std::move(x_vec)};
+  const BigUint y = BigUint{std::move(y_vec)} << 70;
+
+  EXPECT_EQ(komori::ExactDivide(x * y, y), x);
+  EXPECT_EQ(komori::ExactDivide(x * y, x), y);
+  EXPECT_EQ(komori::ExactDivide(BigUint{334 * 264}, BigUint{264}), BigUint{334});
+  EXPECT_EQ(komori::ExactDivide(BigUint{}, y), BigUint{});
+  EXPECT_EQ(komori::ExactDivide(y, y), BigUint{1});
+  EXPECT_THROW(komori::ExactDivide(x, BigUint{}), std::range_error);
+}
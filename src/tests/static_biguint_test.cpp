@@ -0,0 +1,56 @@
+#include <gtest/gtest.h>
+
+#include "static_biguint.hpp"
+
+using komori::BigUint;
+using komori::StaticBigUint;
+using komori::StaticVector;
+using komori::uint128_t;
+
+TEST(StaticVector, Basic) {
+  StaticVector<uint64_t, 3> v;
+  EXPECT_TRUE(v.empty());
+
+  v.push_back(0x334);
+  v.resize(3);
+  EXPECT_EQ(v.size(), 3ULL);
+  EXPECT_EQ(v[0], 0x334ULL);
+  EXPECT_EQ(v.back(), 0ULL);
+  EXPECT_THROW(v.push_back(0x264), std::length_error);
+  EXPECT_THROW(v.resize(4), std::length_error);
+
+  v.pop_back();
+  EXPECT_EQ(v.size(), 2ULL);
+}
+
+TEST(StaticBigUint, Construct) {
+  EXPECT_TRUE(StaticBigUint<2>{uint64_t{0}}.IsZero());
+  EXPECT_EQ(StaticBigUint<2>{(uint128_t{0x264} << 64) | 0x334}.ToBigUint(), (BigUint{0x334, 0x264}));
+  EXPECT_EQ(StaticBigUint<2>{(BigUint{0x334, 0x264})}.NumberOfBits(), 74ULL);
+  EXPECT_THROW(StaticBigUint<1>{(BigUint{0x334, 0x264})}, std::length_error);
+}
+
+TEST(StaticBigUint, Arithmetic) {
+  const BigUint x{0x8000000000000000ULL, 0xFFFFFFFFFFFFFFFEULL};
+  const BigUint y{0x334ULL, 0x264ULL};
+  const StaticBigUint<4> sx{x};
+  const StaticBigUint<4> sy{y};
+
+  EXPECT_EQ((sx + sy).ToBigUint(), x + y);
+  EXPECT_EQ((sx - sy).ToBigUint(), x - y);
+  EXPECT_THROW(sy - sx, std::out_of_range);
+  EXPECT_EQ((sx * sy).ToBigUint(), x * y);
+  EXPECT_EQ((StaticBigUint<4>{sx} <<= 70).ToBigUint(), x << 70);
+  EXPECT_EQ((StaticBigUint<4>{sx} >>= 70).ToBigUint(), x >> 70);
+  EXPECT_TRUE(sy < sx);
+  EXPECT_THROW((StaticBigUint<3>{x} * StaticBigUint<3>{x}), std::length_error);
+  EXPECT_EQ((StaticBigUint<4>{sx} *= uint64_t{0x334}).ToBigUint(), x * BigUint{0x334});
+  EXPECT_TRUE((StaticBigUint<4>{sx} *= uint64_t{0}).IsZero());
+  EXPECT_THROW((StaticBigUint<2>{x} *= uint64_t{0x334}), std::length_error);
+}
+
+TEST(StaticBigUint, ConstantEvaluation) {
+  constexpr auto kProduct = StaticBigUint<2>{uint64_t{1} << 63} * StaticBigUint<2>{uint64_t{6}};
+  static_assert(kProduct.NumberOfBits() == 66);
+  EXPECT_EQ(kProduct.ToBigUint(), (BigUint{0, 3}));
+}
@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+
+#include <time.h>
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "thread_pool.hpp"
+
+using komori::Task;
+using komori::ThreadPool;
+
+namespace {
+uint64_t Fibonacci(ThreadPool& pool, uint64_t n) {
+  if (n < 2) {
+    return n;
+  }
+
+  auto lhs = pool.Submit([&pool, n] { return Fibonacci(pool, n - 1); });
+  const auto rhs = Fibonacci(pool, n - 2);
+  return lhs.Get() + rhs;
+}
+}  // namespace
+
+TEST(ThreadPool, Submit) {
+  ThreadPool pool(4);
+  EXPECT_EQ(pool.Concurrency(), 4ULL);
+
+  std::vector<Task<uint64_t>> tasks;
+  for (uint64_t i = 0; i < 100; ++i) {
+    tasks.push_back(pool.Submit([i] { return i * i; }));
+  }
+  for (uint64_t i = 0; i < 100; ++i) {
+    EXPECT_EQ(tasks[i].Get(), i * i);
+  }
+
+  std::atomic<int> count = 0;
+  auto void_task = pool.Submit([&count] { ++count; });
+  void_task.Get();
+  EXPECT_EQ(count, 1);
+}
+
+TEST(ThreadPool, Nested) {
+  ThreadPool pool(4);
+  EXPECT_EQ(Fibonacci(pool, 20), 6765ULL);
+
+  // Without workers, tasks run in the waiting thread
+  ThreadPool serial_pool(1);
+  EXPECT_EQ(serial_pool.Concurrency(), 1ULL);
+  EXPECT_EQ(Fibonacci(serial_pool, 15), 610ULL);
+}
+
+TEST(ThreadPool, Exception) {
+  ThreadPool pool(2);
+  auto task = pool.Submit([]() -> int { throw std::runtime_error("error"); });
+  EXPECT_THROW(task.Get(), std::runtime_error);
+}
+
+TEST(ThreadPool, DestroyWithoutGet) {
+  ThreadPool pool(2);
+  std::atomic<bool> finished = false;
+
+  // The handle waits for the task, which refers to a local variable of the scope left by the exception
+  EXPECT_THROW(
+      {
+        std::vector<uint64_t> values(1000);
+        auto task = pool.Submit([&values, &finished] {
+          std::this_thread::sleep_for(std::chrono::milliseconds(10));
+          values.assign(values.size(), 334);
+          finished = true;
+        });
+        throw std::runtime_error("error");
+      },
+      std::runtime_error);
+  EXPECT_TRUE(finished);
+
+  // The exception of a task that is not got is discarded
+  { auto task = pool.Submit([]() -> int { throw std::runtime_error("error"); }); }
+}
+
+TEST(ThreadPool, WaitBlocks) {
+  const auto thread_cpu_seconds = [] {
+    timespec ts{};
+    ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) * 1e-9;
+  };
+
+  // The worker runs the task, and the waiting thread sleeps instead of spinning
+  ThreadPool pool(2);
+  std::atomic<bool> started{false};
+  auto task = pool.Submit([&] {
+    started = true;
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    return 334;
+  });
+  while (!started) {
+    std::this_thread::yield();
+  }
+
+  const auto start = thread_cpu_seconds();
+  EXPECT_EQ(task.Get(), 334);
+  EXPECT_LT(thread_cpu_seconds() - start, 0.1);
+}
+
+TEST(ThreadPool, ParallelFor) {
+  ThreadPool pool(4);
+  std::vector<uint64_t> values(1000);
+  komori::ParallelFor(pool, 10, values.size(), [&values](std::size_t i) { values[i] = i * i; });
+  for (std::size_t i = 0; i < values.size(); ++i) {
+    EXPECT_EQ(values[i], i < 10 ? 0 : i * i);
+  }
+
+  EXPECT_THROW(komori::ParallelFor(pool, 0, 100,
+                                   [](std::size_t i) {
+                                     if (i == 50) {
+                                       throw std::runtime_error("error");
+                                     }
+                                   }),
+               std::runtime_error);
+}
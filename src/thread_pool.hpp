@@ -0,0 +1,361 @@
+#ifndef KOMORI_THREAD_POOL_HPP_
+#define KOMORI_THREAD_POOL_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+namespace komori {
+class ThreadPool;
+
+namespace detail {
+/// The number of times `Task` yields without finding a pending task before it blocks until the task finishes
+inline constexpr int kTaskSpinCount = 64;
+
+/// The result of a task shared by the pool and `Task`
+template <typename T>
+struct TaskState {
+  using Storage = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+  std::atomic<bool> ready{false};
+  std::optional<Storage> value;
+  std::exception_ptr exception;
+};
+}  // namespace detail
+
+/**
+ * @brief A handle of a task submitted to `ThreadPool`
+ * @tparam T The result type of the task
+ *
+ * A handle destroyed before `Get()` waits for the task and discards its exception. Thus a task may refer to local
+ * variables of the submitting scope even if the scope is left by an exception.
+ */
+template <typename T>
+class Task {
+ public:
+  Task(const Task&) = delete;
+  Task(Task&& rhs) noexcept : pool_{rhs.pool_}, state_{std::move(rhs.state_)} {}
+  Task& operator=(const Task&) = delete;
+  Task& operator=(Task&& rhs) noexcept {
+    if (this != &rhs) {
+      Wait();
+      pool_ = rhs.pool_;
+      state_ = std::move(rhs.state_);
+    }
+    return *this;
+  }
+  ~Task() { Wait(); }
+
+  /// Check if the task has finished
+  bool IsReady() const noexcept { return state_->ready.load(std::memory_order_acquire); }
+
+  /**
+   * @brief Wait for the task and get the result
+   *
+   * While waiting, the calling thread runs other pending tasks of the pool, so a task may wait for its children without
+   * blocking a worker. If the task threw an exception, it is rethrown here. This function must be called at most once.
+   */
+  T Get();
+
+ private:
+  friend class ThreadPool;
+
+  Task(ThreadPool* pool, std::shared_ptr<detail::TaskState<T>> state) : pool_{pool}, state_{std::move(state)} {}
+
+  /// Wait for the task if it has not been got, running other pending tasks meanwhile. If there are none, it blocks.
+  void Wait() noexcept;
+
+  ThreadPool* pool_;
+  std::shared_ptr<detail::TaskState<T>> state_;
+};
+
+/**
+ * @brief A work-stealing thread pool
+ *
+ * Each worker has its own deque. A worker pushes the tasks it submits to the back of its deque and takes tasks from
+ * the back (LIFO), so that it keeps working on the most recent (and usually smallest) subproblem. Idle workers steal
+ * from the front of the other deques (FIFO), where the oldest and largest subproblems are. Tasks submitted from outside
+ * the pool go to a shared deque.
+ *
+ * The pool has `concurrency - 1` workers because the thread that waits for a task also runs tasks. With
+ * `concurrency == 1`, tasks run when their results are requested.
+ */
+class ThreadPool {
+ public:
+  /// Construct a pool that runs up to `concurrency` tasks at the same time, including the waiting thread
+  explicit ThreadPool(std::size_t concurrency) {
+    const auto num_workers = std::max<std::size_t>(concurrency, 1) - 1;
+    for (std::size_t i = 0; i < num_workers + 1; ++i) {
+      queues_.push_back(std::make_unique<Queue>());
+    }
+    for (std::size_t i = 0; i < num_workers; ++i) {
+      workers_.emplace_back([this, i] { WorkerLoop(i); });
+    }
+  }
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool(ThreadPool&&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+  ThreadPool& operator=(ThreadPool&&) = delete;
+
+  ~ThreadPool() {
+    {
+      std::lock_guard lock(sleep_mutex_);
+      stop_ = true;
+    }
+    sleep_cv_.notify_all();
+    for (auto& worker : workers_) {
+      worker.join();
+    }
+  }
+
+  /// The pool shared in the process. Its concurrency is `std::thread::hardware_concurrency()`.
+  static ThreadPool& Default() {
+    static ThreadPool pool{std::thread::hardware_concurrency()};
+    return pool;
+  }
+
+  /**
+   * @brief Stop using `Default()` in this process
+   *
+   * A process forked from a process with running workers has no workers, and the locks of the pool may be held by
+   * threads that do not exist in it. After this call, the library computes serially instead of using `Default()`.
+   */
+  static void DisableDefault() noexcept { default_disabled_.store(true, std::memory_order_relaxed); }
+
+  static bool IsDefaultDisabled() noexcept { return default_disabled_.load(std::memory_order_relaxed); }
+
+  /// The number of tasks that can run at the same time
+  std::size_t Concurrency() const noexcept { return workers_.size() + 1; }
+
+  /**
+   * @brief Submit a task
+   * @param func A callable object without arguments
+   * @return The handle to get the result
+   */
+  template <typename F>
+  auto Submit(F func) -> Task<std::invoke_result_t<F&>> {
+    using T = std::invoke_result_t<F&>;
+
+    auto state = std::make_shared<detail::TaskState<T>>();
+    // `std::function` requires a copyable callable, so the function object itself is shared
+    Push([state, shared_func = std::make_shared<F>(std::move(func))] {
+      try {
+        if constexpr (std::is_void_v<T>) {
+          (*shared_func)();
+          state->value.emplace();
+        } else {
+          state->value.emplace((*shared_func)());
+        }
+      } catch (...) {
+        state->exception = std::current_exception();
+      }
+      state->ready.store(true, std::memory_order_release);
+      state->ready.notify_all();
+    });
+
+    return Task<T>{this, std::move(state)};
+  }
+
+  /**
+   * @brief Run one pending task in the calling thread
+   * @return `false` if there are no pending tasks
+   */
+  bool RunPendingTask() {
+    auto task = Pop(LocalQueueIndex());
+    if (!task) {
+      return false;
+    }
+
+    (*task)();
+    return true;
+  }
+
+ private:
+  struct Queue {
+    std::mutex mutex;
+    std::deque<std::function<void()>> tasks;
+  };
+
+  /// The index of the deque of the calling thread. Threads outside the pool share the last one.
+  std::size_t LocalQueueIndex() const noexcept {
+    return current_pool_ == this ? current_index_ : queues_.size() - 1;
+  }
+
+  void Push(std::function<void()> task) {
+    auto& queue = *queues_[LocalQueueIndex()];
+    {
+      std::lock_guard lock(queue.mutex);
+      queue.tasks.push_back(std::move(task));
+    }
+    {
+      std::lock_guard lock(sleep_mutex_);
+      ++pending_;
+    }
+    sleep_cv_.notify_one();
+  }
+
+  /// Take a task from the back of the local deque, or steal one from the front of another deque
+  std::optional<std::function<void()>> Pop(std::size_t local_index) {
+    for (std::size_t i = 0; i < queues_.size(); ++i) {
+      const auto index = (local_index + i) % queues_.size();
+      auto& queue = *queues_[index];
+
+      std::unique_lock lock(queue.mutex);
+      if (queue.tasks.empty()) {
+        continue;
+      }
+
+      std::function<void()> task;
+      if (i == 0) {
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+      } else {
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+      }
+      lock.unlock();
+
+      {
+        std::lock_guard sleep_lock(sleep_mutex_);
+        --pending_;
+      }
+      return task;
+    }
+
+    return std::nullopt;
+  }
+
+  void WorkerLoop(std::size_t index) {
+    current_pool_ = this;
+    current_index_ = index;
+
+    for (;;) {
+      if (RunPendingTask()) {
+        continue;
+      }
+
+      std::unique_lock lock(sleep_mutex_);
+      sleep_cv_.wait(lock, [this] { return stop_ || pending_ > 0; });
+      if (stop_) {
+        return;
+      }
+    }
+  }
+
+  std::vector<std::unique_ptr<Queue>> queues_;
+  std::vector<std::thread> workers_;
+
+  std::mutex sleep_mutex_;
+  std::condition_variable sleep_cv_;
+  /// The number of tasks in the deques (guarded by `sleep_mutex_`)
+  std::size_t pending_{0};
+  /// Whether the pool is being destroyed (guarded by `sleep_mutex_`)
+  bool stop_{false};
+
+  static inline std::atomic<bool> default_disabled_{false};
+  static inline thread_local const ThreadPool* current_pool_ = nullptr;
+  static inline thread_local std::size_t current_index_ = 0;
+};
+
+template <typename T>
+void Task<T>::Wait() noexcept {
+  if (!state_) {
+    return;
+  }
+
+  // The tasks run by `RunPendingTask()` catch their exceptions, so nothing is thrown here
+  int idle_count = 0;
+  while (!IsReady()) {
+    if (pool_->RunPendingTask()) {
+      idle_count = 0;
+    } else if (++idle_count < detail::kTaskSpinCount) {
+      std::this_thread::yield();
+    } else {
+      // The task is not pending, so another thread is running it and finishes it without this one
+      state_->ready.wait(false, std::memory_order_acquire);
+    }
+  }
+}
+
+template <typename T>
+T Task<T>::Get() {
+  Wait();
+
+  const auto state = std::move(state_);
+  if (state->exception) {
+    std::rethrow_exception(state->exception);
+  }
+  if constexpr (!std::is_void_v<T>) {
+    return std::move(*state->value);
+  }
+}
+
+/**
+ * @brief Run `func(i)` for each i in [begin, end) in tasks of `pool`
+ *
+ * The range is split into up to 4 chunks per thread so that idle threads can steal the rest when the chunks take
+ * different times. The calling thread runs the last chunk and then waits for the others. If `func` throws, the first
+ * exception is rethrown after all the chunks have finished.
+ */
+template <typename F>
+void ParallelFor(ThreadPool& pool, std::size_t begin, std::size_t end, F func) {
+  if (begin >= end) {
+    return;
+  }
+
+  const auto size = end - begin;
+  const auto num_chunks = std::min(size, 4 * pool.Concurrency());
+  if (num_chunks <= 1) {
+    for (auto i = begin; i < end; ++i) {
+      func(i);
+    }
+    return;
+  }
+
+  auto run_chunk = [&func, begin, size, num_chunks](std::size_t chunk) {
+    const auto chunk_end = begin + size * (chunk + 1) / num_chunks;
+    for (auto i = begin + size * chunk / num_chunks; i < chunk_end; ++i) {
+      func(i);
+    }
+  };
+
+  std::vector<Task<void>> tasks;
+  tasks.reserve(num_chunks - 1);
+  for (std::size_t chunk = 0; chunk + 1 < num_chunks; ++chunk) {
+    tasks.push_back(pool.Submit([&run_chunk, chunk] { run_chunk(chunk); }));
+  }
+
+  std::exception_ptr exception;
+  try {
+    run_chunk(num_chunks - 1);
+  } catch (...) {
+    exception = std::current_exception();
+  }
+  for (auto& task : tasks) {
+    try {
+      task.Get();
+    } catch (...) {
+      if (!exception) {
+        exception = std::current_exception();
+      }
+    }
+  }
+  if (exception) {
+    std::rethrow_exception(exception);
+  }
+}
+}  // namespace komori
+
+#endif  // KOMORI_THREAD_POOL_HPP_